@@ -1,263 +1,263 @@
-/* cube.h
- Example class to create a generic cube object
- Includes texture coordinates
- Iain Martin  2018
-*/
-
-#include "cube_tex.h"
-
-/* I don't like using namespaces in header files but have less issues with them in
-seperate cpp files */
-using namespace std;
-
-/* Define the vertex attributes for vertex positions, normals, colour and texcoords.
-Make these match your application and vertex shader
-*/
-Cube::Cube(bool useTexture)
-{
-	attribute_v_coord = 0;
-	attribute_v_colours = 1;
-	attribute_v_normal = 2;
-	attribute_v_texcoord = 3;
-
-	numvertices = 12;
-	this->drawmode = drawmode;
-
-	// Turn texture off if you're not handling texture coordinates in your shaders
-	enableTexture = useTexture;
-}
-
-
-Cube::~Cube()
-{
-}
-
-
-/* Make a cube from hard-coded vertex positions and normals  */
-void Cube::makeCube()
-{
-	/* Define vertices for a cube in 12 triangles */
-	GLfloat vertexPositions[] =
-	{
-		// Face 0;
-		-0.25f, 0.25f, -0.25f,
-		-0.25f, -0.25f, -0.25f,
-		0.25f, -0.25f, -0.25f,
-
-		0.25f, -0.25f, -0.25f,
-		0.25f, 0.25f, -0.25f,
-		-0.25f, 0.25f, -0.25f,
-
-		// Face 1
-		0.25f, -0.25f, -0.25f,
-		0.25f, -0.25f, 0.25f,
-		0.25f, 0.25f, -0.25f,
-
-		0.25f, -0.25f, 0.25f,
-		0.25f, 0.25f, 0.25f,
-		0.25f, 0.25f, -0.25f,
-
-		// Face 2
-		0.25f, -0.25f, 0.25f,
-		-0.25f, -0.25f, 0.25f,
-		0.25f, 0.25f, 0.25f,
-
-		-0.25f, -0.25f, 0.25f,
-		-0.25f, 0.25f, 0.25f,
-		0.25f, 0.25f, 0.25f,
-		
-		// Face 3
-		-0.25f, -0.25f, 0.25f,
-		-0.25f, -0.25f, -0.25f,
-		-0.25f, 0.25f, 0.25f,
-
-		-0.25f, -0.25f, -0.25f,
-		-0.25f, 0.25f, -0.25f,
-		-0.25f, 0.25f, 0.25f,
-
-		// Face 4
-		-0.25f, -0.25f, 0.25f,
-		0.25f, -0.25f, 0.25f,
-		0.25f, -0.25f, -0.25f,
-
-		0.25f, -0.25f, -0.25f,
-		-0.25f, -0.25f, -0.25f,
-		-0.25f, -0.25f, 0.25f,
-
-		// Face 5
-		-0.25f, 0.25f, -0.25f,
-		0.25f, 0.25f, -0.25f,
-		0.25f, 0.25f, 0.25f,
-
-		0.25f, 0.25f, 0.25f,
-		-0.25f, 0.25f, 0.25f,
-		-0.25f, 0.25f, -0.25f,
-	};
-
-	/* Manually specified colours for our cube */
-	float vertexColours[] = {
-		0.0f, 0.0f, 1.0f, 1.0f,
-		0.0f, 0.0f, 1.0f, 1.0f,
-		0.0f, 0.0f, 1.0f, 1.0f,
-		0.0f, 0.0f, 1.0f, 1.0f,
-		0.0f, 0.0f, 1.0f, 1.0f,
-		0.0f, 0.0f, 1.0f, 1.0f,
-
-		0.0f, 1.0f, 0.0f, 1.0f,
-		0.0f, 1.0f, 0.0f, 1.0f,
-		0.0f, 1.0f, 0.0f, 1.0f,
-		0.0f, 1.0f, 0.0f, 1.0f,
-		0.0f, 1.0f, 0.0f, 1.0f,
-		0.0f, 1.0f, 0.0f, 1.0f,
-
-		1.0f, 1.0f, 0.0f, 1.0f,
-		1.0f, 1.0f, 0.0f, 1.0f,
-		1.0f, 1.0f, 0.0f, 1.0f,
-		1.0f, 1.0f, 0.0f, 1.0f,
-		1.0f, 1.0f, 0.0f, 1.0f,
-		1.0f, 1.0f, 0.0f, 1.0f,
-
-		1.0f, 0.0f, 0.0f, 1.0f,
-		1.0f, 0.0f, 0.0f, 1.0f,
-		1.0f, 0.0f, 0.0f, 1.0f,
-		1.0f, 0.0f, 0.0f, 1.0f,
-		1.0f, 0.0f, 0.0f, 1.0f,
-		1.0f, 0.0f, 0.0f, 1.0f,
-
-		1.0f, 0.0f, 1.0f, 1.0f,
-		1.0f, 0.0f, 1.0f, 1.0f,
-		1.0f, 0.0f, 1.0f, 1.0f,
-		1.0f, 0.0f, 1.0f, 1.0f,
-		1.0f, 0.0f, 1.0f, 1.0f,
-		1.0f, 0.0f, 1.0f, 1.0f,
-
-		0.0f, 1.0f, 1.0f, 1.0f,
-		0.0f, 1.0f, 1.0f, 1.0f,
-		0.0f, 1.0f, 1.0f, 1.0f,
-		0.0f, 1.0f, 1.0f, 1.0f,
-		0.0f, 1.0f, 1.0f, 1.0f,
-		0.0f, 1.0f, 1.0f, 1.0f,
-	};
-
-	/* Manually specified normals for our cube */
-	GLfloat normals[] =
-	{
-		0, 0, -1.f, 0, 0, -1.f, 0, 0, -1.f,
-		0, 0, -1.f, 0, 0, -1.f, 0, 0, -1.f,
-		1.f, 0, 0, 1.f, 0, 0, 1.f, 0, 0,
-		1.f, 0, 0, 1.f, 0, 0, 1.f, 0, 0,
-		0, 0, 1.f, 0, 0, 1.f, 0, 0, 1.f,
-		0, 0, 1.f, 0, 0, 1.f, 0, 0, 1.f,
-		-1.f, 0, 0, -1.f, 0, 0, -1.f, 0, 0,
-		-1.f, 0, 0, -1.f, 0, 0, -1.f, 0, 0,
-		0, -1.f, 0, 0, -1.f, 0, 0, -1.f, 0,
-		0, -1.f, 0, 0, -1.f, 0, 0, -1.f, 0,
-		0, 1.f, 0, 0, 1.f, 0, 0, 1.f, 0,
-		0, 1.f, 0, 0, 1.f, 0, 0, 1.f, 0,
-	};
-
-
-	GLfloat texcoords[] =
-	{
-		// Face 0
-		0, 1.f, 0, 0, 1.f, 0,
-		1.f, 0, 1.f, 1.f, 0, 1.f,
-
-		// Face 1
-		1.0, 0.f, 0.f, 0.f, 1.f, 1.f,
-		0.f, 0.f, 0.f, 1.f, 1.f, 1.f,
-
-		// Face 2
-		1.f, 0.f, 0.f, 0.f, 1.f, 1.f,
-		0.f, 0.f, 0.f, 1.f, 1.f, 1.f,
-
-		// Face 3
-		1.f, 0.f, 0.f, 0.f, 1.f, 1.f,
-		0.f, 0.f, 0.f, 1.f, 1.f, 1.f,
-
-		// Face 4
-		0.f, 0.f, 1.f, 0.f, 1.f, 1.f,
-		1.f, 1.f, 0.f, 1.f, 0.f, 0.f,
-
-		// Face 5
-		0.f, 1.f, 1.f, 1.f, 1.f, 0.f,
-		1.f, 0.f, 0.f, 0.f, 0.f, 1.f
-	};
-
-	/* Create the vertex buffer for the cube */
-	glGenBuffers(1, &positionBufferObject);
-	glBindBuffer(GL_ARRAY_BUFFER, positionBufferObject);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexPositions), vertexPositions, GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	/* Create the colours buffer for the cube */
-	glGenBuffers(1, &colourObject);
-	glBindBuffer(GL_ARRAY_BUFFER, colourObject);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexColours), vertexColours, GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	/* Create the normals  buffer for the cube */
-	glGenBuffers(1, &normalsBufferObject);
-	glBindBuffer(GL_ARRAY_BUFFER, normalsBufferObject);
-	glBufferData(GL_ARRAY_BUFFER, 36 * sizeof(glm::vec3), normals, GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	/* Create the texture coordinate  buffer for the cube */
-	if (enableTexture)
-	{
-		glGenBuffers(1, &texCoordsObject);
-		glBindBuffer(GL_ARRAY_BUFFER, texCoordsObject);
-		glBufferData(GL_ARRAY_BUFFER, sizeof(texcoords), texcoords, GL_STATIC_DRAW);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
-	}
-}
-
-
-/* Draw the cube by binding the VBOs and drawing triangles */
-void Cube::drawCube(int drawmode)
-{
-	/* Bind cube vertices. Note that this is in attribute index 0 */
-	glBindBuffer(GL_ARRAY_BUFFER, positionBufferObject);
-	glEnableVertexAttribArray(attribute_v_coord);
-	glVertexAttribPointer(attribute_v_coord, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-	/* Bind cube colours. Note that this is in attribute index 1 */
-	glBindBuffer(GL_ARRAY_BUFFER, colourObject);
-	glEnableVertexAttribArray(attribute_v_colours);
-	glVertexAttribPointer(attribute_v_colours, 4, GL_FLOAT, GL_FALSE, 0, 0);
-
-	/* Bind cube normals. Note that this is in attribute index 2 */
-	glEnableVertexAttribArray(attribute_v_normal);
-	glBindBuffer(GL_ARRAY_BUFFER, normalsBufferObject);
-	glVertexAttribPointer(attribute_v_normal, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-
-	if (enableTexture)
-	{
-		/* Bind cube texture coords. Note that this is in attribute index 3 */
-		glEnableVertexAttribArray(attribute_v_texcoord);
-		glBindBuffer(GL_ARRAY_BUFFER, texCoordsObject);
-		glVertexAttribPointer(attribute_v_texcoord, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	}
-
-	// Define triangle winding as clockwise
-	// It would be better to make all objects have counter-clockwise winding
-	glFrontFace(GL_CW);
-
-	// Enable this line to show model in wireframe
-	if (drawmode == 1)
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	else
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-	if (drawmode == 2)
-	{
-		// Draw the vertices as GL_POINTS
-		glPointSize(3.f);  // Set the point size when drawing vertices
-		glDrawArrays(GL_POINTS, 0, 36);
-	}
-	else
-	{
-		// Draw the cube in triangles
-		glDrawArrays(GL_TRIANGLES, 0, 36);
-	}
+/* cube.h
+ Example class to create a generic cube object
+ Includes texture coordinates
+ Iain Martin  2018
+*/
+
+#include "cube_tex.h"
+
+/* I don't like using namespaces in header files but have less issues with them in
+seperate cpp files */
+using namespace std;
+
+/* Define the vertex attributes for vertex positions, normals, colour and texcoords.
+Make these match your application and vertex shader
+*/
+Cube::Cube(bool useTexture)
+{
+	attribute_v_coord = 0;
+	attribute_v_colours = 1;
+	attribute_v_normal = 2;
+	attribute_v_texcoord = 3;
+
+	numvertices = 12;
+	this->drawmode = drawmode;
+
+	// Turn texture off if you're not handling texture coordinates in your shaders
+	enableTexture = useTexture;
+}
+
+
+Cube::~Cube()
+{
+}
+
+
+/* Make a cube from hard-coded vertex positions and normals  */
+void Cube::makeCube()
+{
+	/* Define vertices for a cube in 12 triangles */
+	GLfloat vertexPositions[] =
+	{
+		// Face 0;
+		-0.25f, 0.25f, -0.25f,
+		-0.25f, -0.25f, -0.25f,
+		0.25f, -0.25f, -0.25f,
+
+		0.25f, -0.25f, -0.25f,
+		0.25f, 0.25f, -0.25f,
+		-0.25f, 0.25f, -0.25f,
+
+		// Face 1
+		0.25f, -0.25f, -0.25f,
+		0.25f, -0.25f, 0.25f,
+		0.25f, 0.25f, -0.25f,
+
+		0.25f, -0.25f, 0.25f,
+		0.25f, 0.25f, 0.25f,
+		0.25f, 0.25f, -0.25f,
+
+		// Face 2
+		0.25f, -0.25f, 0.25f,
+		-0.25f, -0.25f, 0.25f,
+		0.25f, 0.25f, 0.25f,
+
+		-0.25f, -0.25f, 0.25f,
+		-0.25f, 0.25f, 0.25f,
+		0.25f, 0.25f, 0.25f,
+		
+		// Face 3
+		-0.25f, -0.25f, 0.25f,
+		-0.25f, -0.25f, -0.25f,
+		-0.25f, 0.25f, 0.25f,
+
+		-0.25f, -0.25f, -0.25f,
+		-0.25f, 0.25f, -0.25f,
+		-0.25f, 0.25f, 0.25f,
+
+		// Face 4
+		-0.25f, -0.25f, 0.25f,
+		0.25f, -0.25f, 0.25f,
+		0.25f, -0.25f, -0.25f,
+
+		0.25f, -0.25f, -0.25f,
+		-0.25f, -0.25f, -0.25f,
+		-0.25f, -0.25f, 0.25f,
+
+		// Face 5
+		-0.25f, 0.25f, -0.25f,
+		0.25f, 0.25f, -0.25f,
+		0.25f, 0.25f, 0.25f,
+
+		0.25f, 0.25f, 0.25f,
+		-0.25f, 0.25f, 0.25f,
+		-0.25f, 0.25f, -0.25f,
+	};
+
+	/* Manually specified colours for our cube */
+	float vertexColours[] = {
+		0.0f, 0.0f, 1.0f, 1.0f,
+		0.0f, 0.0f, 1.0f, 1.0f,
+		0.0f, 0.0f, 1.0f, 1.0f,
+		0.0f, 0.0f, 1.0f, 1.0f,
+		0.0f, 0.0f, 1.0f, 1.0f,
+		0.0f, 0.0f, 1.0f, 1.0f,
+
+		0.0f, 1.0f, 0.0f, 1.0f,
+		0.0f, 1.0f, 0.0f, 1.0f,
+		0.0f, 1.0f, 0.0f, 1.0f,
+		0.0f, 1.0f, 0.0f, 1.0f,
+		0.0f, 1.0f, 0.0f, 1.0f,
+		0.0f, 1.0f, 0.0f, 1.0f,
+
+		1.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 1.0f, 0.0f, 1.0f,
+		1.0f, 1.0f, 0.0f, 1.0f,
+
+		1.0f, 0.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 0.0f, 1.0f,
+		1.0f, 0.0f, 0.0f, 1.0f,
+
+		1.0f, 0.0f, 1.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 1.0f,
+		1.0f, 0.0f, 1.0f, 1.0f,
+
+		0.0f, 1.0f, 1.0f, 1.0f,
+		0.0f, 1.0f, 1.0f, 1.0f,
+		0.0f, 1.0f, 1.0f, 1.0f,
+		0.0f, 1.0f, 1.0f, 1.0f,
+		0.0f, 1.0f, 1.0f, 1.0f,
+		0.0f, 1.0f, 1.0f, 1.0f,
+	};
+
+	/* Manually specified normals for our cube */
+	GLfloat normals[] =
+	{
+		0, 0, -1.f, 0, 0, -1.f, 0, 0, -1.f,
+		0, 0, -1.f, 0, 0, -1.f, 0, 0, -1.f,
+		1.f, 0, 0, 1.f, 0, 0, 1.f, 0, 0,
+		1.f, 0, 0, 1.f, 0, 0, 1.f, 0, 0,
+		0, 0, 1.f, 0, 0, 1.f, 0, 0, 1.f,
+		0, 0, 1.f, 0, 0, 1.f, 0, 0, 1.f,
+		-1.f, 0, 0, -1.f, 0, 0, -1.f, 0, 0,
+		-1.f, 0, 0, -1.f, 0, 0, -1.f, 0, 0,
+		0, -1.f, 0, 0, -1.f, 0, 0, -1.f, 0,
+		0, -1.f, 0, 0, -1.f, 0, 0, -1.f, 0,
+		0, 1.f, 0, 0, 1.f, 0, 0, 1.f, 0,
+		0, 1.f, 0, 0, 1.f, 0, 0, 1.f, 0,
+	};
+
+
+	GLfloat texcoords[] =
+	{
+		// Face 0
+		0, 1.f, 0, 0, 1.f, 0,
+		1.f, 0, 1.f, 1.f, 0, 1.f,
+
+		// Face 1
+		1.0, 0.f, 0.f, 0.f, 1.f, 1.f,
+		0.f, 0.f, 0.f, 1.f, 1.f, 1.f,
+
+		// Face 2
+		1.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+		0.f, 0.f, 0.f, 1.f, 1.f, 1.f,
+
+		// Face 3
+		1.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+		0.f, 0.f, 0.f, 1.f, 1.f, 1.f,
+
+		// Face 4
+		0.f, 0.f, 1.f, 0.f, 1.f, 1.f,
+		1.f, 1.f, 0.f, 1.f, 0.f, 0.f,
+
+		// Face 5
+		0.f, 1.f, 1.f, 1.f, 1.f, 0.f,
+		1.f, 0.f, 0.f, 0.f, 0.f, 1.f
+	};
+
+	/* Create the vertex buffer for the cube */
+	glGenBuffers(1, &positionBufferObject);
+	glBindBuffer(GL_ARRAY_BUFFER, positionBufferObject);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexPositions), vertexPositions, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/* Create the colours buffer for the cube */
+	glGenBuffers(1, &colourObject);
+	glBindBuffer(GL_ARRAY_BUFFER, colourObject);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertexColours), vertexColours, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/* Create the normals  buffer for the cube */
+	glGenBuffers(1, &normalsBufferObject);
+	glBindBuffer(GL_ARRAY_BUFFER, normalsBufferObject);
+	glBufferData(GL_ARRAY_BUFFER, 36 * sizeof(glm::vec3), normals, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/* Create the texture coordinate  buffer for the cube */
+	if (enableTexture)
+	{
+		glGenBuffers(1, &texCoordsObject);
+		glBindBuffer(GL_ARRAY_BUFFER, texCoordsObject);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(texcoords), texcoords, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+
+/* Draw the cube by binding the VBOs and drawing triangles */
+void Cube::drawCube(int drawmode)
+{
+	/* Bind cube vertices. Note that this is in attribute index 0 */
+	glBindBuffer(GL_ARRAY_BUFFER, positionBufferObject);
+	glEnableVertexAttribArray(attribute_v_coord);
+	glVertexAttribPointer(attribute_v_coord, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+	/* Bind cube colours. Note that this is in attribute index 1 */
+	glBindBuffer(GL_ARRAY_BUFFER, colourObject);
+	glEnableVertexAttribArray(attribute_v_colours);
+	glVertexAttribPointer(attribute_v_colours, 4, GL_FLOAT, GL_FALSE, 0, 0);
+
+	/* Bind cube normals. Note that this is in attribute index 2 */
+	glEnableVertexAttribArray(attribute_v_normal);
+	glBindBuffer(GL_ARRAY_BUFFER, normalsBufferObject);
+	glVertexAttribPointer(attribute_v_normal, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
+
+	if (enableTexture)
+	{
+		/* Bind cube texture coords. Note that this is in attribute index 3 */
+		glEnableVertexAttribArray(attribute_v_texcoord);
+		glBindBuffer(GL_ARRAY_BUFFER, texCoordsObject);
+		glVertexAttribPointer(attribute_v_texcoord, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
+	}
+
+	// Define triangle winding as clockwise
+	// It would be better to make all objects have counter-clockwise winding
+	glFrontFace(GL_CW);
+
+	// Enable this line to show model in wireframe
+	if (drawmode == 1)
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	else
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	if (drawmode == 2)
+	{
+		// Draw the vertices as GL_POINTS
+		glPointSize(3.f);  // Set the point size when drawing vertices
+		glDrawArrays(GL_POINTS, 0, 36);
+	}
+	else
+	{
+		// Draw the cube in triangles
+		glDrawArrays(GL_TRIANGLES, 0, 36);
+	}
 }
\ No newline at end of file
@@ -0,0 +1,124 @@
+/* fixed_timestep.cpp
+   Fixed rate simulation clock, see fixed_timestep.h
+*/
+
+#include "fixed_timestep.h"
+#include "perf_stats.h"
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+fixed_timestep::fixed_timestep(double tick_rate)
+{
+	ticks = 0;
+	running = false;
+	last_tick_time = 0.0;
+	start_time = 0;
+	max_catch_up = 10;
+	setTickRate(tick_rate);
+}
+
+
+fixed_timestep::~fixed_timestep()
+{
+	stop();
+}
+
+
+void fixed_timestep::setTickRate(double hz)
+{
+	dt = 1.0 / hz;
+	accumulator = 0;
+	dropped_time = 0;
+}
+
+
+void fixed_timestep::setMaxCatchUp(GLuint ticks)
+{
+	max_catch_up = ticks;
+}
+
+
+bool fixed_timestep::threaded() const
+{
+	return running;
+}
+
+
+/* After a long frame (loading, a breakpoint) only max_catch_up ticks are run and the
+   rest of the time is dropped, so one slow frame can't make every later frame slower */
+GLuint fixed_timestep::advance(double frame_time, const tick_function& tick)
+{
+	accumulator += frame_time;
+	GLuint n = 0;
+	while (accumulator >= dt && n < max_catch_up)
+	{
+		tick(dt);
+		accumulator -= dt;
+		ticks++;
+		n++;
+	}
+	if (accumulator >= dt)
+	{
+		double excess = accumulator - fmod(accumulator, dt);
+		dropped_time = dropped_time + excess;
+		accumulator -= excess;
+	}
+	return n;
+}
+
+
+void fixed_timestep::start(const tick_function& tick)
+{
+	stop();
+	running = true;
+	start_time = secondsNow();
+	last_tick_time = start_time;
+	sim_thread = thread(&fixed_timestep::threadLoop, this, tick);
+}
+
+
+void fixed_timestep::stop()
+{
+	if (!running) return;
+	running = false;
+	sim_thread.join();
+}
+
+
+/* Tick n is due at start_time + n * dt. Sleep until the next one is due, and if the
+   thread has fallen more than max_catch_up ticks behind skip the missed ones */
+void fixed_timestep::threadLoop(tick_function tick)
+{
+	double due = start_time + dt;
+	while (running)
+	{
+		double now = secondsNow();
+		if (now < due)
+		{
+			this_thread::sleep_for(chrono::duration<double>(due - now));
+			continue;
+		}
+		if (now - due > max_catch_up * dt)
+		{
+			double skipped = floor((now - due) / dt);
+			dropped_time = dropped_time + skipped * dt;	// Only this thread writes it while running
+			due += skipped * dt;
+		}
+
+		tick(dt);
+		ticks++;
+		last_tick_time = due;
+		due += dt;
+	}
+}
+
+
+double fixed_timestep::alpha()
+{
+	double a = running ? (secondsNow() - last_tick_time) / dt : accumulator / dt;
+	if (a < 0) return 0;
+	if (a > 1) return 1;
+	return a;
+}
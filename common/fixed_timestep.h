@@ -0,0 +1,53 @@
+/* fixed_timestep.h
+   Runs a simulation at a fixed tick rate, whatever the frame rate. Either the
+   render loop advances it by the frame time (an accumulator runs as many whole ticks
+   as fit and carries the remainder to the next frame), or start() runs the ticks on
+   a simulation thread against the clock. Either way alpha() says how far the present
+   is between the last two ticks, so the renderer can blend the two latest states.
+   The simulation only ever sees ticks of exactly dt, so the same number of ticks
+   gives the same result at any frame rate.
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+class fixed_timestep
+{
+public:
+	typedef std::function<void(double dt)> tick_function;
+
+	fixed_timestep(double tick_rate = 60.0);
+	~fixed_timestep();
+
+	void setTickRate(double hz);		// Restarts the accumulator
+	void setMaxCatchUp(GLuint ticks);	// Most ticks advance() runs for one frame, the rest is dropped
+
+	/* Stepped by the caller: add frame_time to the accumulator and run whole ticks */
+	GLuint advance(double frame_time, const tick_function& tick);
+
+	/* Simulation thread: tick is called every dt seconds until stop() */
+	void start(const tick_function& tick);
+	void stop();
+	bool threaded() const;
+
+	double alpha();						// 0 = at the last tick, 1 = a whole tick after it
+
+	double dt;
+	std::atomic<unsigned long long> ticks;
+	std::atomic<double> dropped_time;	// Seconds thrown away to catch up, read while the thread runs
+
+private:
+	void threadLoop(tick_function tick);
+
+	double accumulator;
+	GLuint max_catch_up;
+	std::thread sim_thread;
+	std::atomic<bool> running;
+	std::atomic<double> last_tick_time;	// Clock time of the last tick on the thread
+	double start_time;
+};
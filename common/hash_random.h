@@ -0,0 +1,22 @@
+/* hash_random.h
+   Deterministic hashing shared by the terrain colouring and the particle systems.
+   hashRandom() is a counter based random number: the value comes from the seed, an
+   index and a channel, not from a generator's state, so it does not depend on which
+   thread asks for it or in which order.
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+
+/* Random number in [0, 1) from a hash of a seed, an index and a channel */
+inline GLfloat hashRandom(GLuint seed, GLuint i, GLuint channel)
+{
+	GLuint x = seed ^ (i * 0x9E3779B9u) ^ (channel * 0x85EBCA6Bu);
+	x ^= x >> 16;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16;
+	return GLfloat(x >> 8) * (1.f / 16777216.f);
+}
@@ -0,0 +1,111 @@
+/* heightmap.cpp
+   RAW and PNG elevation data for terrain_object::createTerrainFromHeightmap()
+*/
+
+#include "heightmap.h"
+#include <string.h>
+#include <iostream>
+
+/* Private copy of the PNG decoder so examples that don't load images don't need
+   to provide the stb_image implementation */
+#define STB_IMAGE_STATIC
+#define STBI_ONLY_PNG
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+using namespace std;
+
+heightmap::heightmap()
+{
+	width = height = 0;
+	source_bytes = 0;
+	image = NULL;
+}
+
+
+heightmap::~heightmap()
+{
+	close();
+}
+
+
+bool heightmap::open(const char* path, GLuint raw_width, GLuint raw_height)
+{
+	close();
+
+	size_t len = strlen(path);
+	if (len > 4 && (strcmp(path + len - 4, ".png") == 0 || strcmp(path + len - 4, ".PNG") == 0))
+	{
+		int w, h, channels;
+		image = stbi_load_16(path, &w, &h, &channels, 1);
+		if (!image)
+		{
+			cout << "heightmap: could not load " << path << ": " << stbi_failure_reason() << endl;
+			return false;
+		}
+		width = w;
+		height = h;
+		source_bytes = size_t(w) * h * sizeof(GLushort);
+		return true;
+	}
+
+	if (!file.open(path))
+	{
+		cout << "heightmap: could not open " << path << endl;
+		return false;
+	}
+
+	size_t samples = file.size() / sizeof(GLushort);
+	if (raw_width == 0 || raw_height == 0)
+	{
+		// Assume a square heightmap
+		raw_width = raw_height = 1;
+		while (size_t(raw_width + 1) * (raw_width + 1) <= samples) raw_width++;
+		raw_height = raw_width;
+	}
+	if (size_t(raw_width) * raw_height * sizeof(GLushort) != file.size())
+	{
+		cout << "heightmap: " << path << " is not a " << raw_width << " x " << raw_height << " 16 bit RAW file" << endl;
+		file.close();
+		return false;
+	}
+	width = raw_width;
+	height = raw_height;
+	source_bytes = file.size();
+	return true;
+}
+
+
+void heightmap::close()
+{
+	if (image) stbi_image_free(image);
+	image = NULL;
+	file.close();
+	width = height = 0;
+	source_bytes = 0;
+}
+
+
+void heightmap::readRow(GLuint y, GLushort* out)
+{
+	if (image)
+	{
+		memcpy(out, image + size_t(y) * width, width * sizeof(GLushort));
+		return;
+	}
+
+	// RAW samples are little endian whatever the host byte order
+	const unsigned char* row = file.data() + size_t(y) * width * sizeof(GLushort);
+	for (GLuint x = 0; x < width; x++)
+	{
+		out[x] = GLushort(row[x * 2] | (row[x * 2 + 1] << 8));
+	}
+}
+
+
+void heightmap::releaseRows(GLuint y0, GLuint y1)
+{
+	if (image || y1 <= y0) return;
+	size_t row_bytes = size_t(width) * sizeof(GLushort);
+	file.discard(y0 * row_bytes, (y1 - y0) * row_bytes);
+}
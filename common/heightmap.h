@@ -0,0 +1,35 @@
+/* heightmap.h
+   16 bit elevation data (DEM) read a row at a time by terrain_object.
+   Headerless little endian RAW files (.raw, .r16) are memory mapped, rows are
+   converted straight out of the mapping and rows that have been used can be
+   released from the working set, so only a few rows are resident at once.
+   PNG files (8 or 16 bit, first channel is the height) are decoded once into a
+   16 bit image by stb_image as PNG rows can't be decoded independently.
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include "mapped_file.h"
+
+class heightmap
+{
+public:
+	heightmap();
+	~heightmap();
+
+	/* RAW files are square unless raw_width and raw_height are given */
+	bool open(const char* path, GLuint raw_width = 0, GLuint raw_height = 0);
+	void close();
+
+	void readRow(GLuint y, GLushort* out);			// width samples of row y
+	void releaseRows(GLuint y0, GLuint y1);			// Rows y0 to y1-1 won't be read again
+
+	GLuint width;
+	GLuint height;
+	size_t source_bytes;	// Size of the height data in the file
+
+private:
+	mapped_file file;
+	GLushort* image;		// Decoded PNG, NULL for RAW files
+};
@@ -0,0 +1,180 @@
+/* job_system.cpp
+   Work stealing thread pool, see job_system.h
+*/
+
+#include "job_system.h"
+
+using namespace std;
+
+job_system::job_system(GLuint threads)
+{
+	num_threads = 0;
+	stopping = false;
+	queued = 0;
+	chunks_run = 0;
+	chunks_stolen = 0;
+	setThreads(threads);
+}
+
+
+job_system::~job_system()
+{
+	stopWorkers();
+}
+
+
+GLuint job_system::hardwareThreads()
+{
+	GLuint n = thread::hardware_concurrency();
+	return n ? n : 1;
+}
+
+
+/* The pool used by particle_object and points2 when they aren't given one */
+job_system& job_system::shared()
+{
+	static job_system pool;
+	return pool;
+}
+
+
+void job_system::setThreads(GLuint n)
+{
+	lock_guard<mutex> call(call_mutex);
+	if (n == 0) n = hardwareThreads();
+	if (n == num_threads) return;
+
+	stopWorkers();
+	num_threads = n;
+	startWorkers();
+}
+
+
+void job_system::startWorkers()
+{
+	for (GLuint t = 0; t < num_threads; t++) queues.push_back(new chunk_queue);
+
+	stopping = false;
+	for (GLuint t = 1; t < num_threads; t++)
+		workers.push_back(thread(&job_system::workerLoop, this, t));
+}
+
+
+void job_system::stopWorkers()
+{
+	{
+		lock_guard<mutex> lock(wake_mutex);
+		stopping = true;
+	}
+	wake_cv.notify_all();
+	for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+	workers.clear();
+
+	for (size_t t = 0; t < queues.size(); t++) delete queues[t];
+	queues.clear();
+}
+
+
+/* Sleep until chunks are queued, then run chunks until there are none left anywhere */
+void job_system::workerLoop(GLuint id)
+{
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(wake_mutex);
+			wake_cv.wait(lock, [this]{ return stopping || queued > 0; });
+			if (stopping) return;
+		}
+		while (runOne(id));
+	}
+}
+
+
+/* Take a chunk from the front of our own queue, or steal one from the back of another
+   thread's queue, starting with the next thread along so thieves spread out */
+bool job_system::runOne(GLuint id)
+{
+	chunk c;
+	bool found = false;
+	bool stolen = false;
+	for (GLuint n = 0; n < num_threads && !found; n++)
+	{
+		chunk_queue* q = queues[(id + n) % num_threads];
+		lock_guard<mutex> lock(q->lock);
+		if (q->chunks.empty()) continue;
+		if (n == 0)
+		{
+			c = q->chunks.front();
+			q->chunks.pop_front();
+		}
+		else
+		{
+			c = q->chunks.back();
+			q->chunks.pop_back();
+			stolen = true;
+		}
+		found = true;
+	}
+	if (!found) return false;
+
+	queued--;
+	(*c.job)(c.first, c.last);
+	chunks_run++;
+	if (stolen) chunks_stolen++;
+
+	// The last chunk of a parallelFor wakes the caller
+	if (--(*c.remaining) == 0)
+	{
+		lock_guard<mutex> lock(wake_mutex);
+		done_cv.notify_all();
+	}
+	return true;
+}
+
+
+/* Split [0, count) into chunks of grain indices, give each thread a contiguous run of
+   chunks and help run them until they have all finished. Jobs must not call
+   parallelFor themselves */
+void job_system::parallelFor(GLuint count, GLuint grain, const range_job& job)
+{
+	if (count == 0) return;
+	if (grain == 0) grain = 1;
+	GLuint num_chunks = (count + grain - 1) / grain;
+
+	// Not worth waking anyone
+	if (num_threads < 2 || num_chunks < 2)
+	{
+		for (GLuint first = 0; first < count; first += grain)
+			job(first, min(first + grain, count));
+		chunks_run += num_chunks;
+		return;
+	}
+
+	lock_guard<mutex> call(call_mutex);
+	atomic<GLuint> remaining(num_chunks);
+	{
+		lock_guard<mutex> lock(wake_mutex);
+		queued += num_chunks;
+	}
+	for (GLuint t = 0; t < num_threads; t++)
+	{
+		GLuint c0 = GLuint((unsigned long long)num_chunks * t / num_threads);
+		GLuint c1 = GLuint((unsigned long long)num_chunks * (t + 1) / num_threads);
+		lock_guard<mutex> lock(queues[t]->lock);
+		for (GLuint c = c0; c < c1; c++)
+		{
+			chunk item;
+			item.job = &job;
+			item.first = c * grain;
+			item.last = min(item.first + grain, count);
+			item.remaining = &remaining;
+			queues[t]->chunks.push_back(item);
+		}
+	}
+	wake_cv.notify_all();
+
+	while (runOne(0));
+
+	unique_lock<mutex> lock(wake_mutex);
+	done_cv.wait(lock, [&remaining]{ return remaining == 0; });
+}
@@ -0,0 +1,72 @@
+/* job_system.h
+   Small work stealing thread pool for the particle systems.
+   parallelFor() cuts an index range into fixed size chunks and deals them out to
+   one queue per thread; each thread takes chunks from the front of its own queue
+   and, once that is empty, steals from the back of the others. The calling thread
+   works through queue 0 and returns once every chunk has run.
+   The chunk boundaries depend only on the range and the grain, never on the number
+   of threads, so jobs that write disjoint ranges and draw their random numbers from
+   hashRandom() (hash_random.h) give the same results with any thread count.
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+class job_system
+{
+public:
+	typedef std::function<void(GLuint first, GLuint last)> range_job;
+
+	job_system(GLuint threads = 0);		// 0 = one thread per hardware thread
+	~job_system();
+
+	void setThreads(GLuint n);			// Threads including the caller, 0 = hardware threads
+
+	/* Run job(first, last) over [0, count) in chunks of grain indices and wait for them all */
+	void parallelFor(GLuint count, GLuint grain, const range_job& job);
+
+	static job_system& shared();		// Pool used by the particle systems unless given another
+	static GLuint hardwareThreads();
+
+	GLuint num_threads;
+
+	/* Statistics */
+	std::atomic<unsigned long long> chunks_run;
+	std::atomic<unsigned long long> chunks_stolen;
+
+private:
+	struct chunk
+	{
+		const range_job* job;
+		GLuint first, last;
+		std::atomic<GLuint>* remaining;		// Chunks of the same parallelFor still to finish
+	};
+
+	struct chunk_queue
+	{
+		std::mutex lock;
+		std::deque<chunk> chunks;
+	};
+
+	void startWorkers();
+	void stopWorkers();
+	void workerLoop(GLuint id);
+	bool runOne(GLuint id);				// Run a chunk from queue id or stolen, false if there were none
+
+	std::vector<std::thread> workers;
+	std::vector<chunk_queue*> queues;	// One per thread, the caller uses queue 0
+	std::mutex wake_mutex;
+	std::condition_variable wake_cv;
+	std::condition_variable done_cv;
+	std::atomic<GLuint> queued;			// Chunks waiting in any queue
+	bool stopping;
+	std::mutex call_mutex;				// One parallelFor at a time
+};
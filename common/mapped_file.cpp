@@ -0,0 +1,130 @@
+/* mapped_file.cpp
+   Read only file mapping with MapViewOfFile on Windows and mmap elsewhere.
+*/
+
+#include "mapped_file.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+mapped_file::mapped_file()
+{
+	bytes = NULL;
+	length = 0;
+	file_handle = NULL;
+	map_handle = NULL;
+}
+
+
+mapped_file::~mapped_file()
+{
+	close();
+}
+
+
+bool mapped_file::open(const char* path)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	bytes = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!bytes)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	length = (size_t)file_size.QuadPart;
+	file_handle = file;
+	map_handle = mapping;
+#else
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);	// The mapping stays valid without the descriptor
+	if (p == MAP_FAILED) return false;
+
+	madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+	bytes = (const unsigned char*)p;
+	length = (size_t)st.st_size;
+#endif
+	return true;
+}
+
+
+void mapped_file::close()
+{
+	if (!bytes) return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(bytes);
+	CloseHandle((HANDLE)map_handle);
+	CloseHandle((HANDLE)file_handle);
+#else
+	munmap((void*)bytes, length);
+#endif
+	bytes = NULL;
+	length = 0;
+	file_handle = NULL;
+	map_handle = NULL;
+}
+
+
+/* Drop the pages of a range that won't be read again from the working set. The data
+   stays valid, it is read back from the file if it is touched again */
+void mapped_file::discard(size_t offset, size_t count)
+{
+	if (!bytes || offset >= length) return;
+	if (count > length - offset) count = length - offset;
+
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	size_t page = info.dwPageSize;
+#else
+	size_t page = (size_t)sysconf(_SC_PAGESIZE);
+#endif
+	// Only whole pages inside the range
+	size_t first = (offset + page - 1) / page * page;
+	size_t last = (offset + count) / page * page;
+	if (count == length - offset) last = offset + count;
+	if (last <= first) return;
+
+#ifdef _WIN32
+	// Unlocking pages that aren't locked removes them from the working set
+	VirtualUnlock((LPVOID)(bytes + first), last - first);
+#else
+	madvise((void*)(bytes + first), last - first, MADV_DONTNEED);
+#endif
+}
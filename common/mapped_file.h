@@ -0,0 +1,28 @@
+/* mapped_file.h
+   Read only memory mapped file, used to load the binary caches written by the
+   terrain and model loaders without reading them through a stream first.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+class mapped_file
+{
+public:
+	mapped_file();
+	~mapped_file();
+
+	bool open(const char* path);		// false if the file is missing, empty or can't be mapped
+	void close();
+	void discard(size_t offset, size_t count);	// Release pages that won't be read again
+
+	const unsigned char* data() const { return bytes; }
+	size_t size() const { return length; }
+
+private:
+	const unsigned char* bytes;
+	size_t length;
+	void* file_handle;		// Windows file and mapping handles, unused elsewhere
+	void* map_handle;
+};
@@ -0,0 +1,394 @@
+/* mesh_optimizer.cpp
+   Vertex cache, overdraw and vertex fetch ordering of triangle lists, see mesh_optimizer.h
+*/
+
+#include "mesh_optimizer.h"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+using namespace std;
+using namespace glm;
+
+/* Cache modelled by the Forsyth scores, and the valences given a score table entry */
+const GLuint FORSYTH_CACHE_SIZE = 32;
+const GLuint FORSYTH_MAX_VALENCE = 64;
+
+/* FIFO cache of the last size entries loaded. A hit doesn't move an entry, so an entry
+   is still cached until size more misses have happened since it was loaded */
+struct fifo_model
+{
+	vector<GLuint> loaded;				// Miss count when each entry was loaded, 0 = never
+	GLuint misses;
+	GLuint base;						// Misses at the last flush()
+	GLuint size;
+
+	fifo_model(size_t entries, GLuint cache_size) : loaded(entries, 0), misses(0), base(0), size(cache_size) {}
+
+	bool access(size_t id)
+	{
+		if (loaded[id] > base && misses - loaded[id] < size) return true;
+		loaded[id] = ++misses;
+		return false;
+	}
+
+	void flush()
+	{
+		base = misses;
+	}
+};
+
+static inline vec3 position(const GLfloat* positions, GLuint stride, GLuint vertex)
+{
+	const GLfloat* p = positions + size_t(vertex) * stride;
+	return vec3(p[0], p[1], p[2]);
+}
+
+
+/* Forsyth's vertex score: the three vertices of the last triangle score the same so
+   the next triangle doesn't favour one of them, older cache entries score less, and
+   vertices with few triangles left score more so they are finished off and leave the
+   cache. Vertices with no triangles left score -1 */
+static GLfloat forsythScore(int cache_position, GLuint remaining)
+{
+	if (remaining == 0) return -1.f;
+	GLfloat score = 0;
+	if (cache_position >= 0)
+	{
+		if (cache_position < 3) score = 0.75f;
+		else score = powf(1.f - (cache_position - 3) / GLfloat(FORSYTH_CACHE_SIZE - 3), 1.5f);
+	}
+	return score + 2.f * powf(GLfloat(remaining), -0.5f);
+}
+
+
+/* Emit the highest scoring triangle that uses a cached vertex, push its vertices to the
+   front of the cache, and rescore the vertices in the cache and their triangles. When no
+   cached vertex has triangles left, carry on from the first triangle not emitted yet */
+void optimizeVertexCache(GLuint* indices, size_t count, GLuint num_vertices)
+{
+	size_t num_triangles = count / 3;
+	if (num_triangles < 2) return;
+
+	GLfloat cache_scores[FORSYTH_CACHE_SIZE + 1][FORSYTH_MAX_VALENCE];
+	for (GLuint p = 0; p <= FORSYTH_CACHE_SIZE; p++)
+		for (GLuint r = 0; r < FORSYTH_MAX_VALENCE; r++)
+			cache_scores[p][r] = forsythScore(p < FORSYTH_CACHE_SIZE ? int(p) : -1, r);
+
+	// Triangles left to draw for each vertex, stored together per vertex
+	vector<GLuint> remaining(num_vertices, 0);
+	for (size_t i = 0; i < num_triangles * 3; i++) remaining[indices[i]]++;
+	vector<size_t> first(num_vertices + 1, 0);
+	for (GLuint v = 0; v < num_vertices; v++) first[v + 1] = first[v] + remaining[v];
+	vector<GLuint> adjacency(num_triangles * 3);
+	{
+		vector<size_t> fill(first.begin(), first.end() - 1);
+		for (size_t i = 0; i < num_triangles * 3; i++) adjacency[fill[indices[i]]++] = GLuint(i / 3);
+	}
+
+	vector<int> cache_position(num_vertices, -1);
+	vector<GLfloat> vertex_score(num_vertices);
+	for (GLuint v = 0; v < num_vertices; v++)
+		vertex_score[v] = remaining[v] < FORSYTH_MAX_VALENCE ? cache_scores[FORSYTH_CACHE_SIZE][remaining[v]]
+			: forsythScore(-1, remaining[v]);
+	vector<GLfloat> triangle_score(num_triangles);
+	for (size_t t = 0; t < num_triangles; t++)
+		triangle_score[t] = vertex_score[indices[t * 3]] + vertex_score[indices[t * 3 + 1]] + vertex_score[indices[t * 3 + 2]];
+
+	vector<GLubyte> emitted(num_triangles, 0);
+	vector<GLuint> output;
+	output.reserve(num_triangles * 3);
+	GLuint cache[FORSYTH_CACHE_SIZE + 3];
+	GLuint cache_count = 0;
+	size_t next_unemitted = 0;
+	long long best = 0;
+
+	for (size_t n = 0; n < num_triangles; n++)
+	{
+		if (best < 0)
+		{
+			while (emitted[next_unemitted]) next_unemitted++;
+			best = (long long)next_unemitted;
+		}
+		size_t t = (size_t)best;
+		emitted[t] = 1;
+		const GLuint* triangle = indices + t * 3;
+		output.insert(output.end(), triangle, triangle + 3);
+
+		// The triangle's vertices go to the front of the cache
+		GLuint new_cache[FORSYTH_CACHE_SIZE + 3];
+		GLuint new_count = 0;
+		for (int k = 0; k < 3; k++)
+			if (find(new_cache, new_cache + new_count, triangle[k]) == new_cache + new_count)
+				new_cache[new_count++] = triangle[k];
+		for (GLuint i = 0; i < cache_count; i++)
+			if (find(triangle, triangle + 3, cache[i]) == triangle + 3) new_cache[new_count++] = cache[i];
+
+		// Take the triangle out of its vertices' lists
+		for (int k = 0; k < 3; k++)
+		{
+			GLuint v = triangle[k];
+			GLuint* list = &adjacency[first[v]];
+			GLuint* found = find(list, list + remaining[v], GLuint(t));
+			if (found == list + remaining[v]) continue;
+			*found = list[remaining[v] - 1];
+			remaining[v]--;
+		}
+
+		// Rescore everything that was in the cache, including the vertices pushed out of it
+		for (GLuint i = 0; i < new_count; i++)
+		{
+			GLuint v = new_cache[i];
+			cache_position[v] = i < FORSYTH_CACHE_SIZE ? int(i) : -1;
+			GLuint p = i < FORSYTH_CACHE_SIZE ? i : FORSYTH_CACHE_SIZE;
+			GLfloat score = remaining[v] < FORSYTH_MAX_VALENCE ? cache_scores[p][remaining[v]]
+				: forsythScore(cache_position[v], remaining[v]);
+			GLfloat delta = score - vertex_score[v];
+			vertex_score[v] = score;
+			for (size_t a = first[v]; a < first[v] + remaining[v]; a++) triangle_score[adjacency[a]] += delta;
+		}
+
+		cache_count = std::min(new_count, FORSYTH_CACHE_SIZE);
+		copy(new_cache, new_cache + cache_count, cache);
+
+		best = -1;
+		GLfloat best_score = -FLT_MAX;
+		for (GLuint i = 0; i < cache_count; i++)
+		{
+			GLuint v = cache[i];
+			for (size_t a = first[v]; a < first[v] + remaining[v]; a++)
+				if (triangle_score[adjacency[a]] > best_score)
+				{
+					best_score = triangle_score[adjacency[a]];
+					best = adjacency[a];
+				}
+		}
+	}
+
+	copy(output.begin(), output.end(), indices);
+}
+
+
+vec3 meshCentroid(const GLuint* indices, size_t count, const GLfloat* positions, GLuint stride)
+{
+	dvec3 sum(0);
+	double total = 0;
+	for (size_t i = 0; i + 2 < count; i += 3)
+	{
+		vec3 a = position(positions, stride, indices[i]);
+		vec3 b = position(positions, stride, indices[i + 1]);
+		vec3 c = position(positions, stride, indices[i + 2]);
+		double area = length(cross(b - a, c - a));
+		sum += dvec3(a + b + c) * (area / 3.0);
+		total += area;
+	}
+	return total > 0 ? vec3(sum / total) : vec3(0);
+}
+
+
+/* Clusters start where all three vertices of a triangle miss the cache, and are split
+   again wherever the triangles so far, starting with a cold cache, are within threshold
+   of the cluster's ACMR. Clusters are then sorted by how far they face away from the
+   centre, outward facing clusters first */
+void optimizeOverdraw(GLuint* indices, size_t count, const GLfloat* positions, GLuint stride,
+	GLuint num_vertices, vec3 centre, GLuint cache_size, GLfloat threshold)
+{
+	size_t num_triangles = count / 3;
+	if (num_triangles < 2) return;
+
+	fifo_model cache(num_vertices, cache_size);
+	vector<size_t> hard;
+	for (size_t t = 0; t < num_triangles; t++)
+	{
+		GLuint misses = 0;
+		for (int k = 0; k < 3; k++) misses += cache.access(indices[t * 3 + k]) ? 0 : 1;
+		if (t == 0 || misses == 3) hard.push_back(t);
+	}
+	hard.push_back(num_triangles);
+
+	vector<size_t> clusters;
+	for (size_t h = 0; h + 1 < hard.size(); h++)
+	{
+		size_t a = hard[h], b = hard[h + 1];
+		cache.flush();
+		GLuint cluster_misses = 0;
+		for (size_t i = a * 3; i < b * 3; i++) cluster_misses += cache.access(indices[i]) ? 0 : 1;
+		double target = threshold * double(cluster_misses) / double(b - a);
+
+		cache.flush();
+		clusters.push_back(a);
+		size_t start = a;
+		GLuint misses = 0;
+		for (size_t t = a; t < b; t++)
+		{
+			for (int k = 0; k < 3; k++) misses += cache.access(indices[t * 3 + k]) ? 0 : 1;
+			if (t + 1 < b && misses <= target * double(t + 1 - start))
+			{
+				clusters.push_back(t + 1);
+				start = t + 1;
+				misses = 0;
+				cache.flush();
+			}
+		}
+	}
+	clusters.push_back(num_triangles);
+
+	struct cluster_order
+	{
+		GLfloat key;
+		size_t first, last;
+	};
+	vector<cluster_order> order(clusters.size() - 1);
+	for (size_t c = 0; c + 1 < clusters.size(); c++)
+	{
+		dvec3 centroid(0), normal(0);
+		double area = 0;
+		for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			vec3 p0 = position(positions, stride, indices[t * 3]);
+			vec3 p1 = position(positions, stride, indices[t * 3 + 1]);
+			vec3 p2 = position(positions, stride, indices[t * 3 + 2]);
+			dvec3 n = dvec3(cross(p1 - p0, p2 - p0));
+			double a = length(n);
+			centroid += dvec3(p0 + p1 + p2) * (a / 3.0);
+			normal += n;
+			area += a;
+		}
+		order[c].first = clusters[c];
+		order[c].last = clusters[c + 1];
+		order[c].key = 0;
+		if (area > 0 && length(normal) > 0)
+			order[c].key = (GLfloat)dot(centroid / area - dvec3(centre), normalize(normal));
+	}
+	stable_sort(order.begin(), order.end(), [](const cluster_order& a, const cluster_order& b)
+	{
+		return a.key > b.key;
+	});
+
+	vector<GLuint> output;
+	output.reserve(num_triangles * 3);
+	for (size_t c = 0; c < order.size(); c++)
+		output.insert(output.end(), indices + order[c].first * 3, indices + order[c].last * 3);
+	copy(output.begin(), output.end(), indices);
+}
+
+
+GLuint optimizeVertexFetch(GLuint* indices, size_t count, GLfloat* vertices, GLuint stride, GLuint num_vertices)
+{
+	vector<GLuint> remap(num_vertices, ~0u);
+	GLuint used = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		GLuint& v = remap[indices[i]];
+		if (v == ~0u) v = used++;
+		indices[i] = v;
+	}
+
+	vector<GLfloat> source(vertices, vertices + size_t(num_vertices) * stride);
+	for (GLuint v = 0; v < num_vertices; v++)
+		if (remap[v] != ~0u)
+			copy(&source[size_t(v) * stride], &source[size_t(v) * stride] + stride, vertices + size_t(remap[v]) * stride);
+	return used;
+}
+
+
+GLuint fifoCacheMisses(const GLuint* indices, size_t count, GLuint num_vertices, GLuint cache_size)
+{
+	fifo_model cache(num_vertices, cache_size);
+	for (size_t i = 0; i < count; i++) cache.access(indices[i]);
+	return cache.misses;
+}
+
+
+/* Rasterise the triangles with a depth test looking along +x, -x, +y, -y, +z and -z,
+   both faces drawn, counting the pixels that pass the depth test against the pixels
+   covered at the end. 1 is no overdraw */
+double overdrawRatio(const GLuint* indices, size_t count, const GLfloat* positions, GLuint stride,
+	GLuint resolution)
+{
+	if (count < 3) return 1.0;
+	vec3 lo(FLT_MAX), hi(-FLT_MAX);
+	for (size_t i = 0; i < count; i++)
+	{
+		vec3 p = position(positions, stride, indices[i]);
+		lo = min(lo, p);
+		hi = max(hi, p);
+	}
+	vec3 size = hi - lo;
+	GLfloat extent = std::max(size.x, std::max(size.y, size.z));
+	if (extent <= 0) return 1.0;
+	GLfloat scale = resolution / extent;
+
+	vector<GLfloat> depth(size_t(resolution) * resolution);
+	unsigned long long shaded = 0, covered = 0;
+	for (int view = 0; view < 6; view++)
+	{
+		int axis = view / 2, u = (axis + 1) % 3, v = (axis + 2) % 3;
+		GLfloat sign = (view & 1) ? -1.f : 1.f;
+		fill(depth.begin(), depth.end(), FLT_MAX);
+
+		for (size_t i = 0; i + 2 < count; i += 3)
+		{
+			vec3 s[3];
+			for (int k = 0; k < 3; k++)
+			{
+				vec3 p = position(positions, stride, indices[i + k]) - lo;
+				s[k] = vec3(p[u] * scale, p[v] * scale, sign * p[axis]);
+			}
+			GLfloat area = (s[1].x - s[0].x) * (s[2].y - s[0].y) - (s[2].x - s[0].x) * (s[1].y - s[0].y);
+			if (area == 0) continue;
+
+			int x0 = std::max(0, int(floor(std::min(s[0].x, std::min(s[1].x, s[2].x)))));
+			int x1 = std::min(int(resolution) - 1, int(ceil(std::max(s[0].x, std::max(s[1].x, s[2].x)))));
+			int y0 = std::max(0, int(floor(std::min(s[0].y, std::min(s[1].y, s[2].y)))));
+			int y1 = std::min(int(resolution) - 1, int(ceil(std::max(s[0].y, std::max(s[1].y, s[2].y)))));
+			for (int y = y0; y <= y1; y++)
+				for (int x = x0; x <= x1; x++)
+				{
+					GLfloat px = x + 0.5f, py = y + 0.5f;
+					GLfloat w0 = ((s[2].x - s[1].x) * (py - s[1].y) - (s[2].y - s[1].y) * (px - s[1].x)) / area;
+					GLfloat w1 = ((s[0].x - s[2].x) * (py - s[2].y) - (s[0].y - s[2].y) * (px - s[2].x)) / area;
+					GLfloat w2 = 1.f - w0 - w1;
+					if (w0 < 0 || w1 < 0 || w2 < 0) continue;
+					GLfloat z = w0 * s[0].z + w1 * s[1].z + w2 * s[2].z;
+					GLfloat& d = depth[size_t(y) * resolution + x];
+					if (z < d)
+					{
+						d = z;
+						shaded++;
+					}
+				}
+		}
+		for (size_t p = 0; p < depth.size(); p++) covered += depth[p] < FLT_MAX ? 1 : 0;
+	}
+	return covered ? double(shaded) / double(covered) : 1.0;
+}
+
+
+/* Vertex shader runs fetch their vertex through a 4 KB FIFO cache of 64 byte lines */
+double vertexFetchRatio(const GLuint* indices, size_t count, GLuint num_vertices, GLuint vertex_bytes,
+	GLuint cache_size)
+{
+	const GLuint line_bytes = 64, lines_cached = 64;
+	size_t num_lines = (size_t(num_vertices) * vertex_bytes + line_bytes - 1) / line_bytes;
+	fifo_model vertex_cache(num_vertices, cache_size), line_cache(num_lines, lines_cached);
+	vector<GLubyte> used(num_vertices, 0);
+	size_t num_used = 0;
+	unsigned long long bytes = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		GLuint v = indices[i];
+		if (!used[v])
+		{
+			used[v] = 1;
+			num_used++;
+		}
+		if (vertex_cache.access(v)) continue;
+		size_t first = size_t(v) * vertex_bytes / line_bytes;
+		size_t last = (size_t(v + 1) * vertex_bytes - 1) / line_bytes;
+		for (size_t line = first; line <= last; line++)
+			if (!line_cache.access(line)) bytes += line_bytes;
+	}
+	return num_used ? double(bytes) / (double(num_used) * vertex_bytes) : 0.0;
+}
@@ -0,0 +1,39 @@
+/* mesh_optimizer.h
+   Reorders an indexed triangle list for the GPU without changing what it draws.
+     - optimizeVertexCache(): Tom Forsyth's linear speed vertex cache optimisation,
+       which picks each next triangle by a score of how recently its vertices went
+       through the post transform cache and how few triangles they have left
+     - optimizeOverdraw(): cuts the cache ordered triangles into clusters where the
+       cache would restart anyway, and draws the clusters that face away from the
+       middle of the mesh first, so they hide more of what is drawn after them
+       (Sander, Nehab and Barczak, "Fast triangle reordering for vertex locality and
+       reduced overdraw")
+     - optimizeVertexFetch(): renumbers the vertices in the order the indices first
+       use them, so the vertex fetches walk through memory
+   The analysis functions measure the same things in software, so the gains can be
+   checked without a GPU. The functions taking num_vertices need scratch memory for
+   that many vertices.
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include <glm/glm.hpp>
+
+/* Reordering, indices is a triangle list of count indices below num_vertices.
+   positions point at the x of vertex 0, with stride floats from one vertex to the next */
+void optimizeVertexCache(GLuint* indices, size_t count, GLuint num_vertices);
+void optimizeOverdraw(GLuint* indices, size_t count, const GLfloat* positions, GLuint stride,
+	GLuint num_vertices, glm::vec3 centre, GLuint cache_size = 32, GLfloat threshold = 1.05f);
+GLuint optimizeVertexFetch(GLuint* indices, size_t count, GLfloat* vertices, GLuint stride,
+	GLuint num_vertices);	// Returns the vertices used, the others are dropped from the end
+
+/* Area weighted centre of the triangles, the centre optimizeOverdraw() sorts around */
+glm::vec3 meshCentroid(const GLuint* indices, size_t count, const GLfloat* positions, GLuint stride);
+
+/* Analysis */
+GLuint fifoCacheMisses(const GLuint* indices, size_t count, GLuint num_vertices, GLuint cache_size);
+double overdrawRatio(const GLuint* indices, size_t count, const GLfloat* positions, GLuint stride,
+	GLuint resolution = 256);	// Pixels shaded / pixels covered, from 6 axis views
+double vertexFetchRatio(const GLuint* indices, size_t count, GLuint num_vertices, GLuint vertex_bytes,
+	GLuint cache_size = 32);	// Bytes read through a 4 KB cache of 64 byte lines / bytes of the vertices used
@@ -0,0 +1,372 @@
+/* noise_engine.cpp
+   Multithreaded, SIMD Perlin heightfield generation.
+
+   The Perlin function below is written once as a template over a "lane" type
+   and instantiated for a plain float (scalar tail), an SSE register (4 samples)
+   and an AVX register (8 samples). It follows glm::perlin(vec2) from
+   glm/gtc/noise.inl step by step; the only difference is that glm evaluates the
+   four lattice corners of one sample in a vec4 whereas here every lane holds a
+   different sample.
+*/
+
+#include "noise_engine.h"
+#include <glm/glm.hpp>
+#include <glm/gtc/noise.hpp>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define NOISE_LANES 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#if defined(__SSE4_1__)
+		#include <smmintrin.h>
+	#else
+		#include <emmintrin.h>
+	#endif
+	#define NOISE_LANES 4
+#else
+	#define NOISE_LANES 1
+#endif
+
+using namespace std;
+
+/* Scalar lane operations */
+static inline float lane_floor(float x) { return std::floor(x); }
+static inline float lane_abs(float x) { return std::fabs(x); }
+
+#if NOISE_LANES == 4
+/* Four samples in an SSE register */
+struct lane4
+{
+	__m128 v;
+	lane4() {}
+	lane4(__m128 x) : v(x) {}
+	lane4(float x) : v(_mm_set1_ps(x)) {}
+};
+static inline lane4 operator+(lane4 a, lane4 b) { return _mm_add_ps(a.v, b.v); }
+static inline lane4 operator-(lane4 a, lane4 b) { return _mm_sub_ps(a.v, b.v); }
+static inline lane4 operator*(lane4 a, lane4 b) { return _mm_mul_ps(a.v, b.v); }
+static inline lane4 operator/(lane4 a, lane4 b) { return _mm_div_ps(a.v, b.v); }
+static inline lane4 lane_abs(lane4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a.v); }
+static inline lane4 lane_floor(lane4 a)
+{
+#if defined(__SSE4_1__)
+	return _mm_floor_ps(a.v);
+#else
+	// Truncate then step down where truncation rounded up (negative values).
+	// Exact for |x| < 2^31 which covers every value the Perlin kernel floors.
+	__m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+	__m128 gt = _mm_cmpgt_ps(t, a.v);
+	return _mm_sub_ps(t, _mm_and_ps(gt, _mm_set1_ps(1.f)));
+#endif
+}
+static inline lane4 lane_columns(float col) { return _mm_setr_ps(col, col + 1.f, col + 2.f, col + 3.f); }
+static inline void lane_store(float* p, lane4 a) { _mm_storeu_ps(p, a.v); }
+typedef lane4 lane_t;
+#endif
+
+#if NOISE_LANES == 8
+/* Eight samples in an AVX register */
+struct lane8
+{
+	__m256 v;
+	lane8() {}
+	lane8(__m256 x) : v(x) {}
+	lane8(float x) : v(_mm256_set1_ps(x)) {}
+};
+static inline lane8 operator+(lane8 a, lane8 b) { return _mm256_add_ps(a.v, b.v); }
+static inline lane8 operator-(lane8 a, lane8 b) { return _mm256_sub_ps(a.v, b.v); }
+static inline lane8 operator*(lane8 a, lane8 b) { return _mm256_mul_ps(a.v, b.v); }
+static inline lane8 operator/(lane8 a, lane8 b) { return _mm256_div_ps(a.v, b.v); }
+static inline lane8 lane_abs(lane8 a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v); }
+static inline lane8 lane_floor(lane8 a) { return _mm256_floor_ps(a.v); }
+static inline lane8 lane_columns(float col)
+{
+	return _mm256_setr_ps(col, col + 1.f, col + 2.f, col + 3.f, col + 4.f, col + 5.f, col + 6.f, col + 7.f);
+}
+static inline void lane_store(float* p, lane8 a) { _mm256_storeu_ps(p, a.v); }
+typedef lane8 lane_t;
+#endif
+
+/* Helpers from glm/detail/_noise.hpp */
+template <typename V>
+static inline V lane_fract(V x)
+{
+	return x - lane_floor(x);
+}
+
+template <typename V>
+static inline V lane_mod289(V x)
+{
+	return x - lane_floor(x * V(1.f / 289.f)) * V(289.f);
+}
+
+template <typename V>
+static inline V lane_permute(V x)
+{
+	return lane_mod289(((x * V(34.f)) + V(1.f)) * x);
+}
+
+/* Classic 2D Perlin noise, one sample per lane. Mirrors glm::perlin(vec2) */
+template <typename V>
+static inline V lane_perlin(V px, V py)
+{
+	// Pi = floor(P.xyxy) + (0, 0, 1, 1), Pf = fract(P.xyxy) - (0, 0, 1, 1)
+	V Pix = lane_floor(px) + V(0.f);
+	V Piy = lane_floor(py) + V(0.f);
+	V Piz = lane_floor(px) + V(1.f);
+	V Piw = lane_floor(py) + V(1.f);
+	V Pfx = lane_fract(px) - V(0.f);
+	V Pfy = lane_fract(py) - V(0.f);
+	V Pfz = lane_fract(px) - V(1.f);
+	V Pfw = lane_fract(py) - V(1.f);
+
+	// Pi = mod(Pi, 289) to avoid truncation effects in permutation
+	Pix = Pix - V(289.f) * lane_floor(Pix / V(289.f));
+	Piy = Piy - V(289.f) * lane_floor(Piy / V(289.f));
+	Piz = Piz - V(289.f) * lane_floor(Piz / V(289.f));
+	Piw = Piw - V(289.f) * lane_floor(Piw / V(289.f));
+
+	// i = permute(permute(ix) + iy) with ix = Pi.xzxz, iy = Pi.yyww
+	V px0 = lane_permute(Pix);
+	V px1 = lane_permute(Piz);
+	V i0 = lane_permute(px0 + Piy);
+	V i1 = lane_permute(px1 + Piy);
+	V i2 = lane_permute(px0 + Piw);
+	V i3 = lane_permute(px1 + Piw);
+
+	// Gradients
+	V gx0 = V(2.f) * lane_fract(i0 / V(41.f)) - V(1.f);
+	V gx1 = V(2.f) * lane_fract(i1 / V(41.f)) - V(1.f);
+	V gx2 = V(2.f) * lane_fract(i2 / V(41.f)) - V(1.f);
+	V gx3 = V(2.f) * lane_fract(i3 / V(41.f)) - V(1.f);
+	V gy0 = lane_abs(gx0) - V(0.5f);
+	V gy1 = lane_abs(gx1) - V(0.5f);
+	V gy2 = lane_abs(gx2) - V(0.5f);
+	V gy3 = lane_abs(gx3) - V(0.5f);
+	gx0 = gx0 - lane_floor(gx0 + V(0.5f));
+	gx1 = gx1 - lane_floor(gx1 + V(0.5f));
+	gx2 = gx2 - lane_floor(gx2 + V(0.5f));
+	gx3 = gx3 - lane_floor(gx3 + V(0.5f));
+
+	// Normalise with taylorInvSqrt(dot(g, g)); g00 = 0, g10 = 1, g01 = 2, g11 = 3
+	const V taylor_a(static_cast<float>(1.79284291400159));
+	const V taylor_b(static_cast<float>(0.85373472095314));
+	V norm0 = taylor_a - taylor_b * (gx0 * gx0 + gy0 * gy0);
+	V norm1 = taylor_a - taylor_b * (gx1 * gx1 + gy1 * gy1);
+	V norm2 = taylor_a - taylor_b * (gx2 * gx2 + gy2 * gy2);
+	V norm3 = taylor_a - taylor_b * (gx3 * gx3 + gy3 * gy3);
+	gx0 = gx0 * norm0; gy0 = gy0 * norm0;
+	gx1 = gx1 * norm1; gy1 = gy1 * norm1;
+	gx2 = gx2 * norm2; gy2 = gy2 * norm2;
+	gx3 = gx3 * norm3; gy3 = gy3 * norm3;
+
+	// Gradient contributions from the four corners
+	V n00 = gx0 * Pfx + gy0 * Pfy;
+	V n10 = gx1 * Pfz + gy1 * Pfy;
+	V n01 = gx2 * Pfx + gy2 * Pfw;
+	V n11 = gx3 * Pfz + gy3 * Pfw;
+
+	// Fade curve and bilinear blend
+	V fade_x = (Pfx * Pfx * Pfx) * (Pfx * (Pfx * V(6.f) - V(15.f)) + V(10.f));
+	V fade_y = (Pfy * Pfy * Pfy) * (Pfy * (Pfy * V(6.f) - V(15.f)) + V(10.f));
+	V nx0 = n00 + fade_x * (n10 - n00);
+	V nx1 = n01 + fade_x * (n11 - n01);
+	V n_xy = nx0 + fade_y * (nx1 - nx0);
+	return V(2.3f) * n_xy;
+}
+
+
+noise_engine::noise_engine(GLuint octaves, GLfloat freq, GLfloat scale)
+{
+	perlin_octaves = octaves;
+	perlin_freq = freq;
+	perlin_scale = scale;
+	num_threads = 0;
+	use_simd = true;
+	keep_octaves = false;
+}
+
+
+noise_engine::~noise_engine()
+{
+}
+
+
+void noise_engine::setThreads(GLuint n)
+{
+	num_threads = n;
+}
+
+
+void noise_engine::setSIMD(bool enable)
+{
+	use_simd = enable;
+}
+
+
+void noise_engine::setKeepOctaves(bool keep)
+{
+	keep_octaves = keep;
+}
+
+
+const char* noise_engine::simdName()
+{
+#if NOISE_LANES == 8
+	return "AVX (8 lanes)";
+#elif NOISE_LANES == 4
+	return "SSE (4 lanes)";
+#else
+	return "scalar";
+#endif
+}
+
+
+/* Split the rows into one contiguous band per thread */
+void noise_engine::generate(GLfloat* out, GLuint cols, GLuint rows,
+	GLint col0, GLint row0, GLfloat xstep, GLfloat zstep)
+{
+	GLuint threads = num_threads;
+	if (threads == 0) threads = thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	// Don't bother spinning up threads for tiny grids
+	const GLuint min_rows_per_thread = 16;
+	if (threads > rows / min_rows_per_thread) threads = rows / min_rows_per_thread;
+	if (threads < 2)
+	{
+		generateRows(out, cols, 0, rows, col0, row0, xstep, zstep);
+		return;
+	}
+
+	vector<thread> workers;
+	GLuint band = (rows + threads - 1) / threads;
+	for (GLuint start = 0; start < rows; start += band)
+	{
+		GLuint end = start + band;
+		if (end > rows) end = rows;
+		workers.push_back(thread(&noise_engine::generateRows, this, out, cols, start, end, col0, row0, xstep, zstep));
+	}
+	for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+}
+
+
+void noise_engine::generateRows(GLfloat* out, GLuint cols, GLuint row_start, GLuint row_end,
+	GLint col0, GLint row0, GLfloat xstep, GLfloat zstep)
+{
+	const GLuint octaves = perlin_octaves;
+
+	for (GLuint row = row_start; row < row_end; row++)
+	{
+		GLfloat z = zstep * GLfloat(row0 + (GLint)row);
+		GLuint col = 0;
+
+#if NOISE_LANES > 1
+		if (use_simd)
+		{
+			float lanes[NOISE_LANES];
+			for (; col + NOISE_LANES <= cols; col += NOISE_LANES)
+			{
+				lane_t x = lane_t(xstep) * lane_columns(float(col0 + (GLint)col));
+				lane_t sum(0.f);
+				GLfloat current_scale = perlin_scale;
+				GLfloat current_freq = perlin_freq;
+
+				for (GLuint oct = 0; oct < octaves; oct++)
+				{
+					lane_t val = lane_perlin(x * lane_t(current_freq), lane_t(z * current_freq)) / lane_t(current_scale);
+					sum = sum + val;
+
+					if (keep_octaves)
+					{
+						lane_store(lanes, (sum + lane_t(1.f)) / lane_t(2.f));
+						for (GLuint l = 0; l < NOISE_LANES; l++)
+							out[((size_t)row * cols + col + l) * octaves + oct] = lanes[l];
+					}
+
+					current_freq *= 2.f;
+					current_scale *= perlin_scale;
+				}
+
+				// Streaming mode: write the final height straight into the output row
+				if (!keep_octaves)
+					lane_store(&out[(size_t)row * cols + col], (sum + lane_t(1.f)) / lane_t(2.f));
+			}
+		}
+#endif
+
+		// Scalar path for the remaining columns (or all of them with SIMD disabled)
+		for (; col < cols; col++)
+		{
+			GLfloat x = xstep * GLfloat(col0 + (GLint)col);
+			GLfloat sum = 0;
+			GLfloat current_scale = perlin_scale;
+			GLfloat current_freq = perlin_freq;
+
+			for (GLuint oct = 0; oct < octaves; oct++)
+			{
+				glm::vec2 p(x * current_freq, z * current_freq);
+				GLfloat val = (use_simd ? lane_perlin(p.x, p.y) : glm::perlin(p)) / current_scale;
+				sum += val;
+				if (keep_octaves)
+					out[((size_t)row * cols + col) * octaves + oct] = (sum + 1.f) / 2.f;
+
+				current_freq *= 2.f;
+				current_scale *= perlin_scale;
+			}
+
+			if (!keep_octaves)
+				out[(size_t)row * cols + col] = (sum + 1.f) / 2.f;
+		}
+	}
+}
+
+
+/* Report Perlin samples per second for the reference path (glm::perlin on one
+   thread) against the SIMD path on all hardware threads */
+void noise_engine::benchmark()
+{
+	const GLuint sizes[] = { 256, 1024, 2048 };
+	const GLuint octave_counts[] = { 1, 4, 8 };
+
+	printf("\nnoise_engine benchmark: %s, %u hardware threads\n", simdName(), thread::hardware_concurrency());
+	printf("%8s %8s %16s %16s %8s\n", "grid", "octaves", "scalar (Ms/s)", "engine (Ms/s)", "speedup");
+
+	for (GLuint s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+	{
+		for (GLuint o = 0; o < sizeof(octave_counts) / sizeof(octave_counts[0]); o++)
+		{
+			GLuint n = sizes[s];
+			GLuint octaves = octave_counts[o];
+			vector<GLfloat> reference((size_t)n * n);
+			vector<GLfloat> result((size_t)n * n);
+			GLfloat step = 1.f / (n - 1);
+			double samples = double(n) * n * octaves;
+
+			noise_engine scalar(octaves, 1.f, 2.f);
+			scalar.setSIMD(false);
+			scalar.setThreads(1);
+			chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+			scalar.generate(&reference[0], n, n, 0, 0, step, step);
+			chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+
+			noise_engine engine(octaves, 1.f, 2.f);
+			engine.generate(&result[0], n, n, 0, 0, step, step);
+			chrono::steady_clock::time_point t2 = chrono::steady_clock::now();
+
+			double scalar_secs = chrono::duration<double>(t1 - t0).count();
+			double engine_secs = chrono::duration<double>(t2 - t1).count();
+			bool identical = memcmp(&reference[0], &result[0], reference.size() * sizeof(GLfloat)) == 0;
+
+			printf("%8u %8u %16.2f %16.2f %7.1fx%s\n", n, octaves,
+				samples / scalar_secs / 1e6, samples / engine_secs / 1e6,
+				scalar_secs / engine_secs, identical ? "" : "  MISMATCH");
+		}
+	}
+}
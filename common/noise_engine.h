@@ -0,0 +1,48 @@
+/* noise_engine.h
+   Perlin heightfield generator used by terrain_object.
+   Rows of the heightfield are split into bands, one band per worker thread, and
+   each row is evaluated several samples at a time using SSE (4 lanes) or AVX
+   (8 lanes) when the compiler targets them.
+   The lane kernel performs the same float operations in the same order as
+   glm::perlin(vec2) so the heights are bit-identical to the scalar path
+   (this relies on the compiler not contracting mul/add pairs into FMAs, which
+   is the default for MSVC /fp:precise and for GCC/Clang in ISO C++ mode).
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+
+class noise_engine
+{
+public:
+	noise_engine(GLuint octaves, GLfloat freq, GLfloat scale);
+	~noise_engine();
+
+	/* Fill a grid of cols x rows samples. Sample (row, col) is taken at noise
+	   coordinates (xstep * (col0 + col), zstep * (row0 + row)), so neighbouring grids
+	   that share a sample index get exactly the same value. The octaves are accumulated
+	   in registers and only the final height is stored at out[row * cols + col].
+	   With keep_octaves set, the running sum after every octave is stored instead
+	   at out[(row * cols + col) * octaves + oct] */
+	void generate(GLfloat* out, GLuint cols, GLuint rows,
+		GLint col0, GLint row0, GLfloat xstep, GLfloat zstep);
+
+	void setThreads(GLuint n);		// 0 = one thread per hardware thread
+	void setSIMD(bool enable);		// false = reference glm::perlin path
+	void setKeepOctaves(bool keep);	// Debug: store every octave, not just the final height
+
+	static const char* simdName();	// Name of the instruction set used by the lane kernel
+	static void benchmark();		// Print samples/second for a range of grid sizes and octaves
+
+	GLuint perlin_octaves;
+	GLfloat perlin_freq;
+	GLfloat perlin_scale;
+	GLuint num_threads;
+	bool use_simd;
+	bool keep_octaves;
+
+private:
+	void generateRows(GLfloat* out, GLuint cols, GLuint row_start, GLuint row_end,
+		GLint col0, GLint row0, GLfloat xstep, GLfloat zstep);
+};
@@ -0,0 +1,469 @@
+/* particle_gpu.cpp
+   GPU particle backend, see particle_gpu.h
+*/
+
+#include "particle_gpu.h"
+#include "particle_object.h"
+#include "perf_stats.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <exception>
+
+using namespace std;
+
+/* Work group size of particle_gpu_sort.comp */
+const GLuint SORT_GROUP_SIZE = 256;
+
+particle_gpu::particle_gpu(GLuint capacity)
+{
+	this->capacity = capacity;
+	sort_size = SORT_GROUP_SIZE;
+	while (sort_size < capacity) sort_size *= 2;
+
+	emit_rate = 10000.f;
+	emit_carry = 0;
+	seed = 0;
+	compute_sort = false;
+	allow_compute = true;
+	current = 0;
+	sorted = 0;
+	spawn_serial = 0;
+	update_program = sort_program = sort_compute_program = gather_program = 0;
+	draw_position_buffer = draw_colour_buffer = 0;
+	empty_vao = 0;
+	counter_buffer = 0;
+	for (int s = 0; s < 2; s++)
+	{
+		state_vao[s] = 0;
+		position_buffer[s] = speed_buffer[s] = colour_buffer[s] = key_buffer[s] = 0;
+		key_texture[s] = position_texture[s] = colour_texture[s] = 0;
+	}
+}
+
+
+/* The GL objects are left to destroy(), a global backend is destructed after the
+   context has gone */
+particle_gpu::~particle_gpu()
+{
+}
+
+
+void particle_gpu::destroy()
+{
+	if (!update_program) return;
+
+	glDeleteProgram(update_program);
+	glDeleteProgram(sort_program);
+	glDeleteProgram(gather_program);
+	if (sort_compute_program) glDeleteProgram(sort_compute_program);
+
+	glDeleteVertexArrays(2, state_vao);
+	glDeleteVertexArrays(1, &empty_vao);
+	glDeleteTextures(2, key_texture);
+	glDeleteTextures(2, position_texture);
+	glDeleteTextures(2, colour_texture);
+	glDeleteBuffers(2, position_buffer);
+	glDeleteBuffers(2, speed_buffer);
+	glDeleteBuffers(2, colour_buffer);
+	glDeleteBuffers(2, key_buffer);
+	glDeleteBuffers(1, &counter_buffer);
+	glDeleteBuffers(1, &draw_position_buffer);
+	glDeleteBuffers(1, &draw_colour_buffer);
+	update_program = sort_program = sort_compute_program = gather_program = 0;
+	draw_position_buffer = draw_colour_buffer = 0;
+	empty_vao = 0;
+	counter_buffer = 0;
+	for (int s = 0; s < 2; s++)
+	{
+		state_vao[s] = 0;
+		position_buffer[s] = speed_buffer[s] = colour_buffer[s] = key_buffer[s] = 0;
+		key_texture[s] = position_texture[s] = colour_texture[s] = 0;
+	}
+}
+
+
+/* Compute shaders and shader storage buffers are GL 4.3, the wrapper asks for 4.2 */
+bool particle_gpu::computeSupported()
+{
+	return glext_ARB_compute_shader && glext_ARB_shader_storage_buffer_object && glDispatchCompute != NULL;
+}
+
+
+void particle_gpu::setSeed(GLuint seed)
+{
+	this->seed = seed;
+}
+
+
+void particle_gpu::setComputeSort(bool enable)
+{
+	allow_compute = enable;
+}
+
+
+/* Make a buffer of size bytes, initialised from data if it isn't NULL */
+static GLuint makeBuffer(GLsizeiptr size, const void* data)
+{
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_COPY);
+	return buffer;
+}
+
+
+/* Buffer texture over a buffer, so the sort and gather passes can read any element */
+static GLuint makeBufferTexture(GLenum format, GLuint buffer)
+{
+	GLuint texture;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_BUFFER, texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+	return texture;
+}
+
+
+void particle_gpu::create(const char* shader_dir)
+{
+	string dir(shader_dir);
+	const char* update_outputs[] = { "out_pos_size", "out_speed_life", "out_colour", "out_key" };
+	const char* sort_outputs[] = { "out_key" };
+	const char* gather_outputs[] = { "out_pos_size", "out_colour" };
+	update_program = GLWrapper::LoadTransformFeedbackShader((dir + "particle_gpu_update.vert").c_str(),
+		update_outputs, 4, GL_SEPARATE_ATTRIBS);
+	sort_program = GLWrapper::LoadTransformFeedbackShader((dir + "particle_gpu_sort.vert").c_str(),
+		sort_outputs, 1, GL_INTERLEAVED_ATTRIBS);
+	gather_program = GLWrapper::LoadTransformFeedbackShader((dir + "particle_gpu_gather.vert").c_str(),
+		gather_outputs, 2, GL_SEPARATE_ATTRIBS);
+
+	// The transform feedback sort always works, so a compute shader that won't build isn't fatal
+	if (computeSupported())
+	{
+		try
+		{
+			sort_compute_program = GLWrapper::LoadComputeShader((dir + "particle_gpu_sort.comp").c_str());
+		}
+		catch (exception &e)
+		{
+			printf("particle_gpu: compute sort unavailable (%s), using transform feedback\n", e.what());
+			sort_compute_program = 0;
+		}
+	}
+
+	delta_id = glGetUniformLocation(update_program, "delta");
+	camera_id = glGetUniformLocation(update_program, "camera");
+	seed_id = glGetUniformLocation(update_program, "seed");
+	spawn_base_id = glGetUniformLocation(update_program, "spawn_base");
+	spawn_count_id = glGetUniformLocation(update_program, "spawn_count");
+	capacity_id = glGetUniformLocation(update_program, "capacity");
+	sort_keys_id = glGetUniformLocation(sort_program, "keys");
+	sort_j_id = glGetUniformLocation(sort_program, "j");
+	sort_k_id = glGetUniformLocation(sort_program, "k");
+	gather_keys_id = glGetUniformLocation(gather_program, "keys");
+	gather_positions_id = glGetUniformLocation(gather_program, "positions");
+	gather_colours_id = glGetUniformLocation(gather_program, "colours");
+	if (sort_compute_program)
+	{
+		compute_j_id = glGetUniformLocation(sort_compute_program, "j");
+		compute_k_id = glGetUniformLocation(sort_compute_program, "k");
+	}
+
+	// Every slot starts dead. The state has sort_size slots so the update pass writes
+	// the padding keys of the sort every frame, slots past capacity are never used
+	vector<glm::vec4> zero(sort_size, glm::vec4(0));
+	vector<glm::vec4> dead(sort_size, glm::vec4(0, 0, 0, -1.f));
+	vector<GLuint> black(sort_size, 0);
+	for (int s = 0; s < 2; s++)
+	{
+		position_buffer[s] = makeBuffer(sort_size * sizeof(glm::vec4), &zero[0]);
+		speed_buffer[s] = makeBuffer(sort_size * sizeof(glm::vec4), &dead[0]);
+		colour_buffer[s] = makeBuffer(sort_size * sizeof(GLuint), &black[0]);
+		key_buffer[s] = makeBuffer(sort_size * sizeof(glm::vec2), NULL);
+
+		position_texture[s] = makeBufferTexture(GL_RGBA32F, position_buffer[s]);
+		colour_texture[s] = makeBufferTexture(GL_R32UI, colour_buffer[s]);
+		key_texture[s] = makeBufferTexture(GL_RG32F, key_buffer[s]);
+
+		glGenVertexArrays(1, &state_vao[s]);
+		glBindVertexArray(state_vao[s]);
+		glBindBuffer(GL_ARRAY_BUFFER, position_buffer[s]);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, 0);
+		glBindBuffer(GL_ARRAY_BUFFER, speed_buffer[s]);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 0, 0);
+		glBindBuffer(GL_ARRAY_BUFFER, colour_buffer[s]);
+		glEnableVertexAttribArray(2);
+		glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, 0, 0);
+	}
+	glGenVertexArrays(1, &empty_vao);
+	glBindVertexArray(0);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+	draw_position_buffer = makeBuffer(capacity * sizeof(glm::vec4), NULL);
+	draw_colour_buffer = makeBuffer(capacity * sizeof(GLuint), NULL);
+	GLuint zero_count = 0;
+	counter_buffer = makeBuffer(sizeof(GLuint), &zero_count);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+/* Emit, simulate, sort and gather on the GPU. Emission carries the fraction of a
+   particle to the next update exactly like particle_object::update() and particles are numbered in the same order, so with
+   the same seed both backends emit the same particles */
+void particle_gpu::update(double delta, glm::vec3 camera)
+{
+	emit_carry += delta * emit_rate;
+	int newparticles = (int)emit_carry;
+	emit_carry -= newparticles;
+	last_camera = camera;
+
+	// Reset the emission counter once last frame's increments have landed
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	GLuint zero_count = 0;
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counter_buffer);
+	glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(GLuint), &zero_count);
+	glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, counter_buffer);
+
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	// Emit and simulate from the current state buffers into the others
+	GLuint next = 1 - current;
+	glUseProgram(update_program);
+	glUniform1f(delta_id, (GLfloat)delta);
+	glUniform3f(camera_id, camera.x, camera.y, camera.z);
+	glUniform1ui(seed_id, seed);
+	glUniform1ui(spawn_base_id, spawn_serial);
+	glUniform1ui(spawn_count_id, (GLuint)newparticles);
+	glUniform1i(capacity_id, (GLint)capacity);
+	glBindVertexArray(state_vao[current]);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, position_buffer[next]);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, speed_buffer[next]);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 2, colour_buffer[next]);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 3, key_buffer[0]);
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, sort_size);
+	glEndTransformFeedback();
+	for (GLuint b = 0; b < 4; b++) glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, b, 0);
+	current = next;
+	spawn_serial += newparticles;	// Requests past the free slots are dropped, as on the CPU
+
+	sortKeys();
+
+	// Gather the draw data in sorted order
+	glUseProgram(gather_program);
+	glBindVertexArray(empty_vao);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_BUFFER, key_texture[sorted]);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_BUFFER, position_texture[current]);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_BUFFER, colour_texture[current]);
+	glUniform1i(gather_keys_id, 0);
+	glUniform1i(gather_positions_id, 1);
+	glUniform1i(gather_colours_id, 2);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, draw_position_buffer);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 1, draw_colour_buffer);
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, capacity);
+	glEndTransformFeedback();
+	for (GLuint b = 0; b < 2; b++) glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, b, 0);
+
+	for (GLuint t = 0; t < 3; t++)
+	{
+		glActiveTexture(GL_TEXTURE0 + t);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+	glActiveTexture(GL_TEXTURE0);
+	glBindVertexArray(0);
+	glDisable(GL_RASTERIZER_DISCARD);
+}
+
+
+/* Bitonic sort of the sort_size keys in key_buffer[0], furthest first. The compute
+   shader sorts in place; the transform feedback passes ping-pong between the two key
+   buffers. Either way sorted says which buffer holds the result */
+void particle_gpu::sortKeys()
+{
+	compute_sort = allow_compute && sort_compute_program != 0;
+	if (compute_sort)
+	{
+		glUseProgram(sort_compute_program);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, key_buffer[0]);
+		for (GLuint k = 2; k <= sort_size; k <<= 1)
+		{
+			for (GLuint j = k >> 1; j > 0; j >>= 1)
+			{
+				glUniform1ui(compute_j_id, j);
+				glUniform1ui(compute_k_id, k);
+				glDispatchCompute(sort_size / SORT_GROUP_SIZE, 1, 1);
+				glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+			}
+		}
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, 0);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+		sorted = 0;
+		return;
+	}
+
+	glUseProgram(sort_program);
+	glBindVertexArray(empty_vao);
+	glActiveTexture(GL_TEXTURE0);
+	glUniform1i(sort_keys_id, 0);
+	GLuint source = 0;
+	for (GLuint k = 2; k <= sort_size; k <<= 1)
+	{
+		for (GLuint j = k >> 1; j > 0; j >>= 1)
+		{
+			glBindTexture(GL_TEXTURE_BUFFER, key_texture[source]);
+			glUniform1i(sort_j_id, (GLint)j);
+			glUniform1i(sort_k_id, (GLint)k);
+			glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, key_buffer[1 - source]);
+			glBeginTransformFeedback(GL_POINTS);
+			glDrawArrays(GL_POINTS, 0, sort_size);
+			glEndTransformFeedback();
+			source = 1 - source;
+		}
+	}
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	sorted = source;
+}
+
+
+particle_stats particle_gpu::readStats()
+{
+	vector<glm::vec4> positions(capacity), speeds(capacity);
+	glBindBuffer(GL_ARRAY_BUFFER, position_buffer[current]);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, capacity * sizeof(glm::vec4), &positions[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, speed_buffer[current]);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, capacity * sizeof(glm::vec4), &speeds[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	particle_stats stats = particle_stats();
+	for (GLuint i = 0; i < capacity; i++)
+	{
+		if (speeds[i].w <= 0.0f) continue;
+		stats.live++;
+		stats.mean_position += glm::dvec3(positions[i]);
+		stats.mean_speed += glm::dvec3(speeds[i]);
+		stats.mean_life += speeds[i].w;
+		stats.mean_size += positions[i].w;
+	}
+	if (stats.live)
+	{
+		stats.mean_position /= double(stats.live);
+		stats.mean_speed /= double(stats.live);
+		stats.mean_life /= stats.live;
+		stats.mean_size /= stats.live;
+	}
+	return stats;
+}
+
+
+particle_stats particle_gpu::cpuStats(const particle_object& system)
+{
+	const particle_store& p = system.particles;
+	particle_stats stats = particle_stats();
+	for (GLuint i = 0; i < p.capacity; i++)
+	{
+		if (p.life[i] <= 0.0f) continue;
+		stats.live++;
+		stats.mean_position += glm::dvec3(p.pos_x[i], p.pos_y[i], p.pos_z[i]);
+		stats.mean_speed += glm::dvec3(p.speed_x[i], p.speed_y[i], p.speed_z[i]);
+		stats.mean_life += p.life[i];
+		stats.mean_size += p.size[i];
+	}
+	if (stats.live)
+	{
+		stats.mean_position /= double(stats.live);
+		stats.mean_speed /= double(stats.live);
+		stats.mean_life /= stats.live;
+		stats.mean_size /= stats.live;
+	}
+	return stats;
+}
+
+
+/* Live particles must come first, each no nearer the camera than the next */
+GLuint particle_gpu::sortErrors()
+{
+	vector<glm::vec4> draw(capacity);
+	glBindBuffer(GL_ARRAY_BUFFER, draw_position_buffer);
+	glGetBufferSubData(GL_ARRAY_BUFFER, 0, capacity * sizeof(glm::vec4), &draw[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	GLuint errors = 0;
+	for (GLuint i = 1; i < capacity; i++)
+	{
+		if (draw[i].w == 0.0f) continue;
+		if (draw[i - 1].w == 0.0f) errors++;
+		else
+		{
+			glm::vec3 a = glm::vec3(draw[i - 1]) - last_camera;
+			glm::vec3 b = glm::vec3(draw[i]) - last_camera;
+			if (glm::dot(a, a) < glm::dot(b, b)) errors++;
+		}
+	}
+	return errors;
+}
+
+
+/* Run the CPU backend and the GPU backend with the same seed, emission rate and
+   camera path for 300 frames, printing their statistics every 60 frames. Both emit
+   the same particles, so the statistics should agree to float rounding */
+void particle_gpu::conformanceTest()
+{
+	const GLuint capacity = 20000;
+	const GLuint frames = 300;
+	const double delta = 1.0 / 60.0;
+
+	int runs = computeSupported() ? 2 : 1;
+	for (int run = 0; run < runs; run++)
+	{
+		particle_object cpu(capacity);
+		cpu.setSeed(7);
+		cpu.emit_rate = 6000.f;
+
+		particle_gpu gpu(capacity);
+		gpu.create();
+		gpu.setSeed(7);
+		gpu.emit_rate = 6000.f;
+		gpu.setComputeSort(run == 0 && runs == 2);
+
+		double cpu_ms = 0, gpu_ms = 0;
+		bool pass = true;
+		printf("\nparticle_gpu conformance: %u slots, %s sort\n", capacity,
+			gpu.allow_compute && gpu.sort_compute_program ? "compute" : "transform feedback");
+		for (GLuint f = 1; f <= frames; f++)
+		{
+			glm::vec3 camera(10.f * sinf(f * 0.01f), 2.f, 10.f * cosf(f * 0.01f));
+			double t0 = secondsNow();
+			cpu.update(delta, camera);
+			double t1 = secondsNow();
+			gpu.update(delta, camera);
+			glFinish();
+			double t2 = secondsNow();
+			cpu_ms += (t1 - t0) * 1000.0;
+			gpu_ms += (t2 - t1) * 1000.0;
+
+			if (f % 60) continue;
+			particle_stats c = cpuStats(cpu);
+			particle_stats g = gpu.readStats();
+			glm::dvec3 dp = glm::abs(c.mean_position - g.mean_position);
+			glm::dvec3 ds = glm::abs(c.mean_speed - g.mean_speed);
+			double error = glm::max(glm::max(glm::max(dp.x, dp.y), glm::max(dp.z, ds.x)), glm::max(ds.y, ds.z));
+			error = glm::max(error, glm::max(fabs(c.mean_life - g.mean_life), fabs(c.mean_size - g.mean_size)));
+			GLuint sort_errors = gpu.sortErrors();
+			bool ok = c.live == g.live && error < 1e-3 && sort_errors == 0;
+			pass = pass && ok;
+			printf("  frame %3u: live %5u / %5u, mean y %8.4f / %8.4f, mean life %6.4f / %6.4f, max error %.2e, sort errors %u %s\n",
+				f, c.live, g.live, c.mean_position.y, g.mean_position.y, c.mean_life, g.mean_life, error, sort_errors,
+				ok ? "" : "MISMATCH");
+		}
+		printf("  cpu %.3f ms/frame, gpu %.3f ms/frame (with glFinish): %s\n", cpu_ms / frames, gpu_ms / frames,
+			pass ? "PASS" : "FAIL");
+		gpu.destroy();
+	}
+}
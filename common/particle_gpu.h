@@ -0,0 +1,81 @@
+/* particle_gpu.h
+   GPU backend for particle_object: the particles live in GL buffers and never come
+   back to the CPU. Each frame
+     - a transform feedback pass emits new particles into free slots, taking them from
+       an atomic counter, and simulates every particle like particle_store::simulate
+     - the keys (squared camera distance, slot) are bitonic sorted furthest first, with
+       a compute shader when the context has GL 4.3 compute shaders and with transform
+       feedback passes through a buffer texture otherwise
+     - a gather pass writes position, size and colour in sorted order for drawing
+   The emitter matches particle_object::update() with the same seed, so the CPU
+   backend is the reference that conformanceTest() compares against.
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include <glm/glm.hpp>
+
+/* Aggregate statistics used to compare the backends */
+struct particle_stats
+{
+	GLuint live;
+	glm::dvec3 mean_position;
+	glm::dvec3 mean_speed;
+	double mean_life;
+	double mean_size;
+};
+
+class particle_object;
+
+class particle_gpu
+{
+public:
+	particle_gpu(GLuint capacity = 10000);
+	~particle_gpu();
+
+	void create(const char* shader_dir = "../../shaders/");	// Needs a GL 4.2 context, throws if a shader fails
+	void destroy();						// Delete the GL objects, before the context goes
+	void setSeed(GLuint seed);
+	void setComputeSort(bool enable);	// false = transform feedback sort even with compute shaders
+	void update(double delta, glm::vec3 camera);
+
+	particle_stats readStats();			// Reads the particle state back, slow
+	GLuint sortErrors();				// Reads the draw data back and counts keys out of order
+
+	static bool computeSupported();
+	static particle_stats cpuStats(const particle_object& system);
+	static void conformanceTest();		// Run both backends side by side and compare their statistics
+
+	GLuint capacity;
+	GLuint sort_size;					// Keys sorted, capacity rounded up to a power of two
+	GLfloat emit_rate;					// New particles per second
+	double emit_carry;					// Fraction of a particle left over from the last update()
+	GLuint seed;
+	bool compute_sort;					// The last update() sorted with the compute shader
+
+	/* Draw data in back to front order, capacity entries, dead particles have size 0 */
+	GLuint draw_position_buffer;		// vec4 position and size
+	GLuint draw_colour_buffer;			// RGBA8
+
+private:
+	void sortKeys();
+
+	GLuint update_program, sort_program, sort_compute_program, gather_program;
+	GLuint state_vao[2];				// Inputs of the update pass for each set of state buffers
+	GLuint empty_vao;					// Sort and gather passes read buffer textures only
+	GLuint position_buffer[2], speed_buffer[2], colour_buffer[2];	// sort_size slots, see update()
+	GLuint key_buffer[2];
+	GLuint key_texture[2], position_texture[2], colour_texture[2];
+	GLuint counter_buffer;
+	GLuint current;						// Set of state buffers holding the latest particles
+	GLuint sorted;						// Key buffer holding the sorted keys
+	GLuint spawn_serial;				// Serial of the next particle emitted
+	bool allow_compute;
+	glm::vec3 last_camera;				// Camera of the last update(), for sortErrors()
+
+	/* Uniform locations */
+	GLuint delta_id, camera_id, seed_id, spawn_base_id, spawn_count_id, capacity_id;
+	GLuint sort_keys_id, sort_j_id, sort_k_id, compute_j_id, compute_k_id;
+	GLuint gather_keys_id, gather_positions_id, gather_colours_id;
+};
@@ -1,307 +1,1120 @@
-/*
- particle_object.cpp
- Component from a basic example of a particle animation
- Adaped from the particle animation tutorial from:
- http://www.opengl-tutorial.org/intermediate-tutorials/billboards-particles/particles-instancing/
-
-  Iain Martin November 2014
-*/
-
-// Enable GLM Experimental for Quaternians
-#define GLM_ENABLE_EXPERIMENTAL
-
-#include "particle_object.h"
-#include <algorithm>
-#include <glm/gtx/norm.hpp>
-#include "soil.h"
-
-particle_object::particle_object()
-{
-	LastUsedParticle = 0;
-}
-
-
-particle_object::~particle_object()
-{
-}
-
-void particle_object::SortParticles(){
-	std::sort(&ParticlesContainer[0], &ParticlesContainer[MaxParticles]);
-}
-
-
-void particle_object::create(GLuint program)
-{
-	glGenVertexArrays(1, &VertexArrayID);
-	glBindVertexArray(VertexArrayID);
-	programID = program;
-	glUseProgram(programID);
-
-	// The VBO containing the 4 vertices of the particles.
-	// Thanks to instancing, they will be shared by all particles.
-	static const GLfloat g_vertex_buffer_data[] = {
-		-0.5f, -0.5f, 0.0f,
-		0.5f, -0.5f, 0.0f,
-		-0.5f, 0.5f, 0.0f,
-		0.5f, 0.5f, 0.0f,
-	};
-
-	g_particule_position_size_data = new GLfloat[MaxParticles * 4];
-	g_particule_color_data = new GLubyte[MaxParticles * 4];
-
-	for (int i = 0; i<MaxParticles; i++){
-		ParticlesContainer[i].life = -1.0f;
-		ParticlesContainer[i].cameradistance = -1.0f;
-	}
-	
-	glGenBuffers(1, &billboard_vertex_buffer);
-	glBindBuffer(GL_ARRAY_BUFFER, billboard_vertex_buffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(g_vertex_buffer_data), g_vertex_buffer_data, GL_STATIC_DRAW);
-
-	// The VBO containing the positions and sizes of the particles
-	glGenBuffers(1, &particles_position_buffer);
-	glBindBuffer(GL_ARRAY_BUFFER, particles_position_buffer);
-	// Initialize with empty (NULL) buffer : it will be updated later, each frame.
-	glBufferData(GL_ARRAY_BUFFER, MaxParticles * 4 * sizeof(GLfloat), NULL, GL_STREAM_DRAW);
-
-	// The VBO containing the colors of the particles
-
-	glGenBuffers(1, &particles_color_buffer);
-	glBindBuffer(GL_ARRAY_BUFFER, particles_color_buffer);
-	// Initialize with empty (NULL) buffer : it will be updated later, each frame.
-	glBufferData(GL_ARRAY_BUFFER, MaxParticles * 4 * sizeof(GLubyte), NULL, GL_STREAM_DRAW);
-
-	// Vertex shader
-	GLuint CameraRight_worldspace_ID = glGetUniformLocation(programID, "CameraRight_worldspace");
-	GLuint CameraUp_worldspace_ID = glGetUniformLocation(programID, "CameraUp_worldspace");
-	GLuint ViewProjMatrixID = glGetUniformLocation(programID, "VP");
-
-	/* load an image file directly as a new OpenGL texture */
-	Texture = SOIL_load_OGL_texture("..\\..\\images\\circle.png", SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID,
-		SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT);
-
-	/* check for an error during the load process */
-	if (Texture == 0)
-	{
-		printf("TexID SOIL loading error: '%s'\n", SOIL_last_result());
-	}
-
-	// Enable depth test
-	glEnable(GL_DEPTH_TEST);
-	// Accept fragment if it closer to the camera than the former one
-	glDepthFunc(GL_LESS);
-
-	/* Define the uniform variables */
-	defineUniforms();
-
-	lastTime = glfwGetTime();
-}
-
-
-/* Update the particle animation and draw the particles */
-void particle_object::drawParticles(glm::mat4 ProjectionMatrix, glm::mat4 ViewMatrix)
-{
-	double currentTime = glfwGetTime();
-	double delta = currentTime - lastTime;
-	lastTime = currentTime;
-
-	glBindVertexArray(VertexArrayID);
-
-	// We will need the camera's position in order to sort the particles
-	// w.r.t the camera's distance.
-	glm::vec3 CameraPosition(glm::inverse(ViewMatrix)[3]);
-	glm::mat4 ViewProjectionMatrix = ProjectionMatrix * ViewMatrix;
-
-	// Generate 10 new particule each millisecond,
-	// but limit this to 16 ms (60 fps), or if you have 1 long frame (1sec),
-	// newparticles will be huge and the next frame even longer.
-	int newparticles = (int)(delta*10000.0);
-	if (newparticles > (int)(0.016f*10000.0))
-		newparticles = (int)(0.016f*10000.0);
-
-	for (int i = 0; i<newparticles; i++){
-		int particleIndex = FindUnusedParticle();
-		ParticlesContainer[particleIndex].life = 5.0f; // This particle will live 5 seconds.
-		ParticlesContainer[particleIndex].pos = glm::vec3(0, 0, -20.0f);
-
-		float spread = 1.5f;
-		glm::vec3 maindir = glm::vec3(0.0f, 10.0f, 0.0f);
-		// Very bad way to generate a random direction; 
-		// See for instance http://stackoverflow.com/questions/5408276/python-uniform-spherical-distribution instead,
-		// combined with some user-controlled parameters (main direction, spread, etc)
-		glm::vec3 randomdir = glm::vec3(
-			(rand() % 2000 - 1000.0f) / 1000.0f,
-			(rand() % 2000 - 1000.0f) / 1000.0f,
-			(rand() % 2000 - 1000.0f) / 1000.0f
-			);
-		
-		ParticlesContainer[particleIndex].speed = maindir + randomdir*spread;
-
-		// Very bad way to generate a random color
-		ParticlesContainer[particleIndex].r = rand() % 256;
-		ParticlesContainer[particleIndex].g = rand() % 256;
-		ParticlesContainer[particleIndex].b = rand() % 256;
-		ParticlesContainer[particleIndex].a = (rand() % 256) / 3;
-
-		ParticlesContainer[particleIndex].size = (rand() % 1000) / 2000.0f + 0.1f;
-	}
-
-	// Simulate all particles
-	int ParticlesCount = 0;
-	for (int i = 0; i<MaxParticles; i++){
-
-		Particle& p = ParticlesContainer[i]; // shortcut
-
-		if (p.life > 0.0f){
-
-			// Decrease life
-			p.life -= delta;
-			if (p.life > 0.0f){
-
-				// Simulate simple physics : gravity only, no collisions
-				p.speed += glm::vec3(0.0f, -9.81f, 0.0f) * (float)delta * 0.5f;
-				p.pos += p.speed * (float)delta;
-				p.cameradistance = glm::length2(p.pos - CameraPosition);
-				//ParticlesContainer[i].pos += glm::vec3(0.0f,10.0f, 0.0f) * (float)delta;
-
-				// Fill the GPU buffer
-				g_particule_position_size_data[4 * ParticlesCount + 0] = p.pos.x;
-				g_particule_position_size_data[4 * ParticlesCount + 1] = p.pos.y;
-				g_particule_position_size_data[4 * ParticlesCount + 2] = p.pos.z;
-
-				g_particule_position_size_data[4 * ParticlesCount + 3] = p.size;
-
-				g_particule_color_data[4 * ParticlesCount + 0] = p.r;
-				g_particule_color_data[4 * ParticlesCount + 1] = p.g;
-				g_particule_color_data[4 * ParticlesCount + 2] = p.b;
-				g_particule_color_data[4 * ParticlesCount + 3] = p.a;
-
-			}
-			else{
-				// Particles that just died will be put at the end of the buffer in SortParticles();
-				p.cameradistance = -1.0f;
-			}
-
-			ParticlesCount++;
-		}
-	}
-
-	SortParticles();
-
-	// Update the buffers that OpenGL uses for rendering.
-	// There are much more sophisticated means to stream data from the CPU to the GPU, 
-	// but this is outside the scope of this tutorial.
-	// http://www.opengl.org/wiki/Buffer_Object_Streaming
-
-	glBindBuffer(GL_ARRAY_BUFFER, particles_position_buffer);
-	glBufferData(GL_ARRAY_BUFFER, MaxParticles * 4 * sizeof(GLfloat), NULL, GL_STREAM_DRAW); // Buffer orphaning, a common way to improve streaming perf. See above link for details.
-	glBufferSubData(GL_ARRAY_BUFFER, 0, ParticlesCount * sizeof(GLfloat)* 4, g_particule_position_size_data);
-
-	glBindBuffer(GL_ARRAY_BUFFER, particles_color_buffer);
-	glBufferData(GL_ARRAY_BUFFER, MaxParticles * 4 * sizeof(GLubyte), NULL, GL_STREAM_DRAW); // Buffer orphaning, a common way to improve streaming perf. See above link for details.
-	glBufferSubData(GL_ARRAY_BUFFER, 0, ParticlesCount * sizeof(GLubyte)* 4, g_particule_color_data);
-
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-	// Use our shader
-	glUseProgram(programID);
-
-	// Bind our texture in Texture Unit 0
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, Texture);
-	// Set our "myTextureSampler" sampler to user Texture Unit 0
-	glUniform1i(TextureID, 0);
-
-	// Same as the billboards tutorial
-	glUniform3f(CameraRight_worldspace_ID, ViewMatrix[0][0], ViewMatrix[1][0], ViewMatrix[2][0]);
-	glUniform3f(CameraUp_worldspace_ID, ViewMatrix[0][1], ViewMatrix[1][1], ViewMatrix[2][1]);
-
-	glUniformMatrix4fv(ViewProjMatrixID, 1, GL_FALSE, &ViewProjectionMatrix[0][0]);
-
-	// 1rst attribute buffer : vertices
-	glEnableVertexAttribArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, billboard_vertex_buffer);
-	glVertexAttribPointer(
-		0,                  // attribute. No particular reason for 0, but must match the layout in the shader.
-		3,                  // size
-		GL_FLOAT,           // type
-		GL_FALSE,           // normalized?
-		0,                  // stride
-		(void*)0            // array buffer offset
-		);
-
-	// 2nd attribute buffer : positions of particles' centers
-	glEnableVertexAttribArray(1);
-	glBindBuffer(GL_ARRAY_BUFFER, particles_position_buffer);
-	glVertexAttribPointer(
-		1,                                // attribute. No particular reason for 1, but must match the layout in the shader.
-		4,                                // size : x + y + z + size => 4
-		GL_FLOAT,                         // type
-		GL_FALSE,                         // normalized?
-		0,                                // stride
-		(void*)0                          // array buffer offset
-		);
-
-	// 3rd attribute buffer : particles' colors
-	glEnableVertexAttribArray(2);
-	glBindBuffer(GL_ARRAY_BUFFER, particles_color_buffer);
-	glVertexAttribPointer(
-		2,                                // attribute. No particular reason for 1, but must match the layout in the shader.
-		4,                                // size : r + g + b + a => 4
-		GL_UNSIGNED_BYTE,                 // type
-		GL_TRUE,                          // normalized?    *** YES, this means that the unsigned char[4] will be accessible with a vec4 (floats) in the shader ***
-		0,                                // stride
-		(void*)0                          // array buffer offset
-		);
-
-	// These functions are specific to glDrawArrays*Instanced*.
-	// The first parameter is the attribute buffer we're talking about.
-	// The second parameter is the "rate at which generic vertex attributes advance when rendering multiple instances"
-	// http://www.opengl.org/sdk/docs/man/xhtml/glVertexAttribDivisor.xml
-	glVertexAttribDivisor(0, 0); // particles vertices : always reuse the same 4 vertices -> 0
-	glVertexAttribDivisor(1, 1); // positions : one per quad (its center)                 -> 1
-	glVertexAttribDivisor(2, 1); // color : one per quad                                  -> 1
-
-	// Draw the particules !
-	// This draws many times a small triangle_strip (which looks like a quad).
-	// This is equivalent to :
-	// for(i in ParticlesCount) : glDrawArrays(GL_TRIANGLE_STRIP, 0, 4), 
-	// but faster.
-	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, ParticlesCount);
-
-	glDisable(GL_BLEND);
-}
-
-
-void particle_object::defineUniforms()
-{
-	glBindVertexArray(VertexArrayID);
-	glUseProgram(programID);
-
-	CameraRight_worldspace_ID = glGetUniformLocation(programID, "CameraRight_worldspace");
-	CameraUp_worldspace_ID = glGetUniformLocation(programID, "CameraUp_worldspace");
-	ViewProjMatrixID = glGetUniformLocation(programID, "VP");
-
-	// fragment shader
-	TextureID = glGetUniformLocation(programID, "myTextureSampler");
-}
-
-
-int particle_object::FindUnusedParticle()
-{
-	for (int i = LastUsedParticle; i<MaxParticles; i++){
-		if (ParticlesContainer[i].life < 0){
-			LastUsedParticle = i;
-			return i;
-		}
-	}
-
-	for (int i = 0; i<LastUsedParticle; i++){
-		if (ParticlesContainer[i].life < 0){
-			LastUsedParticle = i;
-			return i;
-		}
-	}
-	return 0; // All particles are taken, override the first one
-}
\ No newline at end of file
+/*
+ particle_object.cpp
+ Component from a basic example of a particle animation
+ Adaped from the particle animation tutorial from:
+ http://www.opengl-tutorial.org/intermediate-tutorials/billboards-particles/particles-instancing/
+
+  Iain Martin November 2014
+*/
+
+// Enable GLM Experimental for Quaternians
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include "particle_object.h"
+#include "particle_gpu.h"
+#include "perf_stats.h"
+#include "hash_random.h"
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <glm/gtx/norm.hpp>
+#include "soil.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define PARTICLE_SIMD 1
+#else
+	#define PARTICLE_SIMD 0
+#endif
+
+/* Floats in each particle_store stream are padded to a multiple of this so every stream
+   starts 32 bytes aligned and the SIMD loop never needs a partial group */
+const GLuint PARTICLE_STREAM_ALIGN = 8;
+
+/* Particles per job_system chunk, a multiple of PARTICLE_STREAM_ALIGN so chunks of
+   the streams start on SIMD groups */
+const GLuint PARTICLE_JOB_GRAIN = 8192;
+
+particle_store::particle_store()
+{
+	capacity = 0;
+	use_simd = true;
+	block = NULL;
+	pos_x = pos_y = pos_z = speed_x = speed_y = speed_z = size = life = cameradistance = NULL;
+	colour = NULL;
+}
+
+
+particle_store::~particle_store()
+{
+	delete[] block;
+}
+
+
+void particle_store::allocate(GLuint n)
+{
+	delete[] block;
+	capacity = n;
+
+	// Nine float streams and the colours, each rounded up to whole SIMD groups
+	size_t stream = (n + PARTICLE_STREAM_ALIGN - 1) / PARTICLE_STREAM_ALIGN * PARTICLE_STREAM_ALIGN;
+	block = new GLubyte[stream * (9 * sizeof(GLfloat) + 4) + 32];
+	GLubyte* p = block + (32 - (size_t)block % 32) % 32;
+
+	GLfloat** streams[] = { &pos_x, &pos_y, &pos_z, &speed_x, &speed_y, &speed_z, &size, &life, &cameradistance };
+	for (int s = 0; s < 9; s++)
+	{
+		*streams[s] = (GLfloat*)p;
+		p += stream * sizeof(GLfloat);
+	}
+	colour = p;
+
+	// Padding included, so the SIMD loop sees dead particles past the end
+	memset(pos_x, 0, stream * 9 * sizeof(GLfloat) + stream * 4);
+	for (size_t i = 0; i < stream; i++)
+	{
+		life[i] = -1.0f;
+		cameradistance[i] = -1.0f;
+	}
+}
+
+
+void particle_store::grow(GLuint n)
+{
+	if (n <= capacity) return;
+
+	// Copy the streams into a new store and take over its memory
+	particle_store bigger;
+	bigger.allocate(n);
+	GLfloat** from[] = { &pos_x, &pos_y, &pos_z, &speed_x, &speed_y, &speed_z, &size, &life, &cameradistance };
+	GLfloat** to[] = { &bigger.pos_x, &bigger.pos_y, &bigger.pos_z, &bigger.speed_x, &bigger.speed_y,
+		&bigger.speed_z, &bigger.size, &bigger.life, &bigger.cameradistance };
+	for (int s = 0; s < 9; s++)
+		memcpy(*to[s], *from[s], capacity * sizeof(GLfloat));
+	memcpy(bigger.colour, colour, capacity * 4);
+
+	std::swap(block, bigger.block);
+	for (int s = 0; s < 9; s++) *from[s] = *to[s];
+	colour = bigger.colour;
+	capacity = n;
+}
+
+
+void particle_store::setSIMD(bool enable)
+{
+	use_simd = enable;
+}
+
+
+/* Update every live particle: decrease its life, then if it is still alive apply
+   gravity, move it and work out its squared distance to the camera. Particles that
+   die get a camera distance of -1. Particles are independent, so with a job system
+   the streams are simulated in chunks on its threads */
+void particle_store::simulate(GLfloat delta, glm::vec3 camera, job_system* jobs)
+{
+	if (!jobs)
+	{
+		simulateRange(0, capacity, delta, camera);
+		return;
+	}
+	jobs->parallelFor(capacity, PARTICLE_JOB_GRAIN, [&](GLuint first, GLuint last)
+	{
+		simulateRange(first, last, delta, camera);
+	});
+}
+
+
+/* Simulate particles first to last - 1. The SSE path does the same float operations
+   in the same order as the scalar path, selecting the results per lane with masks
+   instead of branching, so both give identical particles */
+void particle_store::simulateRange(GLuint first, GLuint last, GLfloat delta, glm::vec3 camera)
+{
+	GLfloat gravity = (-9.81f * delta) * 0.5f;
+	GLuint i = first;
+
+#if PARTICLE_SIMD
+	if (use_simd)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 minus_one = _mm_set1_ps(-1.0f);
+		const __m128 d = _mm_set1_ps(delta);
+		const __m128 g = _mm_set1_ps(gravity);
+		const __m128 cx = _mm_set1_ps(camera.x);
+		const __m128 cy = _mm_set1_ps(camera.y);
+		const __m128 cz = _mm_set1_ps(camera.z);
+
+		// Streams are padded to whole groups, so the last group can run past last
+		for (; i < last; i += 4)
+		{
+			__m128 l = _mm_load_ps(life + i);
+			__m128 alive = _mm_cmpgt_ps(l, zero);
+			if (_mm_movemask_ps(alive) == 0) continue;
+
+			__m128 new_life = _mm_sub_ps(l, d);
+			__m128 still = _mm_and_ps(alive, _mm_cmpgt_ps(new_life, zero));
+			_mm_store_ps(life + i, _mm_or_ps(_mm_and_ps(alive, new_life), _mm_andnot_ps(alive, l)));
+
+			__m128 vx = _mm_load_ps(speed_x + i);
+			__m128 vy = _mm_load_ps(speed_y + i);
+			__m128 vz = _mm_load_ps(speed_z + i);
+			vy = _mm_or_ps(_mm_and_ps(still, _mm_add_ps(vy, g)), _mm_andnot_ps(still, vy));
+			_mm_store_ps(speed_y + i, vy);
+
+			__m128 px = _mm_load_ps(pos_x + i);
+			__m128 py = _mm_load_ps(pos_y + i);
+			__m128 pz = _mm_load_ps(pos_z + i);
+			px = _mm_or_ps(_mm_and_ps(still, _mm_add_ps(px, _mm_mul_ps(vx, d))), _mm_andnot_ps(still, px));
+			py = _mm_or_ps(_mm_and_ps(still, _mm_add_ps(py, _mm_mul_ps(vy, d))), _mm_andnot_ps(still, py));
+			pz = _mm_or_ps(_mm_and_ps(still, _mm_add_ps(pz, _mm_mul_ps(vz, d))), _mm_andnot_ps(still, pz));
+			_mm_store_ps(pos_x + i, px);
+			_mm_store_ps(pos_y + i, py);
+			_mm_store_ps(pos_z + i, pz);
+
+			__m128 dx = _mm_sub_ps(px, cx);
+			__m128 dy = _mm_sub_ps(py, cy);
+			__m128 dz = _mm_sub_ps(pz, cz);
+			__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+			// Still alive: new distance, just died: -1, dead before: unchanged
+			__m128 old = _mm_load_ps(cameradistance + i);
+			__m128 died = _mm_or_ps(_mm_and_ps(alive, minus_one), _mm_andnot_ps(alive, old));
+			_mm_store_ps(cameradistance + i, _mm_or_ps(_mm_and_ps(still, dist), _mm_andnot_ps(still, died)));
+		}
+		return;
+	}
+#endif
+
+	for (; i < last; i++)
+	{
+		if (life[i] > 0.0f)
+		{
+			// Decrease life
+			life[i] -= delta;
+			if (life[i] > 0.0f)
+			{
+				// Simulate simple physics : gravity only, no collisions
+				speed_y[i] += gravity;
+				pos_x[i] += speed_x[i] * delta;
+				pos_y[i] += speed_y[i] * delta;
+				pos_z[i] += speed_z[i] * delta;
+
+				GLfloat dx = pos_x[i] - camera.x;
+				GLfloat dy = pos_y[i] - camera.y;
+				GLfloat dz = pos_z[i] - camera.z;
+				cameradistance[i] = dx * dx + dy * dy + dz * dz;
+			}
+			else
+			{
+				cameradistance[i] = -1.0f;
+			}
+		}
+	}
+}
+
+
+particle_object::particle_object(GLuint capacity)
+{
+	VertexArrayID = 0;
+	emit_rate = 10000.f;
+	lastTime = 0;
+	camera = glm::vec3(0);
+	sort_ms = 0;
+	sort_incremental = false;
+	sort_skip = 0;
+	sort_backoff = 0;
+	sort_new = 0;
+	overflow_policy = PARTICLE_OVERFLOW_DROP;
+	gpu = NULL;
+	jobs = &job_system::shared();
+	seed = 0;
+	setCapacity(capacity);
+}
+
+
+particle_object::~particle_object()
+{
+	clock.stop();
+}
+
+
+/* Resize the particle pool, all the particles are removed. The GPU buffers are
+   resized too if create() has been called */
+void particle_object::setCapacity(GLuint capacity)
+{
+	bool threaded = clock.threaded();
+	clock.stop();
+
+	MaxParticles = capacity;
+	particles.allocate(capacity);
+	draw_order.clear();
+	draw_order.reserve(capacity);
+	sort_new = 0;
+	emit_carry = 0;
+
+	// Lowest slots at the top of the free list so particles are packed at the start
+	free_slots.resize(capacity);
+	for (GLuint i = 0; i < capacity; i++) free_slots[i] = capacity - 1 - i;
+	slot_serial.assign(capacity, 0);
+	emission_order.clear();
+	next_serial = 1;
+	spawn_requests = spawn_failures = spawn_recycled = 0;
+	spawn_grows = 0;
+
+	front.count = back.count = 0;
+	front.capacity = back.capacity = capacity;
+	front.free_slots = back.free_slots = capacity;
+	front.spawn_requests = front.spawn_failures = front.spawn_recycled = 0;
+	back.spawn_requests = back.spawn_failures = back.spawn_recycled = 0;
+	front.spawn_grows = back.spawn_grows = 0;
+
+	if (VertexArrayID)
+	{
+		position_stream.create(MaxParticles * 4 * sizeof(GLfloat));
+		colour_stream.create(MaxParticles * 4 * sizeof(GLubyte));
+	}
+	if (threaded) startSimulationThread();
+}
+
+
+/* Restarts the simulation thread if it is running */
+void particle_object::setTickRate(double hz)
+{
+	bool threaded = clock.threaded();
+	clock.stop();
+	clock.setTickRate(hz);
+	if (threaded) startSimulationThread();
+}
+
+
+/* The GPU backend has to be driven from the thread with the GL context, so it always
+   ticks in drawParticles() */
+void particle_object::startSimulationThread()
+{
+	if (gpu) return;
+	clock.start([this](double dt) { tick(dt); });
+}
+
+
+void particle_object::stopSimulationThread()
+{
+	clock.stop();
+}
+
+
+void particle_object::tick(double dt)
+{
+	glm::vec3 c;
+	{
+		std::lock_guard<std::mutex> lock(snapshot_mutex);
+		c = camera;
+	}
+	update(dt, c);
+}
+
+
+void particle_object::setOverflowPolicy(particle_overflow policy)
+{
+	overflow_policy = policy;
+}
+
+
+/* Draw with a GPU backend made by the caller instead of simulating on the CPU, NULL
+   switches back. The two backends keep separate particles */
+void particle_object::setGPUBackend(particle_gpu* backend)
+{
+	if (backend) clock.stop();
+	gpu = backend;
+	if (gpu) gpu->setSeed(seed);
+}
+
+
+void particle_object::setJobSystem(job_system* pool)
+{
+	jobs = pool;
+}
+
+
+void particle_object::setSeed(GLuint seed)
+{
+	this->seed = seed;
+}
+
+
+/* Take a slot for a new particle in O(1): the top of the free list, or when every
+   particle is alive, whatever the overflow policy says. New slots are added to
+   draw_order, a recycled particle keeps its place there */
+int particle_object::allocateParticle()
+{
+	particle_overflow policy = overflow_policy;
+	spawn_requests++;
+	if (free_slots.empty())
+	{
+		if (policy == PARTICLE_OVERFLOW_GROW && MaxParticles > 0)
+		{
+			GLuint old_capacity = MaxParticles;
+			GLuint capacity = old_capacity * 2;
+			particles.grow(capacity);
+			for (GLuint i = capacity; i > old_capacity; i--) free_slots.push_back(i - 1);
+			slot_serial.resize(capacity, 0);
+			MaxParticles = capacity;
+			draw_order.reserve(capacity);
+			spawn_grows++;
+		}
+		else if (policy == PARTICLE_OVERFLOW_RECYCLE_OLDEST)
+		{
+			// Skip entries of particles that have died since they were emitted
+			while (!emission_order.empty())
+			{
+				GLuint slot = emission_order.front().first;
+				GLuint serial = emission_order.front().second;
+				emission_order.pop_front();
+				if (slot_serial[slot] == serial && particles.life[slot] > 0.0f)
+				{
+					slot_serial[slot] = next_serial;
+					emission_order.push_back(std::make_pair(slot, next_serial++));
+					spawn_recycled++;
+					return slot;
+				}
+			}
+			spawn_failures++;
+			return -1;
+		}
+		else
+		{
+			spawn_failures++;
+			return -1;
+		}
+	}
+
+	// Drop entries of dead particles from the front so emission_order stays bounded
+	while (!emission_order.empty() && (slot_serial[emission_order.front().first] != emission_order.front().second
+		|| particles.life[emission_order.front().first] <= 0.0f))
+		emission_order.pop_front();
+
+	GLuint slot = free_slots.back();
+	free_slots.pop_back();
+	slot_serial[slot] = next_serial;
+	if (policy == PARTICLE_OVERFLOW_RECYCLE_OLDEST)
+		emission_order.push_back(std::make_pair(slot, next_serial));
+	next_serial++;
+	draw_order.push_back(slot);
+	return slot;
+}
+
+
+/* Print the allocation state of the last tick, from the snapshot so it can be read
+   while the simulation thread is spawning */
+void particle_object::printSpawnStats()
+{
+	const char* policies[] = { "drop", "recycle oldest", "grow" };
+	GLuint capacity, live, free_count, grows;
+	unsigned long long requests, failures, recycled;
+	{
+		std::lock_guard<std::mutex> lock(snapshot_mutex);
+		capacity = front.capacity;
+		live = front.count;
+		free_count = front.free_slots;
+		requests = front.spawn_requests;
+		failures = front.spawn_failures;
+		recycled = front.spawn_recycled;
+		grows = front.spawn_grows;
+	}
+	printf("particle_object: capacity %u, %u live, %u free, overflow policy %s\n",
+		capacity, live, free_count, policies[overflow_policy]);
+	printf("  spawns %llu, failed %llu, recycled %llu, grown %u times\n",
+		requests, failures, recycled, grows);
+}
+
+
+/* Sort key of a particle: the squared camera distance quantized to the top 24 bits
+   of its float (positive floats order the same as their bit patterns), inverted so
+   the furthest particle has the smallest key, with the particle index below it */
+static inline unsigned long long sortItem(const GLfloat* distance, GLuint i)
+{
+	GLuint bits;
+	memcpy(&bits, &distance[i], sizeof(bits));
+	unsigned long long key = 0xFFFFFFu - (bits >> 8);
+	return (key << 32) | i;
+}
+
+
+/* Order the live particles in draw_order furthest from the camera first for blending.
+   draw_order holds last frame's order of the survivors followed by the particles
+   emitted this frame. Particles move little between frames so the survivors are
+   nearly sorted: they are insertion sorted and the new particles merged in, unless
+   that takes too many moves, in which case everything is radix sorted (three 8 bit
+   passes over the 24 bit key, skipping passes where every key has the same digit).
+   When the insertion sort keeps running out of moves, the frames after each failure
+   go straight to the radix sort, 0, 1, 2, 4 .. 32 of them, so a camera that keeps
+   moving doesn't pay for both sorts every frame */
+void particle_object::SortParticles(){
+	double t0 = secondsNow();
+	GLuint n = (GLuint)draw_order.size();
+	if (n < 2)
+	{
+		sort_ms = 0;
+		return;
+	}
+	sort_items.resize(n);
+	sort_temp.resize(n);
+	for (GLuint i = 0; i < n; i++)
+		sort_items[i] = sortItem(particles.cameradistance, draw_order[i]);
+
+	// Survivors come first, new particles (not yet in last frame's order) after them
+	GLuint survivors = n - std::min(n, sort_new);
+	unsigned long long* items = sort_items.empty() ? NULL : &sort_items[0];
+
+	// Insertion sort with a budget of moves per particle
+	size_t budget = size_t(survivors) * 4 + 1024;
+	bool attempt = sort_skip == 0;
+	if (!attempt) sort_skip--;
+	sort_incremental = attempt;
+	for (GLuint i = 1; i < n && sort_incremental; i++)
+	{
+		// The new particles are sorted on their own first, then merged
+		GLuint first = (i < survivors) ? 0 : survivors;
+		if (i == first) continue;
+		unsigned long long item = items[i];
+		GLuint j = i;
+		while (j > first && items[j - 1] > item)
+		{
+			items[j] = items[j - 1];
+			j--;
+			if (--budget == 0) sort_incremental = false;
+		}
+		items[j] = item;
+	}
+	if (attempt && survivors > 0)
+	{
+		sort_skip = sort_incremental ? 0 : sort_backoff;
+		sort_backoff = sort_incremental ? 0 : std::min(std::max(sort_backoff * 2, 1u), 32u);
+	}
+
+	if (sort_incremental)
+	{
+		if (survivors > 0 && survivors < n)
+			std::merge(items, items + survivors, items + survivors, items + n, &sort_temp[0]);
+		else if (n > 0)
+			std::copy(items, items + n, sort_temp.begin());
+		sort_items.swap(sort_temp);
+	}
+	else
+	{
+		// Histograms of the three key digits in one pass
+		GLuint counts[3][256] = {};
+		for (GLuint i = 0; i < n; i++)
+		{
+			GLuint key = GLuint(sort_items[i] >> 32);
+			counts[0][key & 0xFF]++;
+			counts[1][(key >> 8) & 0xFF]++;
+			counts[2][key >> 16]++;
+		}
+
+		for (int pass = 0; pass < 3; pass++)
+		{
+			GLuint* count = counts[pass];
+			GLuint shift = 32 + pass * 8;
+			if (count[(sort_items[0] >> shift) & 0xFF] == n) continue;	// Every key has this digit
+
+			GLuint offset = 0;
+			for (int d = 0; d < 256; d++)
+			{
+				GLuint c = count[d];
+				count[d] = offset;
+				offset += c;
+			}
+			for (GLuint i = 0; i < n; i++)
+				sort_temp[count[(sort_items[i] >> shift) & 0xFF]++] = sort_items[i];
+			sort_items.swap(sort_temp);
+		}
+	}
+
+	for (GLuint i = 0; i < n; i++)
+		draw_order[i] = GLuint(sort_items[i]);
+	sort_ms = (secondsNow() - t0) * 1000.0;
+}
+
+
+void particle_object::create(GLuint program)
+{
+	glGenVertexArrays(1, &VertexArrayID);
+	glBindVertexArray(VertexArrayID);
+	programID = program;
+	glUseProgram(programID);
+
+	// The VBO containing the 4 vertices of the particles.
+	// Thanks to instancing, they will be shared by all particles.
+	static const GLfloat g_vertex_buffer_data[] = {
+		-0.5f, -0.5f, 0.0f,
+		0.5f, -0.5f, 0.0f,
+		-0.5f, 0.5f, 0.0f,
+		0.5f, 0.5f, 0.0f,
+	};
+
+	glGenBuffers(1, &billboard_vertex_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, billboard_vertex_buffer);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(g_vertex_buffer_data), g_vertex_buffer_data, GL_STATIC_DRAW);
+
+	// The streaming VBOs containing the positions and sizes and the colours of the particles,
+	// update() writes them every frame
+	position_stream.create(MaxParticles * 4 * sizeof(GLfloat));
+	colour_stream.create(MaxParticles * 4 * sizeof(GLubyte));
+
+	// Vertex shader
+	GLuint CameraRight_worldspace_ID = glGetUniformLocation(programID, "CameraRight_worldspace");
+	GLuint CameraUp_worldspace_ID = glGetUniformLocation(programID, "CameraUp_worldspace");
+	GLuint ViewProjMatrixID = glGetUniformLocation(programID, "VP");
+
+	/* load an image file directly as a new OpenGL texture */
+	Texture = SOIL_load_OGL_texture("..\\..\\images\\circle.png", SOIL_LOAD_AUTO, SOIL_CREATE_NEW_ID,
+		SOIL_FLAG_MIPMAPS | SOIL_FLAG_INVERT_Y | SOIL_FLAG_NTSC_SAFE_RGB | SOIL_FLAG_COMPRESS_TO_DXT);
+
+	/* check for an error during the load process */
+	if (Texture == 0)
+	{
+		printf("TexID SOIL loading error: '%s'\n", SOIL_last_result());
+	}
+
+	// Enable depth test
+	glEnable(GL_DEPTH_TEST);
+	// Accept fragment if it closer to the camera than the former one
+	glDepthFunc(GL_LESS);
+
+	/* Define the uniform variables */
+	defineUniforms();
+
+	lastTime = glfwGetTime();
+}
+
+
+/* The ring buffers have GL fences and mappings, so they go while the context is still
+   current rather than in the destructor */
+void particle_object::releaseBuffers()
+{
+	position_stream.destroy();
+	colour_stream.destroy();
+}
+
+
+/* One simulation tick: emit new particles, simulate, sort the live particles and
+   publish their draw data for drawParticles() */
+void particle_object::update(double delta, glm::vec3 CameraPosition)
+{
+	// Generate emit_rate new particles each second (10 each millisecond by default).
+	// The fraction left over is carried to the next tick, so any tick rate emits the
+	// same number per second. Long frames can't make this huge, the clock runs at most
+	// a few ticks per frame
+	emit_carry += delta * emit_rate;
+	int newparticles = (int)emit_carry;
+	emit_carry -= newparticles;
+
+	// draw_order holds last frame's live particles, new particles are added after them
+	GLuint kept = (GLuint)draw_order.size();
+
+	for (int i = 0; i<newparticles; i++){
+		// Random numbers come from the seed and the spawn count, not rand(), so the same
+		// seed and frame times give the same particles
+		GLuint spawn = (GLuint)spawn_requests;
+		int particleIndex = allocateParticle();
+		if (particleIndex < 0) continue;	// Dropped, counted in spawn_failures
+		particles.life[particleIndex] = 5.0f; // This particle will live 5 seconds.
+		particles.pos_x[particleIndex] = 0;
+		particles.pos_y[particleIndex] = 0;
+		particles.pos_z[particleIndex] = -20.0f;
+
+		float spread = 1.5f;
+		glm::vec3 maindir = glm::vec3(0.0f, 10.0f, 0.0f);
+		// Very bad way to generate a random direction; 
+		// See for instance http://stackoverflow.com/questions/5408276/python-uniform-spherical-distribution instead,
+		// combined with some user-controlled parameters (main direction, spread, etc)
+		glm::vec3 randomdir = glm::vec3(
+			hashRandom(seed, spawn, 0) * 2.0f - 1.0f,
+			hashRandom(seed, spawn, 1) * 2.0f - 1.0f,
+			hashRandom(seed, spawn, 2) * 2.0f - 1.0f
+			);
+		
+		glm::vec3 speed = maindir + randomdir*spread;
+		particles.speed_x[particleIndex] = speed.x;
+		particles.speed_y[particleIndex] = speed.y;
+		particles.speed_z[particleIndex] = speed.z;
+
+		// Very bad way to generate a random color
+		GLubyte* c = &particles.colour[particleIndex * 4];
+		c[0] = GLubyte(hashRandom(seed, spawn, 3) * 256.0f);
+		c[1] = GLubyte(hashRandom(seed, spawn, 4) * 256.0f);
+		c[2] = GLubyte(hashRandom(seed, spawn, 5) * 256.0f);
+		c[3] = GLubyte(hashRandom(seed, spawn, 6) * 256.0f) / 3;
+
+		particles.size[particleIndex] = hashRandom(seed, spawn, 7) * 0.5f + 0.1f;
+	}
+
+	sort_new = (GLuint)draw_order.size() - kept;
+
+	// Simulate all particles
+	particles.simulate((float)delta, CameraPosition, jobs);
+
+	// Draw the live particles back to front, the slots of particles that died go back on the free list.
+	// Each chunk of draw_order moves its live particles to its start and its dead ones after them,
+	// then the chunks are joined in order, so the result doesn't depend on the number of threads
+	GLuint count = (GLuint)draw_order.size();
+	GLuint new_start = count - sort_new;
+	GLuint num_chunks = (count + PARTICLE_JOB_GRAIN - 1) / PARTICLE_JOB_GRAIN;
+	cull_kept.assign(num_chunks, 0);
+	cull_new_dead.assign(num_chunks, 0);
+	auto cull = [&](GLuint first, GLuint last)
+	{
+		GLuint c = first / PARTICLE_JOB_GRAIN;
+		GLuint live = first;
+		GLuint dead = 0;
+		GLuint* dead_slots = &cull_scratch[first];
+		for (GLuint n = first; n < last; n++){
+			GLuint i = draw_order[n];
+			if (particles.life[i] > 0.0f) draw_order[live++] = i;
+			else{
+				dead_slots[dead++] = i;
+				if (n >= new_start) cull_new_dead[c]++;
+			}
+		}
+		memcpy(&draw_order[live], dead_slots, dead * sizeof(GLuint));
+		cull_kept[c] = live - first;
+	};
+	cull_scratch.resize(count);
+	if (jobs) jobs->parallelFor(count, PARTICLE_JOB_GRAIN, cull);
+	else for (GLuint first = 0; first < count; first += PARTICLE_JOB_GRAIN)
+		cull(first, std::min(first + PARTICLE_JOB_GRAIN, count));
+
+	kept = 0;
+	for (GLuint c = 0; c < num_chunks; c++){
+		GLuint first = c * PARTICLE_JOB_GRAIN;
+		GLuint last = std::min(first + PARTICLE_JOB_GRAIN, count);
+		free_slots.insert(free_slots.end(), draw_order.begin() + first + cull_kept[c], draw_order.begin() + last);
+		if (kept != first)
+			memmove(&draw_order[kept], &draw_order[first], cull_kept[c] * sizeof(GLuint));
+		kept += cull_kept[c];
+		sort_new -= cull_new_dead[c];
+	}
+	draw_order.resize(kept);
+	SortParticles();
+
+	// Fill the back snapshot and swap it in. motion is the movement over this tick,
+	// which drawParticles() takes back off to blend with the previous tick
+	GLuint live = (GLuint)draw_order.size();
+	back.count = live;
+	back.capacity = MaxParticles;
+	back.free_slots = (GLuint)free_slots.size();
+	back.spawn_requests = spawn_requests;
+	back.spawn_failures = spawn_failures;
+	back.spawn_recycled = spawn_recycled;
+	back.spawn_grows = spawn_grows;
+	back.position_size.resize(live * 4);
+	back.motion.resize(live * 3);
+	back.colour.resize(live * 4);
+	GLfloat* positions = back.position_size.data();
+	GLfloat* motion = back.motion.data();
+	GLubyte* colours = back.colour.data();
+	GLfloat d = (GLfloat)delta;
+	auto fill = [&](GLuint first, GLuint last)
+	{
+		for (GLuint n = first; n < last; n++){
+			GLuint i = draw_order[n];
+			positions[4 * n + 0] = particles.pos_x[i];
+			positions[4 * n + 1] = particles.pos_y[i];
+			positions[4 * n + 2] = particles.pos_z[i];
+			positions[4 * n + 3] = particles.size[i];
+			motion[3 * n + 0] = particles.speed_x[i] * d;
+			motion[3 * n + 1] = particles.speed_y[i] * d;
+			motion[3 * n + 2] = particles.speed_z[i] * d;
+			memcpy(&colours[4 * n], &particles.colour[4 * i], 4);
+		}
+	};
+	if (jobs) jobs->parallelFor(live, PARTICLE_JOB_GRAIN, fill);
+	else fill(0, live);
+
+	std::lock_guard<std::mutex> lock(snapshot_mutex);
+	std::swap(front, back);
+}
+
+
+/* Run the simulation ticks that are due (unless the simulation thread runs them) and
+   draw the particles between the last two ticks, so the motion is smooth whatever the
+   tick rate and frame rate */
+void particle_object::drawParticles(glm::mat4 ProjectionMatrix, glm::mat4 ViewMatrix)
+{
+	double currentTime = glfwGetTime();
+	double delta = currentTime - lastTime;
+	lastTime = currentTime;
+
+	// We will need the camera's position in order to sort the particles
+	// w.r.t the camera's distance.
+	glm::vec3 CameraPosition(glm::inverse(ViewMatrix)[3]);
+	glm::mat4 ViewProjectionMatrix = ProjectionMatrix * ViewMatrix;
+	{
+		std::lock_guard<std::mutex> lock(snapshot_mutex);
+		camera = CameraPosition;
+	}
+
+	// Blend the last tick into this frame's segment of the streaming buffers, or have
+	// the GPU backend simulate, sort and gather its draw buffers (it draws the last
+	// tick as it is)
+	// http://www.opengl.org/wiki/Buffer_Object_Streaming
+	GLuint position_buffer = position_stream.buffer;
+	GLuint colour_buffer = colour_stream.buffer;
+	GLintptr position_offset = 0, colour_offset = 0;
+	GLsizei instances;
+	if (gpu)
+	{
+		gpu->emit_rate = emit_rate;
+		clock.advance(delta, [this, CameraPosition](double dt) { gpu->update(dt, CameraPosition); });
+		position_buffer = gpu->draw_position_buffer;
+		colour_buffer = gpu->draw_colour_buffer;
+		instances = gpu->capacity;		// Dead particles have size 0
+	}
+	else
+	{
+		if (!clock.threaded())
+			clock.advance(delta, [this, CameraPosition](double dt) { update(dt, CameraPosition); });
+
+		// Position at alpha between the two ticks = position - motion * (1 - alpha)
+		std::lock_guard<std::mutex> lock(snapshot_mutex);
+		GLfloat back_off = 1.0f - (GLfloat)clock.alpha();
+		if (position_stream.segment_size < GLsizeiptr(front.capacity * 4 * sizeof(GLfloat)))
+		{
+			// The pool has grown since the streams were made
+			position_stream.create(front.capacity * 4 * sizeof(GLfloat));
+			colour_stream.create(front.capacity * 4 * sizeof(GLubyte));
+			position_buffer = position_stream.buffer;
+			colour_buffer = colour_stream.buffer;
+		}
+		GLfloat* positions = (GLfloat*)position_stream.map();
+		const GLfloat* current = front.position_size.data();
+		const GLfloat* motion = front.motion.data();
+		for (GLuint n = 0; n < front.count; n++){
+			positions[4 * n + 0] = current[4 * n + 0] - motion[3 * n + 0] * back_off;
+			positions[4 * n + 1] = current[4 * n + 1] - motion[3 * n + 1] * back_off;
+			positions[4 * n + 2] = current[4 * n + 2] - motion[3 * n + 2] * back_off;
+			positions[4 * n + 3] = current[4 * n + 3];
+		}
+		memcpy(colour_stream.map(), front.colour.data(), front.count * 4);
+		position_stream.unmap();
+		colour_stream.unmap();
+
+		position_offset = position_stream.offset();
+		colour_offset = colour_stream.offset();
+		instances = front.count;
+	}
+
+	glBindVertexArray(VertexArrayID);
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// Use our shader
+	glUseProgram(programID);
+
+	// Bind our texture in Texture Unit 0
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, Texture);
+	// Set our "myTextureSampler" sampler to user Texture Unit 0
+	glUniform1i(TextureID, 0);
+
+	// Same as the billboards tutorial
+	glUniform3f(CameraRight_worldspace_ID, ViewMatrix[0][0], ViewMatrix[1][0], ViewMatrix[2][0]);
+	glUniform3f(CameraUp_worldspace_ID, ViewMatrix[0][1], ViewMatrix[1][1], ViewMatrix[2][1]);
+
+	glUniformMatrix4fv(ViewProjMatrixID, 1, GL_FALSE, &ViewProjectionMatrix[0][0]);
+
+	// 1rst attribute buffer : vertices
+	glEnableVertexAttribArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, billboard_vertex_buffer);
+	glVertexAttribPointer(
+		0,                  // attribute. No particular reason for 0, but must match the layout in the shader.
+		3,                  // size
+		GL_FLOAT,           // type
+		GL_FALSE,           // normalized?
+		0,                  // stride
+		(void*)0            // array buffer offset
+		);
+
+	// 2nd attribute buffer : positions of particles' centers
+	glEnableVertexAttribArray(1);
+	glBindBuffer(GL_ARRAY_BUFFER, position_buffer);
+	glVertexAttribPointer(
+		1,                                // attribute. No particular reason for 1, but must match the layout in the shader.
+		4,                                // size : x + y + z + size => 4
+		GL_FLOAT,                         // type
+		GL_FALSE,                         // normalized?
+		0,                                // stride
+		(void*)position_offset            // array buffer offset : this frame's segment
+		);
+
+	// 3rd attribute buffer : particles' colors
+	glEnableVertexAttribArray(2);
+	glBindBuffer(GL_ARRAY_BUFFER, colour_buffer);
+	glVertexAttribPointer(
+		2,                                // attribute. No particular reason for 1, but must match the layout in the shader.
+		4,                                // size : r + g + b + a => 4
+		GL_UNSIGNED_BYTE,                 // type
+		GL_TRUE,                          // normalized?    *** YES, this means that the unsigned char[4] will be accessible with a vec4 (floats) in the shader ***
+		0,                                // stride
+		(void*)colour_offset              // array buffer offset : this frame's segment
+		);
+
+	// These functions are specific to glDrawArrays*Instanced*.
+	// The first parameter is the attribute buffer we're talking about.
+	// The second parameter is the "rate at which generic vertex attributes advance when rendering multiple instances"
+	// http://www.opengl.org/sdk/docs/man/xhtml/glVertexAttribDivisor.xml
+	glVertexAttribDivisor(0, 0); // particles vertices : always reuse the same 4 vertices -> 0
+	glVertexAttribDivisor(1, 1); // positions : one per quad (its center)                 -> 1
+	glVertexAttribDivisor(2, 1); // color : one per quad                                  -> 1
+
+	// Draw the particules !
+	// This draws many times a small triangle_strip (which looks like a quad).
+	// This is equivalent to :
+	// for(i in ParticlesCount) : glDrawArrays(GL_TRIANGLE_STRIP, 0, 4), 
+	// but faster.
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, instances);
+
+	// The segments can be written again once this draw has finished
+	if (!gpu)
+	{
+		position_stream.fence();
+		colour_stream.fence();
+	}
+
+	glDisable(GL_BLEND);
+}
+
+
+void particle_object::defineUniforms()
+{
+	glBindVertexArray(VertexArrayID);
+	glUseProgram(programID);
+
+	CameraRight_worldspace_ID = glGetUniformLocation(programID, "CameraRight_worldspace");
+	CameraUp_worldspace_ID = glGetUniformLocation(programID, "CameraUp_worldspace");
+	ViewProjMatrixID = glGetUniformLocation(programID, "VP");
+
+	// fragment shader
+	TextureID = glGetUniformLocation(programID, "myTextureSampler");
+}
+
+
+
+/* Print particles simulated per millisecond for the scalar and SSE kernels, with the
+   original array of structs loop for comparison */
+void particle_store::benchmark()
+{
+	// The Particle struct this store replaced
+	struct particle_aos
+	{
+		glm::vec3 pos, speed;
+		unsigned char r, g, b, a;
+		float size, angle, weight;
+		float life;
+		float cameradistance;
+	};
+
+	const GLuint counts[] = { 10000, 100000, 1000000 };
+	const glm::vec3 camera(0, 0, 10.f);
+	const GLfloat delta = 1.f / 60.f;
+
+	printf("\nparticle_store simulate: particles/ms (%s)\n", PARTICLE_SIMD ? "SSE" : "no SIMD");
+	for (int c = 0; c < 3; c++)
+	{
+		GLuint n = counts[c];
+		GLuint steps = std::max(20000000u / n, 10u);
+
+		// Every particle alive for the whole run
+		particle_store store;
+		store.allocate(n);
+		std::vector<particle_aos> aos(n);
+		for (GLuint i = 0; i < n; i++)
+		{
+			store.life[i] = aos[i].life = 1000.f;
+			store.speed_x[i] = aos[i].speed.x = (rand() % 2000 - 1000.0f) / 1000.0f;
+			store.speed_y[i] = aos[i].speed.y = 10.f;
+			store.speed_z[i] = aos[i].speed.z = (rand() % 2000 - 1000.0f) / 1000.0f;
+			aos[i].pos = glm::vec3(0);
+		}
+
+		double t0 = secondsNow();
+		for (GLuint s = 0; s < steps; s++)
+		{
+			for (GLuint i = 0; i < n; i++)
+			{
+				particle_aos& p = aos[i];
+				if (p.life > 0.0f)
+				{
+					p.life -= delta;
+					if (p.life > 0.0f)
+					{
+						p.speed += glm::vec3(0.0f, -9.81f, 0.0f) * delta * 0.5f;
+						p.pos += p.speed * delta;
+						p.cameradistance = glm::length2(p.pos - camera);
+					}
+					else
+						p.cameradistance = -1.0f;
+				}
+			}
+		}
+		double t1 = secondsNow();
+		store.setSIMD(false);
+		for (GLuint s = 0; s < steps; s++) store.simulate(delta, camera);
+		double t2 = secondsNow();
+		store.setSIMD(true);
+		for (GLuint s = 0; s < steps; s++) store.simulate(delta, camera);
+		double t3 = secondsNow();
+
+		double updates = double(n) * steps;
+		printf("  %8u particles: array of structs %8.0f, SoA scalar %8.0f, SoA SIMD %8.0f\n", n,
+			updates / ((t1 - t0) * 1000.0), updates / ((t2 - t1) * 1000.0), updates / ((t3 - t2) * 1000.0));
+	}
+}
+
+
+/* Print the time SortParticles() takes per frame for 10k, 100k and 1M live particles:
+   the first frame (random order) and the following frames of a moving camera, against
+   std::sort over every slot as before */
+void particle_object::sortBenchmark()
+{
+	const GLuint counts[] = { 10000, 100000, 1000000 };
+	const GLuint frames = 30;
+	const float delta = 1.f / 60.f;
+
+	printf("\nparticle_object sort: ms per frame\n");
+	for (int c = 0; c < 3; c++)
+	{
+		GLuint n = counts[c];
+		particle_object system(n);
+		system.emit_rate = 0;
+
+		// A cloud of live particles drifting slowly
+		for (GLuint i = 0; i < n; i++)
+		{
+			system.allocateParticle();
+			system.particles.life[i] = 1000.f;
+			system.particles.pos_x[i] = (rand() % 2000 - 1000.0f) / 50.0f;
+			system.particles.pos_y[i] = (rand() % 2000 - 1000.0f) / 50.0f;
+			system.particles.pos_z[i] = (rand() % 2000 - 1000.0f) / 50.0f - 40.f;
+			system.particles.speed_x[i] = (rand() % 2000 - 1000.0f) / 1000.0f;
+			system.particles.speed_y[i] = 5.f + (rand() % 2000 - 1000.0f) / 1000.0f;
+			system.particles.speed_z[i] = (rand() % 2000 - 1000.0f) / 1000.0f;
+		}
+
+		system.update(delta, glm::vec3(0));
+		double first_ms = system.sort_ms;
+
+		double total_ms = 0;
+		GLuint incremental = 0, tried = 0;
+		for (GLuint f = 1; f <= frames; f++)
+		{
+			if (system.sort_skip == 0) tried++;
+			system.update(delta, glm::vec3(0.05f * f, 0, 0));
+			total_ms += system.sort_ms;
+			if (system.sort_incremental) incremental++;
+		}
+
+		// The previous approach: std::sort of every slot on the float distance
+		std::vector<GLuint> all(n);
+		for (GLuint i = 0; i < n; i++) all[i] = i;
+		const GLfloat* distance = system.particles.cameradistance;
+		double t0 = secondsNow();
+		std::sort(all.begin(), all.end(), [distance](GLuint a, GLuint b) { return distance[a] > distance[b]; });
+		double full_ms = (secondsNow() - t0) * 1000.0;
+
+		printf("  %8u live: first frame %7.2f, moving camera %7.2f (%u of %u frames incremental, %u tried), std::sort %7.2f\n",
+			n, first_ms, total_ms / frames, incremental, frames, tried, full_ms);
+	}
+}
+
+
+/* FNV-1a of the data drawParticles() would upload */
+static unsigned int snapshotHash(const particle_snapshot& snapshot)
+{
+	unsigned int hash = 2166136261u;
+	const GLubyte* bytes[] = { (const GLubyte*)snapshot.position_size.data(), snapshot.colour.data() };
+	size_t sizes[] = { snapshot.count * 4 * sizeof(GLfloat), (size_t)snapshot.count * 4 };
+	for (int b = 0; b < 2; b++)
+		for (size_t i = 0; i < sizes[b]; i++) hash = (hash ^ bytes[b][i]) * 16777619u;
+	return hash;
+}
+
+
+/* Print the time update() takes per frame for a full pool of 200k particles with 1 to N
+   job_system threads, and check every thread count produces the same GPU data */
+void particle_object::threadReport()
+{
+	const GLuint capacity = 200000;
+	const GLuint warmup = 60, frames = 60;
+	const double delta = 1.0 / 60.0;
+
+	GLuint max_threads = job_system::hardwareThreads();
+	std::vector<GLuint> thread_counts;
+	for (GLuint t = 1; t < max_threads; t *= 2) thread_counts.push_back(t);
+	thread_counts.push_back(max_threads);
+
+	printf("\nparticle_object update: %u particles, ms per frame (%u hardware threads)\n", capacity, max_threads);
+	double single_ms = 0;
+	unsigned int reference = 0;
+	for (size_t c = 0; c < thread_counts.size(); c++)
+	{
+		job_system pool(thread_counts[c]);
+		particle_object system(capacity);
+		system.setJobSystem(&pool);
+		system.setSeed(1);
+		system.emit_rate = 5000000.f;
+
+		for (GLuint f = 0; f < warmup; f++) system.update(delta, glm::vec3(0, 0, 10.f));
+		double t0 = secondsNow();
+		for (GLuint f = 0; f < frames; f++) system.update(delta, glm::vec3(0.1f * f, 0, 10.f));
+		double ms = (secondsNow() - t0) * 1000.0 / frames;
+
+		unsigned int hash = snapshotHash(system.front);
+
+		if (c == 0)
+		{
+			single_ms = ms;
+			reference = hash;
+		}
+		printf("  %2u threads: %7.2f ms, speedup %5.2f, %u live, %s\n", thread_counts[c], ms, single_ms / ms,
+			system.front.count, hash == reference ? "same result" : "RESULT DIFFERS");
+	}
+}
+
+
+/* Run the simulation thread at 60 Hz for half a second, then step two more systems
+   with the same seed to the same number of ticks from 144 Hz and 1000 Hz frame times
+   and check all three end with the same particles */
+void particle_object::timestepReport()
+{
+	const glm::vec3 camera(0, 0, 10.f);
+	const double frame_rates[] = { 144.0, 1000.0 };
+
+	particle_object threaded(20000);
+	threaded.setSeed(3);
+	threaded.camera = camera;
+	threaded.startSimulationThread();
+	double t0 = secondsNow();
+	while (secondsNow() - t0 < 0.5) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	threaded.stopSimulationThread();
+	unsigned long long ticks = threaded.clock.ticks;
+	unsigned int reference = snapshotHash(threaded.front);
+
+	printf("\nparticle_object fixed timestep: %.0f Hz ticks\n", 1.0 / threaded.clock.dt);
+	printf("  simulation thread: %llu ticks in %.2f s, %u live\n", ticks, secondsNow() - t0, threaded.front.count);
+	for (int r = 0; r < 2; r++)
+	{
+		particle_object stepped(20000);
+		stepped.setSeed(3);
+		GLuint frames = 0;
+		while (stepped.clock.ticks < ticks)
+		{
+			stepped.clock.advance(1.0 / frame_rates[r], [&stepped, camera](double dt) { stepped.update(dt, camera); });
+			frames++;
+		}
+		unsigned int hash = snapshotHash(stepped.front);
+		printf("  %4.0f Hz frames: %llu ticks in %u frames, %u live, %s\n", frame_rates[r],
+			(unsigned long long)stepped.clock.ticks, frames, stepped.front.count,
+			hash == reference ? "same result" : "RESULT DIFFERS");
+	}
+}
@@ -1,63 +1,160 @@
-/*
- particle_object.cpp
- Component from a basic example of a particle animation
- Adaped from the particle animation tutorial from:
- http://www.opengl-tutorial.org/intermediate-tutorials/billboards-particles/particles-instancing/
-
-  Iain Martin November 2014
-*/
-
-#pragma once
-
-#include "wrapper_glfw.h"
-#include <glm/glm.hpp>
-
-
-// CPU representation of a particle
-struct Particle{
-	glm::vec3 pos, speed;
-	unsigned char r, g, b, a; // Color
-	float size, angle, weight;
-	float life; // Remaining life of the particle. if < 0 : dead and unused.
-
-	float cameradistance; // *Squared* distance to the camera. if dead : -1.0f
-
-	bool operator<(const Particle& that) const {
-		// Sort in reverse order : far particles drawn first.
-		return this->cameradistance > that.cameradistance;
-	}
-
-};
-
-class particle_object
-{
-public:
-	particle_object();
-	~particle_object();
-
-	void create(GLuint program);
-	int FindUnusedParticle();
-	void SortParticles();
-	void drawParticles(glm::mat4 ProjectionMatrix, glm::mat4 ViewMatrix);
-	void defineUniforms();
-		
-	GLuint billboard_vertex_buffer;
-	GLuint particles_position_buffer;
-	GLuint particles_color_buffer;
-	const int MaxParticles = 10000;
-	Particle ParticlesContainer[10000];
-	int LastUsedParticle;
-	GLfloat* g_particule_position_size_data;
-	GLubyte* g_particule_color_data;
-	int ParticlesCount;
-	double lastTime;
-
-	GLuint VertexArrayID;
-	GLuint programID;
-	GLuint Texture;
-	GLuint TextureID;
-	GLuint CameraRight_worldspace_ID;
-	GLuint CameraUp_worldspace_ID;
-	GLuint ViewProjMatrixID;
-};
-
+/*
+ particle_object.cpp
+ Component from a basic example of a particle animation
+ Adaped from the particle animation tutorial from:
+ http://www.opengl-tutorial.org/intermediate-tutorials/billboards-particles/particles-instancing/
+
+  Iain Martin November 2014
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include "job_system.h"
+#include "stream_buffer.h"
+#include "fixed_timestep.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+
+
+/* CPU representation of the particles as a structure of arrays: one 32 byte aligned
+   stream per component, so the simulation only pulls the streams it updates through
+   the cache and can update several particles per instruction */
+class particle_store
+{
+public:
+	particle_store();
+	~particle_store();
+
+	void allocate(GLuint n);			// n dead particles
+	void grow(GLuint n);				// Add dead particles up to n, keeping the existing ones
+	void simulate(GLfloat delta, glm::vec3 camera, job_system* jobs = NULL);	// Gravity, life and camera distance
+	void setSIMD(bool enable);			// false = reference scalar path
+
+	static void benchmark();			// Print particles/ms at 10k, 100k and 1M particles
+
+	GLuint capacity;
+	bool use_simd;
+
+	GLfloat *pos_x, *pos_y, *pos_z;
+	GLfloat *speed_x, *speed_y, *speed_z;
+	GLfloat *size;
+	GLfloat *life;				// Remaining life of the particle. if <= 0 : dead and unused
+	GLfloat *cameradistance;	// *Squared* distance to the camera. if dead : -1.0f
+	GLubyte *colour;			// RGBA, 4 bytes per particle
+
+private:
+	void simulateRange(GLuint first, GLuint last, GLfloat delta, glm::vec3 camera);
+	GLubyte* block;				// One allocation holding all the streams
+};
+
+/* What particle_object does when a particle is emitted and every particle is alive */
+enum particle_overflow
+{
+	PARTICLE_OVERFLOW_DROP,				// Don't emit it
+	PARTICLE_OVERFLOW_RECYCLE_OLDEST,	// Reuse the particle that was emitted first
+	PARTICLE_OVERFLOW_GROW				// Double the capacity
+};
+
+/* Draw data of one tick, live particles back to front */
+struct particle_snapshot
+{
+	std::vector<GLfloat> position_size;	// xyz and size
+	std::vector<GLfloat> motion;		// xyz movement over the tick, to blend with the tick before
+	std::vector<GLubyte> colour;		// RGBA
+	GLuint count;
+	GLuint capacity;					// Pool size when it was taken, the streams need this much room
+
+	/* Allocation state when it was taken, for printSpawnStats() */
+	GLuint free_slots;
+	unsigned long long spawn_requests, spawn_failures, spawn_recycled;
+	GLuint spawn_grows;
+};
+
+class particle_gpu;
+
+class particle_object
+{
+public:
+	particle_object(GLuint capacity = 10000);
+	~particle_object();
+
+	void create(GLuint program);
+	void releaseBuffers();				// Delete the streaming buffers, before the GL context goes
+	void setCapacity(GLuint capacity);	// Removes all the particles
+	void setTickRate(double hz);		// Simulation ticks per second, 60 by default
+	void startSimulationThread();		// Tick on a thread of its own instead of in drawParticles()
+	void stopSimulationThread();
+	void setOverflowPolicy(particle_overflow policy);
+	void setJobSystem(job_system* pool);	// NULL = run on the calling thread
+	void setGPUBackend(particle_gpu* backend);	// NULL = simulate on the CPU, stops the simulation thread
+	void setSeed(GLuint seed);			// Emission is the same for the same seed and frame times
+	int allocateParticle();				// Slot for a new particle, -1 if it was dropped
+	void printSpawnStats();
+	void SortParticles();
+	void update(double delta, glm::vec3 CameraPosition);	// One tick: emit, simulate, sort and publish the draw data
+	void drawParticles(glm::mat4 ProjectionMatrix, glm::mat4 ViewMatrix);	// Runs the ticks due, draws the last two blended
+	void defineUniforms();
+
+	static void sortBenchmark();		// Print the sort time per frame for 10k to 1M live particles
+	static void threadReport();			// Print update() time with 1 to N threads and check the results match
+	static void timestepReport();		// Check 144 Hz, 1000 Hz and threaded clocks give the same particles
+		
+	GLuint billboard_vertex_buffer;
+	stream_buffer position_stream;		// Position and size of each live particle, back to front
+	stream_buffer colour_stream;		// RGBA of each live particle
+	int MaxParticles;
+	GLfloat emit_rate;					// New particles per second
+	particle_store particles;
+	std::vector<GLuint> draw_order;		// Live particles, furthest from the camera first
+	job_system* jobs;					// Simulate, cull and buffer fill are split across its threads
+	particle_gpu* gpu;					// Draws this backend's particles instead when set
+	GLuint seed;
+	fixed_timestep clock;
+	double emit_carry;					// Fraction of a particle left over from the last tick
+
+	/* Allocation: dead slots are kept on a free list, live slots in emission order
+	   (with the serial they were emitted with, entries of dead particles are skipped) */
+	std::atomic<particle_overflow> overflow_policy;	// Set from the key callback while the thread spawns
+	std::vector<GLuint> free_slots;
+	std::vector<GLuint> slot_serial;
+	std::deque<std::pair<GLuint, GLuint> > emission_order;
+	GLuint next_serial;
+
+	/* Spawn counters since setCapacity() */
+	unsigned long long spawn_requests;
+	unsigned long long spawn_failures;	// Dropped because every particle was alive
+	unsigned long long spawn_recycled;	// Replaced the oldest live particle
+	GLuint spawn_grows;					// Capacity doublings
+
+	/* Sort state and statistics, see SortParticles() */
+	std::vector<unsigned long long> sort_items, sort_temp;	// Quantized distance << 32 | particle
+	GLuint sort_new;					// Particles at the end of draw_order emitted this frame
+	double sort_ms;						// Time taken by the last SortParticles()
+	bool sort_incremental;				// The last sort kept the previous order instead of radix sorting
+	GLuint sort_skip;					// Sorts left that radix sort without trying the insertion sort
+	GLuint sort_backoff;				// Skip after the next failure, doubles while the insertion sort fails
+	std::vector<GLuint> cull_kept, cull_new_dead, cull_scratch;	// Scratch for the cull in update()
+
+	/* update() fills back and swaps it with front under snapshot_mutex, drawParticles()
+	   blends front into the streams, so the simulation can run on another thread */
+	particle_snapshot front, back;
+	std::mutex snapshot_mutex;
+	glm::vec3 camera;					// Camera the simulation thread sorts for, set by drawParticles()
+	double lastTime;
+
+	GLuint VertexArrayID;
+	GLuint programID;
+	GLuint Texture;
+	GLuint TextureID;
+	GLuint CameraRight_worldspace_ID;
+	GLuint CameraUp_worldspace_ID;
+	GLuint ViewProjMatrixID;
+
+private:
+	void tick(double dt);				// update() with the camera drawParticles() last saw
+};
+
@@ -0,0 +1,15 @@
+/* perf_stats.h
+   Helpers used by the classes in common/ when they print performance reports:
+   process memory usage and a wall clock timer.
+*/
+
+#pragma once
+
+#include <stddef.h>
+
+/* Peak and current resident set size (working set on Windows) of this process in bytes */
+size_t peakResidentBytes();
+size_t currentResidentBytes();
+
+/* Wall clock time in seconds from an arbitrary starting point */
+double secondsNow();
@@ -1,117 +1,357 @@
-/**  Point class to use in an example particle animation of an upward particle
-with an element of random movement and gravity.
-Iain Martin
-November 2018
-*/
-#include "points2.h"
-#include "glm/gtc/random.hpp"
-
-using namespace glm;
-
-/* Constructor, set initial parameters*/
-points2::points2(GLuint number, GLfloat dist, GLfloat sp)
-{
-	numpoints = number;
-	maxdist = dist;
-	speed = sp;
-}
-
-
-points2::~points2()
-{
-	delete [] colours;
-	delete[] vertices;
-}
-
-void points2::updateParams(GLfloat dist, GLfloat sp)
-{
-	maxdist = dist;
-	speed = sp;
-}
-
-
-void  points2::create()
-{
-	vertices = new vec3[numpoints];
-	colours = new vec3[numpoints];
-	velocity = new vec3[numpoints];
-
-	/* Define random colour and vertical velocity + small random variation */
-	for (int i = 0; i < numpoints; i++)
-	{
-		// create the particle at the initial position
-		initpoint(i);
-	}
-
-	/* Create the vertex buffer object */
-	/* and the vertex buffer positions */
-	glGenBuffers(1, &vertex_buffer);
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-	glBufferData(GL_ARRAY_BUFFER, numpoints * sizeof(vec3), vertices, GL_DYNAMIC_DRAW);
-
-	glGenBuffers(1, &colour_buffer);
-	glBindBuffer(GL_ARRAY_BUFFER, colour_buffer);
-	glBufferData(GL_ARRAY_BUFFER, numpoints * sizeof(vec3), colours, GL_STATIC_DRAW);
-}
-
-
-void points2::draw()
-{
-	/* Bind  vertices. Note that this is in attribute index 0 */
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-	/* Bind cube colours. Note that this is in attribute index 1 */
-	glBindBuffer(GL_ARRAY_BUFFER, colour_buffer);
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-
-	/* Draw our points*/
-	glDrawArrays(GL_POINTS, 0, numpoints);
-}
-
-
-void points2::animate()
-{
-	for (int i = 0; i < numpoints; i++)
-	{
-		// Shift vertex position by velocity vector
-		vertices[i] += velocity[i];
-
-		// Add a small random value to the velocity
-		velocity[i] += vec3(ballRand(linearRand(0.f, speed/40.f)));
-
-		// Calculate distance to the origin
-		GLfloat dist = length(vertices[i]);
-
-		// If we are too far away then kill the particle by starting at the origin again
-		if (dist > (maxdist - linearRand(0.f, 0.5f)))
-		{
-			// restart thee particle at the initial position
-			initpoint(i);
-		}
-		else
-		{
-			//add random direction for a firefly effect
-			velocity[i].y += linearRand(-0.001f, 0.001f);
-			velocity[i].x += linearRand(-0.001f, 0.001f);
-			velocity[i].z += linearRand(-0.001f, 0.001f);
-		}
-	}
-
-	// Update the vertex buffer data
-	glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
-	glBufferData(GL_ARRAY_BUFFER, numpoints * sizeof(vec3), vertices, GL_DYNAMIC_DRAW);
-}
-
-
-// Set the initial particle conditions
-void points2::initpoint(int i)
-{
-	vertices[i] = vec3(0);// vec3((linearRand(0.f, speed*4.f), linearRand(0.f, speed * 2), linearRand(0.f, speed*4.f)));
-	colours[i] = vec3(linearRand(0.2f, 0.3f), linearRand(0.4f, 0.5f), linearRand(0.8f, 1.0f));
-	//velocity[i] = vec3(0, 0.05, 0) + vec3(ballRand(linearRand(0.f, speed)));
-	velocity[i] = vec3(0, 0.0005, 0) + vec3(ballRand(linearRand(0.f, speed)));
-	velocity[i] = normalize(velocity[i]) / 500.f;
-}
\ No newline at end of file
+/**  Point class to use in an example particle animation of an upward particle
+with an element of random movement and gravity.
+Iain Martin
+November 2018
+*/
+#include "points2.h"
+#include "perf_stats.h"
+#include "hash_random.h"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+
+using namespace glm;
+
+/* Points per job_system chunk */
+const GLuint POINTS_JOB_GRAIN = 4096;
+
+/* Tick rate the speeds were tuned for: a tick of dt moves the points as far as
+   dt * 60 of the original frames, so at the default 60 Hz a tick is one frame */
+const GLfloat POINTS_REFERENCE_RATE = 60.f;
+
+/* Random channels used per tick: 48 for the velocity jitter (16 tries of 3), then one
+   for the kill distance and three for the firefly jitter */
+const GLuint POINTS_CHANNELS = 64;
+
+/* Constructor, set initial parameters*/
+points2::points2(GLuint number, GLfloat dist, GLfloat sp)
+{
+	numpoints = number;
+	maxdist = dist;
+	speed = sp;
+	vertices = NULL;
+	colours = NULL;
+	velocity = NULL;
+	jobs = &job_system::shared();
+	seed = 0;
+	frame = 0;
+	lastTime = 0;
+}
+
+
+points2::~points2()
+{
+	clock.stop();
+	delete [] colours;
+	delete[] vertices;
+	delete[] velocity;
+}
+
+
+void points2::setJobSystem(job_system* pool)
+{
+	jobs = pool;
+}
+
+
+void points2::setSeed(GLuint seed)
+{
+	this->seed = seed;
+}
+
+
+/* Random numbers are a hash of the seed, the tick, the point and the channel, so
+   points can be updated on any thread in any order and still animate the same.
+   Even indices are used by tick(), odd ones by initpoint() */
+GLfloat points2::random(GLuint i, GLuint channel)
+{
+	return hashRandom(seed, i, frame * POINTS_CHANNELS + channel);
+}
+
+
+/* Point in a ball of the given radius, by rejection like glm::ballRand. Uses up to 48
+   channels from channel, gives the centre in the unlikely case every try misses */
+static vec3 ballRandom(GLuint seed, GLuint i, GLuint channel, GLfloat radius)
+{
+	for (GLuint t = 0; t < 16; t++)
+	{
+		vec3 p(hashRandom(seed, i, channel + 3 * t) * 2.f - 1.f,
+			hashRandom(seed, i, channel + 3 * t + 1) * 2.f - 1.f,
+			hashRandom(seed, i, channel + 3 * t + 2) * 2.f - 1.f);
+		if (dot(p, p) <= 1.f) return p * radius;
+	}
+	return vec3(0);
+}
+
+
+void points2::allocate()
+{
+	delete[] vertices;
+	delete[] colours;
+	delete[] velocity;
+	vertices = new vec3[numpoints];
+	colours = new vec3[numpoints];
+	velocity = new vec3[numpoints];
+	frame = 0;
+
+	/* Define random colour and vertical velocity + small random variation */
+	for (GLuint i = 0; i < numpoints; i++)
+	{
+		// create the particle at the initial position
+		initpoint(i);
+	}
+	front.position.assign(vertices, vertices + numpoints);
+	front.motion.assign(numpoints, vec3(0));
+	back = front;
+}
+
+void points2::updateParams(GLfloat dist, GLfloat sp)
+{
+	maxdist = dist;
+	speed = sp;
+}
+
+
+void  points2::create()
+{
+	allocate();
+
+	/* Create the streaming vertex buffer and write the starting positions to its
+	   first segment */
+	vertex_stream.create(numpoints * sizeof(vec3));
+	memcpy(vertex_stream.map(), vertices, numpoints * sizeof(vec3));
+	vertex_stream.unmap();
+
+	glGenBuffers(1, &colour_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, colour_buffer);
+	glBufferData(GL_ARRAY_BUFFER, numpoints * sizeof(vec3), colours, GL_STATIC_DRAW);
+
+	lastTime = glfwGetTime();
+}
+
+
+/* The ring buffer has GL fences and a mapping, so it goes while the context is still
+   current rather than in the destructor */
+void points2::releaseBuffers()
+{
+	vertex_stream.destroy();
+}
+
+
+void points2::draw()
+{
+	/* Bind  vertices. Note that this is in attribute index 0 */
+	glBindBuffer(GL_ARRAY_BUFFER, vertex_stream.buffer);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)vertex_stream.offset());
+
+	/* Bind cube colours. Note that this is in attribute index 1 */
+	glBindBuffer(GL_ARRAY_BUFFER, colour_buffer);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
+
+	/* Draw our points*/
+	glDrawArrays(GL_POINTS, 0, numpoints);
+
+	/* The segment can be written again once this draw has finished */
+	vertex_stream.fence();
+}
+
+
+void points2::animate()
+{
+	double now = glfwGetTime();
+	double frame_time = now - lastTime;
+	lastTime = now;
+	if (!clock.threaded())
+		clock.advance(frame_time, [this](double dt) { tick(dt); });
+	if (!vertex_stream.buffer) return;
+
+	// Position at alpha between the two ticks = position - motion * (1 - alpha)
+	std::lock_guard<std::mutex> lock(snapshot_mutex);
+	GLfloat back_off = 1.0f - (GLfloat)clock.alpha();
+	vec3* out = (vec3*)vertex_stream.map();
+	for (GLuint i = 0; i < numpoints; i++)
+		out[i] = front.position[i] - front.motion[i] * back_off;
+	vertex_stream.unmap();
+}
+
+
+/* Restarts the simulation thread if it is running */
+void points2::setTickRate(double hz)
+{
+	bool threaded = clock.threaded();
+	clock.stop();
+	clock.setTickRate(hz);
+	if (threaded) startSimulationThread();
+}
+
+
+void points2::startSimulationThread()
+{
+	clock.start([this](double dt) { tick(dt); });
+}
+
+
+void points2::stopSimulationThread()
+{
+	clock.stop();
+}
+
+
+/* Points only touch their own vertex, colour and velocity, so ranges of points are
+   moved on the job system threads. Each writes its points to the back snapshot as
+   it goes, then the snapshot is swapped in for animate() */
+void points2::tick(double dt)
+{
+	GLfloat step = (GLfloat)dt * POINTS_REFERENCE_RATE;
+	if (jobs)
+		jobs->parallelFor(numpoints, POINTS_JOB_GRAIN, [this, step](GLuint first, GLuint last)
+		{
+			updateRange(first, last, step);
+		});
+	else
+		updateRange(0, numpoints, step);
+	frame++;
+
+	std::lock_guard<std::mutex> lock(snapshot_mutex);
+	std::swap(front, back);
+}
+
+
+void points2::updateRange(GLuint first, GLuint last, GLfloat step)
+{
+	GLfloat jitter = speed / 40.f;
+	GLfloat limit = maxdist;
+	for (GLuint i = first; i < last; i++)
+	{
+		// Shift vertex position by velocity vector
+		vec3 moved = velocity[i] * step;
+		vertices[i] += moved;
+
+		// Add a small random value to the velocity
+		GLuint channel = frame * POINTS_CHANNELS;
+		velocity[i] += ballRandom(seed, i * 2, channel, random(i * 2, 48) * jitter) * step;
+
+		// Calculate distance to the origin
+		GLfloat dist = length(vertices[i]);
+
+		// If we are too far away then kill the particle by starting at the origin again
+		if (dist > (limit - random(i * 2, 49) * 0.5f))
+		{
+			// restart thee particle at the initial position, without blending from the old one
+			initpoint(i);
+			moved = vec3(0);
+		}
+		else
+		{
+			//add random direction for a firefly effect
+			velocity[i].y += (random(i * 2, 50) * 0.002f - 0.001f) * step;
+			velocity[i].x += (random(i * 2, 51) * 0.002f - 0.001f) * step;
+			velocity[i].z += (random(i * 2, 52) * 0.002f - 0.001f) * step;
+		}
+
+		back.position[i] = vertices[i];
+		back.motion[i] = moved;
+	}
+}
+
+
+// Set the initial particle conditions
+void points2::initpoint(int i)
+{
+	vertices[i] = vec3(0);// vec3((linearRand(0.f, speed*4.f), linearRand(0.f, speed * 2), linearRand(0.f, speed*4.f)));
+	GLuint r = i * 2 + 1;
+	colours[i] = vec3(0.2f + 0.1f * random(r, 48), 0.4f + 0.1f * random(r, 49), 0.8f + 0.2f * random(r, 50));
+	//velocity[i] = vec3(0, 0.05, 0) + vec3(ballRand(linearRand(0.f, speed)));
+	velocity[i] = vec3(0, 0.0005, 0) + ballRandom(seed, r, frame * POINTS_CHANNELS, random(r, 51) * speed);
+	velocity[i] = normalize(velocity[i]) / 500.f;
+}
+
+
+/* FNV-1a of the positions */
+static unsigned int pointsHash(const points2& points)
+{
+	unsigned int hash = 2166136261u;
+	const GLubyte* bytes = (const GLubyte*)points.vertices;
+	for (size_t i = 0; i < points.numpoints * sizeof(vec3); i++) hash = (hash ^ bytes[i]) * 16777619u;
+	return hash;
+}
+
+
+/* Print the time tick() takes for 1M points with 1 to N job_system threads, and
+   check every thread count gives the same points */
+void points2::threadReport()
+{
+	const GLuint n = 1000000;
+	const GLuint frames = 30;
+
+	GLuint max_threads = job_system::hardwareThreads();
+	std::vector<GLuint> thread_counts;
+	for (GLuint t = 1; t < max_threads; t *= 2) thread_counts.push_back(t);
+	thread_counts.push_back(max_threads);
+
+	printf("\npoints2 tick: %u points, ms per tick (%u hardware threads)\n", n, max_threads);
+	double single_ms = 0;
+	unsigned int reference = 0;
+	for (size_t c = 0; c < thread_counts.size(); c++)
+	{
+		job_system pool(thread_counts[c]);
+		points2 points(n, 1.5f, 0.02f);
+		points.setJobSystem(&pool);
+		points.setSeed(1);
+		points.allocate();
+
+		double t0 = secondsNow();
+		for (GLuint f = 0; f < frames; f++) points.tick(1.0 / 60.0);
+		double ms = (secondsNow() - t0) * 1000.0 / frames;
+
+		unsigned int hash = pointsHash(points);
+
+		if (c == 0)
+		{
+			single_ms = ms;
+			reference = hash;
+		}
+		printf("  %2u threads: %7.2f ms, speedup %5.2f, %s\n", thread_counts[c], ms, single_ms / ms,
+			hash == reference ? "same result" : "RESULT DIFFERS");
+	}
+}
+
+
+/* Run the simulation thread at 60 Hz for half a second, then step two more sets of
+   points with the same seed to the same number of ticks from 144 Hz and 1000 Hz frame
+   times and check all three end in the same place */
+void points2::timestepReport()
+{
+	const GLuint n = 100000;
+	const double frame_rates[] = { 144.0, 1000.0 };
+
+	points2 threaded(n, 1.5f, 0.02f);
+	threaded.setSeed(2);
+	threaded.allocate();
+	threaded.startSimulationThread();
+	double t0 = secondsNow();
+	while (secondsNow() - t0 < 0.5) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	threaded.stopSimulationThread();
+	unsigned long long ticks = threaded.clock.ticks;
+	unsigned int reference = pointsHash(threaded);
+
+	printf("\npoints2 fixed timestep: %u points, %.0f Hz ticks\n", n, 1.0 / threaded.clock.dt);
+	printf("  simulation thread: %llu ticks in %.2f s\n", ticks, secondsNow() - t0);
+	for (int r = 0; r < 2; r++)
+	{
+		points2 stepped(n, 1.5f, 0.02f);
+		stepped.setSeed(2);
+		stepped.allocate();
+		GLuint frames = 0;
+		while (stepped.clock.ticks < ticks)
+		{
+			stepped.clock.advance(1.0 / frame_rates[r], [&stepped](double dt) { stepped.tick(dt); });
+			frames++;
+		}
+		printf("  %4.0f Hz frames: %llu ticks in %u frames, %s\n", frame_rates[r],
+			(unsigned long long)stepped.clock.ticks, frames,
+			pointsHash(stepped) == reference ? "same result" : "RESULT DIFFERS");
+	}
+}
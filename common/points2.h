@@ -1,37 +1,78 @@
-/**  Point class to use in an example particle animation of an upward particle
-with an element of random movement and gravity.
-Iain Martin
-October 2016
-*/
-#pragma once
-
-#include <glm/glm.hpp>
-#include "wrapper_glfw.h"
-
-class points2
-{
-public:
-	points2(GLuint number, GLfloat dist, GLfloat sp);
-	~points2();
-
-	void create();
-	void draw();
-	void animate();
-	void updateParams(GLfloat dist, GLfloat sp);
-	void initpoint(int i);
-
-	glm::vec3 *vertices;
-	glm::vec3 *colours;
-	glm::vec3 *velocity;
-
-	GLuint numpoints;		// Number of particles
-	GLuint vertex_buffer;
-	GLuint colour_buffer;
-
-	// Particle speed
-	GLfloat speed;		
-
-	// Particle max distance fomr the origin before we change direction back to the centre
-	GLfloat maxdist;	
-};
-
+/**  Point class to use in an example particle animation of an upward particle
+with an element of random movement and gravity.
+Iain Martin
+October 2016
+*/
+#pragma once
+
+#include <glm/glm.hpp>
+#include "wrapper_glfw.h"
+#include "job_system.h"
+#include "stream_buffer.h"
+#include "fixed_timestep.h"
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+/* Positions after a tick and the movement over it, to blend with the tick before */
+struct points_snapshot
+{
+	std::vector<glm::vec3> position;
+	std::vector<glm::vec3> motion;
+};
+
+class points2
+{
+public:
+	points2(GLuint number, GLfloat dist, GLfloat sp);
+	~points2();
+
+	void create();
+	void releaseBuffers();				// Delete the streaming buffer, before the GL context goes
+	void draw();
+	void animate();						// Run the ticks due unless the simulation thread runs them, and
+										// write positions between the last two ticks to the vertex stream
+	void tick(double dt);				// Move the points dt seconds, split across the job system threads
+	void setTickRate(double hz);		// Simulation ticks per second, 60 by default
+	void startSimulationThread();		// Tick on a thread of its own instead of in animate()
+	void stopSimulationThread();
+	void updateParams(GLfloat dist, GLfloat sp);
+	void initpoint(int i);
+	void setJobSystem(job_system* pool);	// NULL = run on the calling thread
+	void setSeed(GLuint seed);			// The same seed gives the same animation
+
+	static void threadReport();			// Print tick() time with 1 to N threads and check the results match
+	static void timestepReport();		// Check 144 Hz, 1000 Hz and threaded clocks give the same points
+
+	glm::vec3 *vertices;
+	glm::vec3 *colours;
+	glm::vec3 *velocity;
+
+	GLuint numpoints;		// Number of particles
+	stream_buffer vertex_stream;
+	GLuint colour_buffer;
+
+	// Particle speed, atomic as updateParams() runs while the simulation thread ticks
+	std::atomic<GLfloat> speed;
+
+	// Particle max distance fomr the origin before we change direction back to the centre
+	std::atomic<GLfloat> maxdist;
+
+	job_system* jobs;
+	GLuint seed;
+	GLuint frame;		// Ticks simulated, part of the random number index
+
+	fixed_timestep clock;
+	double lastTime;
+
+	/* tick() writes back and swaps it with front under snapshot_mutex, animate() blends
+	   front into the vertex stream */
+	points_snapshot front, back;
+	std::mutex snapshot_mutex;
+
+private:
+	void allocate();
+	void updateRange(GLuint first, GLuint last, GLfloat step);
+	GLfloat random(GLuint i, GLuint channel);
+};
+
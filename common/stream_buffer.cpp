@@ -0,0 +1,149 @@
+/* stream_buffer.cpp
+   Triple buffered streaming vertex buffer, see stream_buffer.h
+*/
+
+#include "stream_buffer.h"
+#include "perf_stats.h"
+
+stream_buffer::stream_buffer()
+{
+	buffer = 0;
+	segment_size = 0;
+	num_segments = 0;
+	current = 0;
+	persistent = false;
+	allow_persistent = true;
+	mapped = NULL;
+	frames = waits = 0;
+	wait_ms = 0;
+}
+
+
+/* The GL objects are left to destroy(): a global buffer is destructed after the
+   context has gone */
+stream_buffer::~stream_buffer()
+{
+}
+
+
+/* GL_ARB_buffer_storage is core in GL 4.4, the wrapper asks for less so check the
+   extension and that the loader found the function */
+bool stream_buffer::persistentSupported()
+{
+	return glext_ARB_buffer_storage && glBufferStorage != NULL;
+}
+
+
+void stream_buffer::setPersistent(bool enable)
+{
+	allow_persistent = enable;
+}
+
+
+/* Create the buffer holding segments * segment_size bytes. Any existing buffer is
+   deleted, the GL keeps it alive until draws already submitted from it are done */
+void stream_buffer::create(GLsizeiptr segment_size, GLuint segments)
+{
+	destroy();
+	this->segment_size = segment_size;
+	num_segments = segments;
+	current = segments - 1;			// So the first map() returns segment 0
+	fences.assign(segments, (GLsync)0);
+	persistent = allow_persistent && persistentSupported();
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	GLsizeiptr size = segment_size * segments;
+	if (persistent)
+	{
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+		mapped = (GLubyte*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+		if (!mapped)
+		{
+			// Shouldn't happen with the extension, but a NULL mapping can't be used
+			glDeleteBuffers(1, &buffer);
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			persistent = false;
+		}
+	}
+	if (!persistent)
+		glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+void stream_buffer::destroy()
+{
+	if (!buffer) return;
+	for (size_t s = 0; s < fences.size(); s++)
+		if (fences[s]) glDeleteSync(fences[s]);
+	fences.clear();
+
+	if (mapped)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glUnmapBuffer(GL_ARRAY_BUFFER);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		mapped = NULL;
+	}
+	glDeleteBuffers(1, &buffer);
+	buffer = 0;
+}
+
+
+/* Move to the next segment and return a pointer to write it. If the GPU hasn't
+   finished the draws that read this segment three frames ago, wait for them */
+void* stream_buffer::map()
+{
+	current = (current + 1) % num_segments;
+	frames++;
+
+	GLsync& f = fences[current];
+	if (f)
+	{
+		if (glClientWaitSync(f, 0, 0) == GL_TIMEOUT_EXPIRED)
+		{
+			double t0 = secondsNow();
+			waits++;
+			while (glClientWaitSync(f, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000) == GL_TIMEOUT_EXPIRED);
+			wait_ms += (secondsNow() - t0) * 1000.0;
+		}
+		glDeleteSync(f);
+		f = 0;
+	}
+
+	if (persistent) return mapped + offset();
+
+	// The fence already guarantees the GPU is done with the segment
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	mapped = (GLubyte*)glMapBufferRange(GL_ARRAY_BUFFER, offset(), segment_size,
+		GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return mapped;
+}
+
+
+/* Coherent persistent mappings need nothing, the segment mapping is released */
+void stream_buffer::unmap()
+{
+	if (persistent || !mapped) return;
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glUnmapBuffer(GL_ARRAY_BUFFER);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	mapped = NULL;
+}
+
+
+void stream_buffer::fence()
+{
+	if (fences[current]) glDeleteSync(fences[current]);
+	fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+
+GLintptr stream_buffer::offset()
+{
+	return GLintptr(current) * segment_size;
+}
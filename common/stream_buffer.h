@@ -0,0 +1,52 @@
+/* stream_buffer.h
+   Vertex buffer for data that is rewritten every frame. The buffer is a ring of
+   segments (three by default): the CPU writes one segment while the GPU may still be
+   drawing from the others, and a fence placed after the draws that read a segment
+   stops the CPU writing to it again too early.
+   With GL_ARB_buffer_storage the whole buffer is mapped once, persistent and coherent,
+   so map() just returns a pointer into it. Without the extension each segment is
+   mapped unsynchronized with glMapBufferRange and unmapped again in unmap(), behind
+   the same fences.
+   Usage per frame: map(), write up to segment_size bytes, unmap(), draw with the
+   attribute offsets starting at offset(), then fence().
+   Call destroy() while the context is current, the destructor makes no GL calls.
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include <vector>
+
+class stream_buffer
+{
+public:
+	stream_buffer();
+	~stream_buffer();
+
+	void create(GLsizeiptr segment_size, GLuint segments = 3);	// Needs a GL context
+	void destroy();						// Needs the GL context create() used
+	void setPersistent(bool enable);	// false = always use the glMapBufferRange path
+
+	void* map();						// Next segment, waits until the GPU has finished with it
+	void unmap();
+	void fence();						// After the draw calls that read the current segment
+	GLintptr offset();					// Byte offset of the current segment in the buffer
+
+	static bool persistentSupported();
+
+	GLuint buffer;
+	GLsizeiptr segment_size;
+	GLuint num_segments;
+	GLuint current;						// Segment written by the last map()
+	bool persistent;					// The buffer is persistently mapped
+
+	/* Statistics */
+	GLuint frames;
+	GLuint waits;						// Frames where map() had to wait for the GPU
+	double wait_ms;
+
+private:
+	std::vector<GLsync> fences;			// One per segment, 0 if the segment is free
+	GLubyte* mapped;					// Whole buffer when persistent, else the mapped segment
+	bool allow_persistent;
+};
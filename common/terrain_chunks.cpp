@@ -0,0 +1,452 @@
+/* terrain_chunks.cpp
+   Streaming, tiled terrain generated on background threads.
+
+   Tile (tx, tz) covers world x in [tx, tx + 1] * tile_size and z in [tz, tz + 1] * tile_size.
+   Vertex (r, c) of a tile is the global grid sample (tx * (n - 1) + r, tz * (n - 1) + c)
+   so the last row/column of one tile is the first row/column of its neighbour.
+   The vertex layout matches terrain_object: r runs along x and c runs along z.
+*/
+
+#include "terrain_chunks.h"
+#include "noise_engine.h"
+#include "perf_stats.h"
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <stdio.h>
+
+using namespace std;
+using namespace glm;
+
+terrain_chunks::terrain_chunks(GLuint vertices, GLfloat size, int octaves, GLfloat freq, GLfloat scale)
+{
+	tile_vertices = vertices;
+	tile_size = size;
+	height_scale = size;
+	view_radius = 3;
+	tile_budget = 64;
+
+	attribute_v_coord = 0;
+	attribute_v_colour = 1;
+	attribute_v_normal = 2;
+
+	tiles_evicted = 0;
+	tiles_cancelled = 0;
+
+	num_threads = 0;
+	busy_workers = 0;
+	stopping = false;
+	upload_enabled = true;
+
+	perlin_octaves = octaves;
+	perlin_freq = freq;
+	perlin_scale = scale;
+
+	ibo_tile_elements = 0;
+	num_tile_elements = 0;
+}
+
+
+terrain_chunks::~terrain_chunks()
+{
+	stopWorkers();
+
+	for (map<tile_key, terrain_tile*>::iterator it = tiles.begin(); it != tiles.end(); ++it)
+	{
+		if (it->second->vbo) glDeleteBuffers(1, &it->second->vbo);
+		delete it->second;
+	}
+	if (ibo_tile_elements) glDeleteBuffers(1, &ibo_tile_elements);
+}
+
+
+void terrain_chunks::setViewRadius(GLuint radius)
+{
+	view_radius = radius;
+}
+
+
+void terrain_chunks::setTileBudget(GLuint max_tiles)
+{
+	tile_budget = max_tiles;
+}
+
+
+void terrain_chunks::setThreads(GLuint n)
+{
+	num_threads = n;
+}
+
+
+void terrain_chunks::setUploadEnabled(bool enable)
+{
+	upload_enabled = enable;
+}
+
+
+void terrain_chunks::startWorkers()
+{
+	GLuint n = num_threads;
+	if (n == 0)
+	{
+		// Leave one hardware thread for the render loop
+		n = thread::hardware_concurrency();
+		n = (n > 1) ? n - 1 : 1;
+	}
+
+	stopping = false;
+	for (GLuint i = 0; i < n; i++)
+		workers.push_back(thread(&terrain_chunks::workerLoop, this));
+}
+
+
+void terrain_chunks::stopWorkers()
+{
+	{
+		lock_guard<mutex> lock(queue_mutex);
+		stopping = true;
+	}
+	queue_cv.notify_all();
+	for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+	workers.clear();
+}
+
+
+/* Take tiles off the job queue and generate them until we are stopped */
+void terrain_chunks::workerLoop()
+{
+	// The worker threads already run in parallel so each noise engine uses one thread
+	noise_engine engine(perlin_octaves, perlin_freq, perlin_scale);
+	engine.setThreads(1);
+
+	while (true)
+	{
+		terrain_tile* tile;
+		{
+			unique_lock<mutex> lock(queue_mutex);
+			queue_cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (stopping) return;
+			tile = jobs.front();
+			jobs.pop_front();
+			busy_workers++;
+		}
+
+		double t0 = secondsNow();
+		generateTile(tile, engine);
+		tile->generate_time = secondsNow() - t0;
+
+		{
+			lock_guard<mutex> lock(queue_mutex);
+			finished.push_back(tile);
+			busy_workers--;
+		}
+		queue_cv.notify_all();
+	}
+}
+
+
+/* Generate the interleaved vertices of one tile.
+   The noise is sampled with a one sample apron so the central difference normals
+   on the tile border use the same neighbours as the adjacent tile does */
+void terrain_chunks::generateTile(terrain_tile* tile, noise_engine& engine)
+{
+	GLuint n = tile_vertices;
+	GLuint m = n + 2;
+	GLint row0 = tile->tx * GLint(n - 1) - 1;
+	GLint col0 = tile->tz * GLint(n - 1) - 1;
+	GLfloat noise_step = 1.f / GLfloat(n - 1);	// One tile spans one noise unit at frequency 1
+	GLfloat spacing = tile_size / GLfloat(n - 1);
+
+	vector<GLfloat> h(m * m);
+	engine.generate(&h[0], m, m, col0, row0, noise_step, noise_step);
+
+	tile->data.resize(n * n * 3);
+	for (GLuint r = 0; r < n; r++)
+	{
+		for (GLuint c = 0; c < n; c++)
+		{
+			GLuint centre = (r + 1) * m + (c + 1);
+			GLfloat hc = h[centre];
+
+			// Central differences along x (rows) and z (columns)
+			GLfloat dx = (h[centre - m] - h[centre + m]) * height_scale;
+			GLfloat dz = (h[centre - 1] - h[centre + 1]) * height_scale;
+
+			vec3 position(spacing * GLfloat(row0 + 1 + (GLint)r), (hc - 0.5f) * height_scale, spacing * GLfloat(col0 + 1 + (GLint)c));
+			vec3 normal = normalize(vec3(dx, 2.f * spacing, dz));
+
+			// Colour based on height, same bands as terrain_object::setColourBasedOnHeight
+			vec3 colour;
+			if (hc <= 0.45f)
+				colour = vec3(0.3f, 0.3f, 0.9f);
+			else if (hc <= 0.52f)
+				colour = vec3(0.7f, 0.7f, 0.2f);
+			else if (hc <= 0.6f)
+				colour = vec3(0.2f, 0.7f, 0.2f);
+			else if (hc <= 0.75f)
+				colour = vec3(0.6f, 0.4f, 0.3f);
+			else
+				colour = vec3(0.9f, 0.9f, 0.9f);
+
+			GLuint v = (r * n + c) * 3;
+			tile->data[v + 0] = position;
+			tile->data[v + 1] = normal;
+			tile->data[v + 2] = colour;
+		}
+	}
+}
+
+
+/* Called once per frame with the camera (or player) position.
+   Queues missing tiles nearest first, cancels queued tiles that are no longer wanted,
+   uploads tiles finished by the workers and evicts tiles over the budget.
+   None of this waits for tile generation */
+void terrain_chunks::update(vec3 position)
+{
+	if (workers.empty()) startWorkers();
+
+	GLint cx = (GLint)floor(position.x / tile_size);
+	GLint cz = (GLint)floor(position.z / tile_size);
+	GLint radius = (GLint)view_radius;
+
+	// Wanted tiles in a circle around the position, nearest first
+	vector<pair<GLint, tile_key> > wanted;
+	for (GLint dx = -radius; dx <= radius; dx++)
+	{
+		for (GLint dz = -radius; dz <= radius; dz++)
+		{
+			GLint d2 = dx * dx + dz * dz;
+			if (d2 <= radius * radius + radius)
+				wanted.push_back(make_pair(d2, tile_key(cx + dx, cz + dz)));
+		}
+	}
+	sort(wanted.begin(), wanted.end());
+	set<tile_key> wanted_set;
+	for (size_t i = 0; i < wanted.size(); i++) wanted_set.insert(wanted[i].second);
+
+	vector<terrain_tile*> collected;
+	double now = secondsNow();
+	{
+		lock_guard<mutex> lock(queue_mutex);
+
+		// Cancel queued tiles that have moved out of range before a worker started them
+		for (deque<terrain_tile*>::iterator it = jobs.begin(); it != jobs.end();)
+		{
+			tile_key key((*it)->tx, (*it)->tz);
+			if (wanted_set.count(key) == 0)
+			{
+				lru.erase(lru_pos[key]);
+				lru_pos.erase(key);
+				tiles.erase(key);
+				delete *it;
+				it = jobs.erase(it);
+				tiles_cancelled++;
+			}
+			else ++it;
+		}
+
+		// Queue the missing tiles
+		for (size_t i = 0; i < wanted.size(); i++)
+		{
+			tile_key key = wanted[i].second;
+			if (tiles.count(key)) continue;
+
+			terrain_tile* tile = new terrain_tile;
+			tile->tx = key.first;
+			tile->tz = key.second;
+			tile->vbo = 0;
+			tile->ready = false;
+			tile->requested = now;
+			tile->generate_time = 0;
+			tiles[key] = tile;
+			lru.push_front(key);
+			lru_pos[key] = lru.begin();
+			jobs.push_back(tile);
+		}
+
+		collected.swap(finished);
+	}
+	queue_cv.notify_all();
+
+	// Mark the wanted tiles as most recently used
+	for (size_t i = wanted.size(); i-- > 0;)
+	{
+		tile_key key = wanted[i].second;
+		lru.splice(lru.begin(), lru, lru_pos[key]);
+	}
+
+	// Upload the finished tiles
+	if (upload_enabled && !collected.empty() && ibo_tile_elements == 0)
+	{
+		// All tiles have the same topology so they share one triangle list
+		GLuint n = tile_vertices;
+		vector<GLuint> elements;
+		elements.reserve((n - 1) * (n - 1) * 6);
+		for (GLuint r = 0; r < n - 1; r++)
+		{
+			for (GLuint c = 0; c < n - 1; c++)
+			{
+				GLuint top = r * n + c;
+				GLuint bottom = top + n;
+				elements.push_back(top);
+				elements.push_back(bottom);
+				elements.push_back(top + 1);
+				elements.push_back(top + 1);
+				elements.push_back(bottom + 1);
+				elements.push_back(bottom);
+			}
+		}
+		num_tile_elements = (GLuint)elements.size();
+		glGenBuffers(1, &ibo_tile_elements);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_tile_elements);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, elements.size() * sizeof(GLuint), &elements[0], GL_STATIC_DRAW);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	double ready_time = secondsNow();
+	for (size_t i = 0; i < collected.size(); i++)
+	{
+		terrain_tile* tile = collected[i];
+		if (upload_enabled)
+		{
+			glGenBuffers(1, &tile->vbo);
+			glBindBuffer(GL_ARRAY_BUFFER, tile->vbo);
+			glBufferData(GL_ARRAY_BUFFER, tile->data.size() * sizeof(vec3), &tile->data[0], GL_STATIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+		vector<vec3>().swap(tile->data);
+		tile->ready = true;
+
+		latency_ms.push_back(float((ready_time - tile->requested) * 1000.0));
+		generate_ms.push_back(float(tile->generate_time * 1000.0));
+	}
+
+	// Evict the least recently used tiles over the budget. Wanted tiles are at the
+	// front of the list and tiles still on a worker are skipped
+	list<tile_key>::iterator it = lru.end();
+	while (tiles.size() > tile_budget && it != lru.begin())
+	{
+		--it;
+		if (wanted_set.count(*it)) break;
+		if (!tiles[*it]->ready) continue;
+
+		tile_key key = *it;
+		++it;
+		evict(key);
+	}
+}
+
+
+void terrain_chunks::evict(tile_key key)
+{
+	terrain_tile* tile = tiles[key];
+	if (tile->vbo) glDeleteBuffers(1, &tile->vbo);
+	lru.erase(lru_pos[key]);
+	lru_pos.erase(key);
+	tiles.erase(key);
+	delete tile;
+	tiles_evicted++;
+}
+
+
+/* Wait for the workers to empty the job queue (used by headless tests) */
+void terrain_chunks::waitForIdle()
+{
+	unique_lock<mutex> lock(queue_mutex);
+	queue_cv.wait(lock, [this] { return jobs.empty() && busy_workers == 0; });
+}
+
+
+/* Draw all the tiles that are ready. Tiles still being generated are simply missing */
+void terrain_chunks::drawObject(int drawmode)
+{
+	if (!upload_enabled || ibo_tile_elements == 0) return;
+
+	// Enable this line to show model in wireframe
+	if (drawmode == 1)
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	else
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_tile_elements);
+	GLsizei stride = 3 * sizeof(vec3);
+
+	for (map<tile_key, terrain_tile*>::iterator it = tiles.begin(); it != tiles.end(); ++it)
+	{
+		terrain_tile* tile = it->second;
+		if (!tile->ready) continue;
+
+		glBindBuffer(GL_ARRAY_BUFFER, tile->vbo);
+		glVertexAttribPointer(attribute_v_coord, 3, GL_FLOAT, GL_FALSE, stride, 0);
+		glEnableVertexAttribArray(attribute_v_coord);
+		glVertexAttribPointer(attribute_v_normal, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(sizeof(vec3)));
+		glEnableVertexAttribArray(attribute_v_normal);
+		glVertexAttribPointer(attribute_v_colour, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)(2 * sizeof(vec3)));
+		glEnableVertexAttribArray(attribute_v_colour);
+
+		if (drawmode == 2)
+			glDrawArrays(GL_POINTS, 0, tile_vertices * tile_vertices);
+		else
+			glDrawElements(GL_TRIANGLES, num_tile_elements, GL_UNSIGNED_INT, (GLvoid*)0);
+	}
+}
+
+
+static float percentile(vector<float> values, float p)
+{
+	if (values.empty()) return 0;
+	sort(values.begin(), values.end());
+	size_t i = (size_t)(p * (values.size() - 1));
+	return values[i];
+}
+
+
+void terrain_chunks::printStats()
+{
+	GLuint ready = 0;
+	for (map<tile_key, terrain_tile*>::iterator it = tiles.begin(); it != tiles.end(); ++it)
+		if (it->second->ready) ready++;
+
+	float total = 0;
+	for (size_t i = 0; i < generate_ms.size(); i++) total += generate_ms[i];
+
+	printf("\nterrain_chunks: %u x %u vertex tiles, %u resident (%u ready), %u evicted, %u cancelled\n",
+		tile_vertices, tile_vertices, (GLuint)tiles.size(), ready, tiles_evicted, tiles_cancelled);
+	printf("  tiles generated:   %u\n", (GLuint)generate_ms.size());
+	printf("  generate time:     %.2f ms average\n", generate_ms.empty() ? 0.f : total / generate_ms.size());
+	printf("  request to ready:  min %.2f ms, median %.2f ms, p95 %.2f ms, max %.2f ms\n",
+		percentile(latency_ms, 0), percentile(latency_ms, 0.5f), percentile(latency_ms, 0.95f), percentile(latency_ms, 1));
+}
+
+
+/* Fly a camera over the terrain without a GL context and report how long tiles take
+   to become ready and how long the per-frame update() call takes */
+void terrain_chunks::flightReport()
+{
+	terrain_chunks chunks(129, 1.f, 6, 1.f, 2.f);
+	chunks.setUploadEnabled(false);
+	chunks.setViewRadius(4);
+	chunks.setTileBudget(96);
+
+	const int frames = 600;
+	vector<float> update_ms;
+	vec3 position(0);
+	for (int frame = 0; frame < frames; frame++)
+	{
+		// Curve across the terrain at roughly two tiles per second of 60 Hz frames
+		GLfloat t = frame / 60.f;
+		position = vec3(t * 2.f * chunks.tile_size, 0, sin(t) * 3.f * chunks.tile_size);
+
+		double t0 = secondsNow();
+		chunks.update(position);
+		update_ms.push_back(float((secondsNow() - t0) * 1000.0));
+
+		this_thread::sleep_for(chrono::milliseconds(4));
+	}
+	chunks.waitForIdle();
+	chunks.update(position);
+
+	chunks.printStats();
+	printf("  update() per frame: median %.3f ms, max %.3f ms over %d frames\n",
+		percentile(update_ms, 0.5f), percentile(update_ms, 1), frames);
+}
@@ -0,0 +1,99 @@
+/* terrain_chunks.h
+   Streaming terrain made of fixed size square tiles generated around a world
+   position. Tiles are generated by background worker threads, uploaded to the
+   GPU by update() on the render thread and evicted least recently used first
+   once the tile budget is exceeded.
+   Every tile samples the noise at global sample indices and computes its normals
+   from a one sample apron around the tile, so shared border vertices of
+   neighbouring tiles have identical positions and normals (no seams).
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include <vector>
+#include <deque>
+#include <list>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <glm/glm.hpp>
+
+class noise_engine;
+
+/* One terrain tile. Vertices are interleaved position, normal, colour */
+struct terrain_tile
+{
+	GLint tx, tz;					// Tile coordinates
+	GLuint vbo;						// Vertex buffer, 0 until uploaded
+	bool ready;						// Generated (and uploaded if uploads are enabled)
+	std::vector<glm::vec3> data;	// Generated vertices waiting for upload
+	double requested;				// Time the tile was queued
+	double generate_time;			// Seconds spent generating the tile on a worker
+};
+
+class terrain_chunks
+{
+public:
+	terrain_chunks(GLuint tile_vertices, GLfloat tile_size, int octaves, GLfloat freq, GLfloat scale);
+	~terrain_chunks();
+
+	void setViewRadius(GLuint tiles);		// Tiles kept around the position in each direction
+	void setTileBudget(GLuint max_tiles);	// Resident tiles before LRU eviction starts
+	void setThreads(GLuint n);				// Worker threads, 0 = hardware threads - 1
+	void setUploadEnabled(bool enable);		// Disable for headless use without a GL context
+
+	void update(glm::vec3 position);		// Queue, collect and evict tiles. Never waits for a tile
+	void drawObject(int drawmode);
+	void waitForIdle();						// Block until the generation queue is empty
+	void printStats();
+
+	static void flightReport();				// Headless camera flight printing tile latencies
+
+	GLuint tile_vertices;		// Vertices along each side of a tile
+	GLfloat tile_size;			// World size of a tile
+	GLfloat height_scale;		// World height of the noise range
+	GLuint view_radius;
+	GLuint tile_budget;
+
+	GLuint attribute_v_coord;
+	GLuint attribute_v_normal;
+	GLuint attribute_v_colour;
+
+	/* Statistics */
+	std::vector<float> latency_ms;		// Queue to ready time for every tile
+	std::vector<float> generate_ms;		// Worker time for every tile
+	GLuint tiles_evicted;
+	GLuint tiles_cancelled;
+
+private:
+	typedef std::pair<GLint, GLint> tile_key;
+
+	void startWorkers();
+	void stopWorkers();
+	void workerLoop();
+	void generateTile(terrain_tile* tile, noise_engine& engine);
+	void evict(tile_key key);
+
+	std::map<tile_key, terrain_tile*> tiles;	// Resident and pending tiles
+	std::list<tile_key> lru;					// Most recently used at the front
+	std::map<tile_key, std::list<tile_key>::iterator> lru_pos;
+
+	std::deque<terrain_tile*> jobs;				// Tiles waiting for a worker
+	std::vector<terrain_tile*> finished;		// Tiles generated but not collected by update()
+	std::vector<std::thread> workers;
+	std::mutex queue_mutex;
+	std::condition_variable queue_cv;
+	GLuint num_threads;
+	GLuint busy_workers;
+	bool stopping;
+	bool upload_enabled;
+
+	int perlin_octaves;
+	GLfloat perlin_freq;
+	GLfloat perlin_scale;
+
+	GLuint ibo_tile_elements;	// Shared by all tiles
+	GLuint num_tile_elements;
+};
@@ -1,443 +1,2237 @@
-/* terrain_object.cpp
-   Includes functions to get floating point grid position from world coordinates
-   and get the height from floating point grid position.
-
-   vec2 terrain_object::getGridPos(GLfloat x, GLfloat z)
-   float terrain_object::heightAtPosition(GLfloat x, GLfloat z)
-
-   Iain Martin November 2018
-*/
-
-#include "terrain_object.h"
-#include <glm/gtc/noise.hpp>
-#include "glm/gtc/random.hpp"
-#include <stdio.h>
-#include <iostream>
-
-using namespace std;
-using namespace glm;
-
-/* Define the vertex attributes for vertex positions and normals. 
-   Make these match your application and vertex shader
-   You might also want to add texture coordinates */
-terrain_object::terrain_object(int octaves, GLfloat freq, GLfloat scale)
-{
-	attribute_v_coord = 0;
-	attribute_v_colour = 1;
-	attribute_v_normal = 2;
-	xsize = 0;	// Set to zero because we haven't created the heightfield array yet
-	zsize = 0;	
-	perlin_octaves = octaves;
-	perlin_freq = freq;
-	perlin_scale = scale;
-	height_scale = 1.f;
-}
-
-
-terrain_object::~terrain_object()
-{
-	/* tidy up */
-	if (vertices) delete[] vertices;
-	if (normals) delete[] normals;
-	if (colours) delete[] colours;
-}
-
-
-/* Copy the vertices, normals and element indices into vertex buffers */
-void terrain_object::createObject()
-{
-	/* Generate the vertex buffer object */
-	glGenBuffers(1, &vbo_mesh_vertices);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_vertices);
-	glBufferData(GL_ARRAY_BUFFER, xsize * zsize  * sizeof(vec3), &(vertices[0]), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	/* Store the colours in a buffer object */
-	glGenBuffers(1, &vbo_mesh_colours);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_colours);
-	glBufferData(GL_ARRAY_BUFFER, xsize * zsize * sizeof(vec3), &(colours[0]), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	/* Store the normals in a buffer object */
-	glGenBuffers(1, &vbo_mesh_normals);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_normals);
-	glBufferData(GL_ARRAY_BUFFER, xsize * zsize * sizeof(vec3), &(normals[0]), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	// Generate a buffer for the indices
-	glGenBuffers(1, &ibo_mesh_elements);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_mesh_elements);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, elements.size()* sizeof(GLuint), &(elements[0]), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-}
-
-/* Enable vertex attributes and draw object
-Could improve efficiency by moving the vertex attribute pointer functions to the
-create object but this method is more general 
-*/
-void terrain_object::drawObject(int drawmode)
-{
-	int size;	// Used to get the byte size of the element (vertex index) array
-
-	// Describe our vertices array to OpenGL (it can't guess its format automatically)
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_vertices);
-	glVertexAttribPointer(
-		attribute_v_coord,  // attribute index
-		3,                  // number of elements per vertex, here (x,y,z)
-		GL_FLOAT,           // the type of each element
-		GL_FALSE,           // take our values as-is
-		0,                  // no extra data between each position
-		0                   // offset of first element
-		);
-	glEnableVertexAttribArray(attribute_v_coord);
-
-	// Describe our colours array to OpenGL (it can't guess its format automatically)
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_colours);
-	glVertexAttribPointer(
-		attribute_v_colour,  // attribute index
-		3,                  // number of elements per vertex, here (x,y,z)
-		GL_FLOAT,           // the type of each element
-		GL_FALSE,           // take our values as-is
-		0,                  // no extra data between each position
-		0                   // offset of first element
-		);
-	glEnableVertexAttribArray(attribute_v_colour);
-
-	glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_normals);
-	glVertexAttribPointer(
-		attribute_v_normal, // attribute
-		3,                  // number of elements per vertex, here (x,y,z)
-		GL_FLOAT,           // the type of each element
-		GL_FALSE,           // take our values as-is
-		0,                  // no extra data between each position
-		0                   // offset of first element
-		);
-	glEnableVertexAttribArray(attribute_v_normal);
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_mesh_elements); 
-	glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
-
-	// Enable this line to show model in wireframe
-	if (drawmode == 1)
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	else
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-	/* Draw the triangle strips */
-	for (GLuint i = 0; i < xsize - 1; i++)
-	{
-		GLuint location = sizeof(GLuint) * (i * zsize * 2);
-		glDrawElements(GL_TRIANGLE_STRIP, zsize * 2, GL_UNSIGNED_INT, (GLvoid*)(location));
-	}
-}
-
-
-/* Define the terrian heights */
-/* Uses code adapted from OpenGL Shading Language Cookbook: Chapter 8 */
-void terrain_object::calculateNoise()
-{
-	/* Create the array to store the noise values */
-	/* The size is the number of vertices * number of octaves */
-	noise = new GLfloat[xsize * zsize * perlin_octaves];
-	for (int i = 0; i < (xsize*zsize*perlin_octaves); i++) noise[i] = 0;
-
-	GLfloat xfactor = 1.f / (xsize - 1);
-	GLfloat zfactor = 1.f / (zsize - 1);
-	GLfloat freq = perlin_freq;
-	GLfloat scale = perlin_scale;
-
-	for (GLuint row = 0; row < zsize; row++)
-	{
-		for (GLuint col = 0; col < xsize; col++)
-		{
-			GLfloat x = xfactor * col;
-			GLfloat z = zfactor * row;
-			GLfloat sum = 0;
-			GLfloat curent_scale = scale;
-			GLfloat current_freq = freq;
-
-			// Compute the sum for each octave
-			for (GLuint oct = 0; oct < perlin_octaves; oct++)
-			{
-				vec2 p(x*current_freq, z*current_freq);
-				GLfloat val = perlin(p) / curent_scale;
-				sum += val;
-				GLfloat result = (sum + 1.f) / 2.f;
-
-				// Store the noise value in our noise array
-				noise[(row * xsize + col) * perlin_octaves + oct] = result;
-				
-				// Move to the next frequency and scale
-				current_freq *= 2.f;
-				curent_scale *= scale;
-			}
-			
-		}
-	}
-}
-
-/* Define the vertex array that specifies the terrain
-   (xp, zp) specifies the pixel dimensions of the heightfield (x * y) vertices
-   (xs, ys) specifies the size of the heightfield region in world coords
-   */
-void terrain_object::createTerrain(GLuint xp, GLuint zp, GLfloat xs, GLfloat zs, GLfloat sealevel)
-{
-	xsize = xp;
-	zsize = zp;
-	width = xs;
-	height = zs;
-
-	/* Scale heights in relation to the terrain size */
-	height_scale = xs*4.f;
-
-	/* Create array of vertices */
-	GLuint numvertices = xsize * zsize;
-	vertices = new vec3[numvertices];
-	normals  = new vec3[numvertices];
-	colours = new vec3[numvertices];
-
-	/* First calculate the noise array which we'll use for our vertex height values */
-	calculateNoise();
-
-	/* Define starting (x,z) positions and the step changes */
-	GLfloat xpos = -width / 2.f;
-	GLfloat xpos_step = width / GLfloat(xp);
-	GLfloat zpos_step = height / GLfloat(zp);
-	GLfloat zpos_start = -height / 2.f;
-
-	/* Define the vertex positions for a flat surface */
-	/* Set the normals to zero */
-	/* Note, for a flat surface, set the normals to (0, 1, 0) but we don't do that because
-	   that will affect the true normal calculation in the next step */
-	for (GLuint row = 0; row < zsize; row++)
-	{
-		GLfloat zpos = zpos_start;
-		for (GLuint col = 0; col < zsize; col++)
-		{
-			GLfloat height = noise[(row * xsize + col) * perlin_octaves + perlin_octaves - 1];
-			vertices[row * xsize + col] = vec3(xpos, (height - 0.5f) * height_scale, zpos);
-
-			// Zero the normal, it gets calculated at the end of this method after all the vertex positions
-			// have been set.
-			normals[row * xsize + col] = vec3(0, 0.0f, 0);
-			zpos += zpos_step;
-		}
-		xpos += xpos_step;
-	}
-
-
-	/* Define vertices for triangle strips */
-	for (GLuint x = 0; x < xsize - 1; x++)
-	{
-		GLuint top    = x * zsize;
-		GLuint bottom = top + zsize;
-		for (GLuint z = 0; z < zsize; z++)
-		{
-			elements.push_back(top++);
-			elements.push_back(bottom++);
-		}
-	}
-
-	// Define the range of terrina heights
-	height_max = xs / 8.f;
-	height_min = -height_max;
-
-	// Stretch the height values to a defined height range 
-	stretchToRange(height_min, height_max);
-
-	defineSeaLevel(sealevel);
-
-	// Calculate the normals by averaging cross products for all triangles 
-	calculateNormals();
-}
-
-/* Calculate normals by using cross products along the triangle strips
-   and averaging the normals for each vertex */
-void terrain_object::calculateNormals()
-{
-	GLuint element_pos = 0;
-	vec3 AB, AC, cross_product;
-
-	// Loop through each triangle strip  
-	for (GLuint x = 0; x < xsize - 1; x++)
-	{
-		// Loop along the strip
-		for (GLuint tri = 0; tri < zsize * 2 - 2; tri++)
-		{
-			// Extract the vertex indices from the element array 
-			GLuint v1 = elements[element_pos];
-			GLuint v2 = elements[element_pos+1];
-			GLuint v3 = elements[element_pos+2];
-			
-			// Define the two vectors for the triangle
-			AB = vertices[v2] - vertices[v1];
-			AC = vertices[v3] - vertices[v1];
-
-			// Calculate the cross product
-			// We have to change the winding for every second triangle to ensure the normals
-			// are the correct diections. See what happens if we don't do this by using the
-			// commented out line of code below instead?
-//			cross_product = normalize(cross(AC, AB));		// Incorrect winding
-			if (tri % 2 == 0) 
-				cross_product = normalize(cross(AC, AB));
-			else 
-				cross_product = normalize(cross(AB, AC));
-
-			// Add this normal to the vertex normal for all three vertices in the triangle
-			normals[v1] += cross_product;
-			normals[v2] += cross_product;
-			normals[v3] += cross_product;
-
-			// Move on to the next vertex along the strip
-			element_pos++;
-		}
-
-		// Jump past the last two element positions to reach the start of the strip
-		element_pos += 2;	
-	}
-
-	// Normalise the normals (this gives us averaged, vertex normals)
-	for (GLuint v = 0; v < xsize * zsize; v++)
-	{
-		normals[v] = normalize(normals[v]);
-	}
-}
-
-/* Stretch the height values to the range min to max */
-void terrain_object::stretchToRange(GLfloat min, GLfloat max)
-{
-	/* Calculate min and max values */
-	GLfloat cmin, cmax;
-	cmin = cmax = vertices[0].y;
-	for (GLuint v = 1; v < xsize*zsize; v++)
-	{
-		if (vertices[v].y < cmin) cmin = vertices[v].y;
-		if (vertices[v].y > cmax) cmax = vertices[v].y;
-	}
-
-	// Calculate stretch factor
-	GLfloat stretch_factor = (max - min) / (cmax - cmin);
-	GLfloat stretch_diff = cmin - min;
-
-	/* Rescale the vertices */
-	for (GLuint v = 0; v < xsize*zsize; v++)
-	{
-		vertices[v].y = (vertices[v].y - stretch_diff) * stretch_factor;
-	}
-}
-
-
-/* Calculate terrian colours */
-void terrain_object::setColour(vec3 c)
-{
-	GLuint numVertices = xsize * zsize;
-
-	// Loop through all vertices, set colours
-	// You could set height relayed colout here if you want to or add in some random variationd
-	for (GLuint i = 0; i < numVertices; i++)
-	{
-		vec3 height_normal = normalize(vertices[i]);
-		float height = vertices[i].y;
-
-		// Define a brown terrain colour
-		colours[i] = c;
-
-		// You could add code here to set the terrain colour based on vertex height or any other conditions
-
-	}
-
-}
-
-
-/* Define a sea level in the terrain */
-void terrain_object::defineSeaLevel(GLfloat s)
-{
-	sealevel = s;
-	for (int v = 0; v < xsize*zsize; v++)
-	{
-		if (vertices[v].y < sealevel)
-		{
-			vertices[v].y = sealevel;
-		}
-	}
-}
-
-
-/* Calculate terrian colours based on height with small random variations */
-void terrain_object::setColourBasedOnHeight()
-{
-	GLuint numVertices = xsize * zsize;
-
-	// Loop through all vertices, set colour based on height
-	for (GLuint i = 0; i < numVertices; i++)
-	{
-		glm::vec3 height_normal = glm::normalize(vertices[i]);
-		float height = vertices[i].y;
-
-		// Scale height to range 0 to 1 to use to define colours
-		height = (height - height_min) / (height_max - height_min);
-		float sea_norm = (sealevel - height_min) / (height_max - height_min);
-
-		// Some random values to use for colour selection
-		float rand = glm::linearRand(0.0, 0.1);
-		float rand2 = glm::linearRand(0.0, 0.05);
-		float rand3 = glm::linearRand(0.0, 0.02);
-
-		// Define colour based on normalised height (0 to 1)
-		// with some random variations
-		if (height <= sea_norm)
-			colours[i] = glm::vec3(0.3 + rand2, 0.3 + rand2, 0.9);
-		else if (height <= 0.52 + rand3)
-			colours[i] = glm::vec3(0.7 + rand2, 0.7, 0.2);
-		else if (height <= 0.6 + rand3)
-			colours[i] = glm::vec3(0.2, 0.7 + rand, 0.2);
-		else if (height <= 0.93 + rand3)
-			colours[i] = glm::vec3(0.6 + rand2, 0.4, 0.3);
-		else
-			colours[i] = glm::vec3(0.9 + rand2, 0.9 + rand2, 0.9 + rand2);
-
-	}
-
-}
-
-// Get height on terrain from world coordinates
-// Rounds the floating point grid values to get the nearest (int) grid point
-// Note that a more accurate algorithm would be a bilinear interpolation
-// of the four nearest grid points
-float terrain_object::heightAtPosition(GLfloat x, GLfloat z)
-{
-	// Get grid position in floating point
-	vec2 grid_pos = getGridPos(x, z);
-
-	// Get integer grid position to
-	int gx = round(grid_pos.x);
-	int gz = round(grid_pos.y);
-
-	// Get vertex number from integer grid position
-	int vnum = gx * xsize + gz;
-
-	// Check that the vertex number is in range
-	// before getting the height value
-	float grid_height = 0;
-	if (vnum > 0 && vnum < xsize*zsize)
-	{
-		grid_height = vertices[vnum].y;
-	}
-
-	return grid_height;
-}
-
-// Get a terrain height array gtid position from a world coordinate
-// Note that this will only work if you DON'T scale and shift the terrain object
-vec2 terrain_object::getGridPos(GLfloat x, GLfloat z)
-{
-	GLfloat Xgrid = ((x + (width / 2.f)) / width) * float(xsize);
-	GLfloat Zgrid = ((z + (height / 2.f)) / height) * float(zsize);
-
-	return vec2(Xgrid, Zgrid);
-}
-
-
-
-
+/* terrain_object.cpp
+   Includes functions to get floating point grid position from world coordinates
+   and get the height from floating point grid position.
+
+   vec2 terrain_object::getGridPos(GLfloat x, GLfloat z)
+   float terrain_object::heightAtPosition(GLfloat x, GLfloat z)
+
+   Iain Martin November 2018
+*/
+
+#include "terrain_object.h"
+#include "noise_engine.h"
+#include "perf_stats.h"
+#include "mapped_file.h"
+#include "heightmap.h"
+#include "hash_random.h"
+#include <glm/gtc/noise.hpp>
+#include "glm/gtc/random.hpp"
+#include <stdio.h>
+#include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define TERRAIN_SIMD 1
+#else
+	#define TERRAIN_SIMD 0
+#endif
+
+using namespace std;
+using namespace glm;
+
+/* Index that ends one triangle strip and starts the next in the same draw call */
+const GLuint TERRAIN_RESTART_INDEX = 0xFFFFFFFF;
+
+/* Quads per column band of the triangle list. The two rows of band vertices that a row
+   of quads uses stay within a 32 entry post-transform vertex cache */
+const GLuint TERRAIN_CACHE_BAND = 14;
+
+GLuint terrain_object::draw_calls = 0;
+
+/* Define the vertex attributes for vertex positions and normals. 
+   Make these match your application and vertex shader
+   You might also want to add texture coordinates */
+terrain_object::terrain_object(int octaves, GLfloat freq, GLfloat scale)
+{
+	attribute_v_coord = 0;
+	attribute_v_colour = 1;
+	attribute_v_normal = 2;
+	attribute_v_morph = 3;
+	xsize = 0;	// Set to zero because we haven't created the heightfield array yet
+	zsize = 0;	
+	perlin_octaves = octaves;
+	perlin_freq = freq;
+	perlin_scale = scale;
+	height_scale = 1.f;
+	keep_octaves = false;
+	triangle_list = false;
+	colour_seed = 0;
+	ramp_height_steps = ramp_slope_steps = 0;
+	ramp_jitter = 0;
+	colour_by_height = false;
+	vertices = NULL;
+	normals = NULL;
+	colours = NULL;
+	noise = NULL;
+
+	lod_enabled = false;
+	lod_leaf = 0;
+	lod_levels = 0;
+	vbo_mesh_morph = 0;
+	lod_level_id = morph_range_id = lod_eye_id = (GLuint)-1;
+	lod_triangles = 0;
+	lod_draw_calls = 0;
+
+	vertex_format = TERRAIN_FORMAT_FLOAT;
+	vertex_format_id = grid_columns_id = grid_decode_id = height_decode_id = (GLuint)-1;
+	vao = 0;
+	vbo_mesh_vertices = vbo_mesh_normals = vbo_mesh_colours = ibo_mesh_elements = 0;
+
+	displacement_patch = 32;
+	displacement_float = false;
+	tex_height = tex_normal = tex_colour = 0;
+	num_patch_elements = 0;
+	patch_quads_id = patch_columns_id = height_map_id = normal_map_id = colour_map_id = (GLuint)-1;
+}
+
+
+terrain_object::~terrain_object()
+{
+	/* tidy up */
+	if (vertices) delete[] vertices;
+	if (normals) delete[] normals;
+	if (colours) delete[] colours;
+	if (noise) delete[] noise;
+
+	/* Release the GL objects made by createObject() and enableLOD() */
+	if (vao)
+	{
+		glDeleteVertexArrays(1, &vao);
+		GLuint buffers[] = { vbo_mesh_vertices, vbo_mesh_colours, vbo_mesh_normals, ibo_mesh_elements, vbo_mesh_morph };
+		glDeleteBuffers(5, buffers);
+		if (!ibo_lod_elements.empty()) glDeleteBuffers((GLsizei)ibo_lod_elements.size(), &ibo_lod_elements[0]);
+	}
+	if (tex_height)
+	{
+		GLuint textures[] = { tex_height, tex_normal, tex_colour };
+		glDeleteTextures(3, textures);
+	}
+}
+
+
+/* Keep the running noise sum of every octave after createTerrain() (for debugging).
+   By default only the final height is generated and the noise array is released
+   once the vertex heights have been set */
+void terrain_object::setKeepOctaves(bool keep)
+{
+	keep_octaves = keep;
+}
+
+
+/* Build the element array as a vertex cache ordered triangle list instead of
+   triangle strips joined by primitive restart. Call before createTerrain() */
+void terrain_object::setTriangleList(bool enable)
+{
+	triangle_list = enable;
+}
+
+
+/* Choose how createObject() stores the vertices (see terrain_vertex_format).
+   The packed formats need a shader that decodes them, see setFormatUniforms() */
+void terrain_object::setVertexFormat(terrain_vertex_format format)
+{
+	vertex_format = format;
+}
+
+
+/* Look up the uniforms in program (e.g. terrain.vert) that decode the packed vertex formats */
+void terrain_object::setFormatUniforms(GLuint program)
+{
+	vertex_format_id = glGetUniformLocation(program, "vertex_format");
+	grid_columns_id = glGetUniformLocation(program, "grid_columns");
+	grid_decode_id = glGetUniformLocation(program, "grid_decode");
+	height_decode_id = glGetUniformLocation(program, "height_decode");
+	patch_quads_id = glGetUniformLocation(program, "patch_quads");
+	patch_columns_id = glGetUniformLocation(program, "patch_columns");
+	height_map_id = glGetUniformLocation(program, "height_map");
+	normal_map_id = glGetUniformLocation(program, "normal_map");
+	colour_map_id = glGetUniformLocation(program, "colour_map");
+}
+
+
+/* Size of the patch instanced by TERRAIN_FORMAT_DISPLACED (at most 255 quads so the
+   patch uses 16 bit indices) and whether its heights are stored as R32F instead
+   of R16. Call before createObject() */
+void terrain_object::setDisplacement(GLuint patch_quads, bool float_heights)
+{
+	displacement_patch = std::min(std::max(patch_quads, 1u), 255u);
+	displacement_float = float_heights;
+}
+
+
+/* Bytes per vertex in each vertex format */
+GLuint terrain_object::vertexSize(terrain_vertex_format format)
+{
+	switch (format)
+	{
+	case TERRAIN_FORMAT_PACKED: return sizeof(terrain_vertex_packed);
+	case TERRAIN_FORMAT_HEIGHT16: return sizeof(terrain_vertex_height16);
+	case TERRAIN_FORMAT_DISPLACED: return sizeof(GLushort) + 2 * sizeof(GLshort) + 4;
+	default: return 3 * sizeof(vec3);
+	}
+}
+
+
+/* Octahedral normal encoding: the normal is projected onto the octahedron |x|+|y|+|z| = 1
+   and the lower half (y < 0) folded over the upper half, giving two values in [-1, 1]
+   that are stored as normalized shorts. Folding about y keeps the best precision
+   for the mostly upward terrain normals. octDecode() matches the shader */
+static void octEncode(vec3 n, GLshort* out)
+{
+	n /= (fabs(n.x) + fabs(n.y) + fabs(n.z));
+	vec2 e(n.x, n.z);
+	if (n.y < 0)
+	{
+		e = vec2((1.f - fabs(n.z)) * (n.x >= 0 ? 1.f : -1.f), (1.f - fabs(n.x)) * (n.z >= 0 ? 1.f : -1.f));
+	}
+	out[0] = (GLshort)round(clamp(e.x, -1.f, 1.f) * 32767.f);
+	out[1] = (GLshort)round(clamp(e.y, -1.f, 1.f) * 32767.f);
+}
+
+static vec3 octDecode(const GLshort* in)
+{
+	vec2 e(std::max(in[0] / 32767.f, -1.f), std::max(in[1] / 32767.f, -1.f));
+	vec3 n(e.x, 1.f - fabs(e.x) - fabs(e.y), e.y);
+	if (n.y < 0)
+	{
+		n.x = (1.f - fabs(e.y)) * (e.x >= 0 ? 1.f : -1.f);
+		n.z = (1.f - fabs(e.x)) * (e.y >= 0 ? 1.f : -1.f);
+	}
+	return normalize(n);
+}
+
+
+/* Work out the grid origin, steps and height range used to decode TERRAIN_FORMAT_HEIGHT16 */
+void terrain_object::calculateDecode()
+{
+	GLuint last_row = (xsize - 1) * zsize;
+	grid_decode = vec4(vertices[0].x, vertices[0].z,
+		(vertices[last_row].x - vertices[0].x) / GLfloat(xsize - 1),
+		(vertices[zsize - 1].z - vertices[0].z) / GLfloat(zsize - 1));
+
+	GLfloat hmin = vertices[0].y, hmax = vertices[0].y;
+	for (GLuint v = 1; v < xsize * zsize; v++)
+	{
+		hmin = std::min(hmin, vertices[v].y);
+		hmax = std::max(hmax, vertices[v].y);
+	}
+	height_decode = vec2(hmin, std::max(hmax - hmin, 1e-6f));
+}
+
+
+static void packColour(vec3 c, GLubyte* out)
+{
+	for (int i = 0; i < 3; i++)
+		out[i] = (GLubyte)round(clamp(c[i], 0.f, 1.f) * 255.f);
+	out[3] = 255;
+}
+
+
+/* Pack count vertices starting at first into out in the current vertex format.
+   Not used for TERRAIN_FORMAT_FLOAT which uploads the arrays as they are */
+void terrain_object::packVertices(GLuint first, GLuint count, GLubyte* out)
+{
+	for (GLuint v = first; v < first + count; v++)
+	{
+		GLubyte colour[4];
+		packColour(colours[v], colour);
+
+		if (vertex_format == TERRAIN_FORMAT_PACKED)
+		{
+			terrain_vertex_packed* p = (terrain_vertex_packed*)out + (v - first);
+			p->position = vertices[v];
+			octEncode(normals[v], p->normal);
+			memcpy(p->colour, colour, 4);
+		}
+		else
+		{
+			terrain_vertex_height16* p = (terrain_vertex_height16*)out + (v - first);
+			GLfloat h = (vertices[v].y - height_decode.x) / height_decode.y;
+			p->height = (GLushort)round(clamp(h, 0.f, 1.f) * 65535.f);
+			p->pad = 0;
+			octEncode(normals[v], p->normal);
+			memcpy(p->colour, colour, 4);
+		}
+	}
+}
+
+
+/* Pack the texels of count grid vertices starting at first for the TERRAIN_FORMAT_DISPLACED
+   textures: the height as R16 (heights16) or R32F (heights32), the octahedral normal
+   and the colour. Heights are packed in the same way as TERRAIN_FORMAT_HEIGHT16 */
+void terrain_object::packTexels(GLuint first, GLuint count, GLushort* heights16, GLfloat* heights32, GLshort* normals2, GLubyte* colours4)
+{
+	for (GLuint v = first; v < first + count; v++)
+	{
+		GLuint i = v - first;
+		if (heights32)
+		{
+			heights32[i] = vertices[v].y;
+		}
+		else
+		{
+			GLfloat h = (vertices[v].y - height_decode.x) / height_decode.y;
+			heights16[i] = (GLushort)round(clamp(h, 0.f, 1.f) * 65535.f);
+		}
+		octEncode(normals[v], normals2 + i * 2);
+		packColour(colours[v], colours4 + i * 4);
+	}
+}
+
+
+/* Patches along each side of the grid in TERRAIN_FORMAT_DISPLACED. Patches that hang
+   over the edge of the grid are clamped to the last row or column in the shader */
+GLuint terrain_object::patchColumns()
+{
+	return (zsize - 1 + displacement_patch - 1) / displacement_patch;
+}
+
+GLuint terrain_object::patchRows()
+{
+	return (xsize - 1 + displacement_patch - 1) / displacement_patch;
+}
+
+
+/* Build the flat patch instanced by TERRAIN_FORMAT_DISPLACED: every vertex holds its
+   row and column within the patch and the quads use the winding of the grid */
+void terrain_object::createPatch()
+{
+	GLuint n = displacement_patch + 1;
+	vector<GLushort> coords;
+	coords.reserve(n * n * 2);
+	for (GLuint r = 0; r < n; r++)
+	{
+		for (GLuint c = 0; c < n; c++)
+		{
+			coords.push_back((GLushort)r);
+			coords.push_back((GLushort)c);
+		}
+	}
+
+	vector<GLushort> patch;
+	patch.reserve(displacement_patch * displacement_patch * 6);
+	for (GLuint r = 0; r < displacement_patch; r++)
+	{
+		for (GLuint c = 0; c < displacement_patch; c++)
+		{
+			GLushort top = GLushort(r * n + c);
+			GLushort bottom = GLushort(top + n);
+			patch.push_back(top);
+			patch.push_back(bottom);
+			patch.push_back(top + 1);
+			patch.push_back(top + 1);
+			patch.push_back(bottom);
+			patch.push_back(bottom + 1);
+		}
+	}
+	num_patch_elements = (GLuint)patch.size();
+
+	if (!vbo_mesh_vertices) glGenBuffers(1, &vbo_mesh_vertices);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_vertices);
+	glBufferData(GL_ARRAY_BUFFER, coords.size() * sizeof(GLushort), &coords[0], GL_STATIC_DRAW);
+
+	if (!ibo_mesh_elements) glGenBuffers(1, &ibo_mesh_elements);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_mesh_elements);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, patch.size() * sizeof(GLushort), &patch[0], GL_STATIC_DRAW);
+}
+
+
+/* Copy rows row0 to row1, columns col0 to col1 (end exclusive) of the grid into the
+   TERRAIN_FORMAT_DISPLACED textures, creating the textures the first time.
+   Texture x is the grid column and texture y the grid row */
+void terrain_object::uploadTextures(GLuint row0, GLuint col0, GLuint row1, GLuint col1)
+{
+	GLint previous_texture, previous_alignment;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous_texture);
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &previous_alignment);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	GLenum height_internal = displacement_float ? GL_R32F : GL_R16;
+	GLenum height_type = displacement_float ? GL_FLOAT : GL_UNSIGNED_SHORT;
+	if (!tex_height)
+	{
+		GLuint textures[3];
+		glGenTextures(3, textures);
+		tex_height = textures[0];
+		tex_normal = textures[1];
+		tex_colour = textures[2];
+
+		GLenum internal[] = { height_internal, GL_RG16_SNORM, GL_RGBA8 };
+		GLenum format[] = { GL_RED, GL_RG, GL_RGBA };
+		GLenum type[] = { height_type, GL_SHORT, GL_UNSIGNED_BYTE };
+		for (int t = 0; t < 3; t++)
+		{
+			glBindTexture(GL_TEXTURE_2D, textures[t]);
+			glTexImage2D(GL_TEXTURE_2D, 0, internal[t], zsize, xsize, 0, format[t], type[t], NULL);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		}
+	}
+
+	GLuint cols = col1 - col0;
+	GLuint rows = row1 - row0;
+	vector<GLushort> heights16(displacement_float ? 0 : rows * cols);
+	vector<GLfloat> heights32(displacement_float ? rows * cols : 0);
+	vector<GLshort> normals2(rows * cols * 2);
+	vector<GLubyte> colours4(rows * cols * 4);
+	for (GLuint row = row0; row < row1; row++)
+	{
+		GLuint i = (row - row0) * cols;
+		packTexels(row * zsize + col0, cols, displacement_float ? NULL : &heights16[i],
+			displacement_float ? &heights32[i] : NULL, &normals2[i * 2], &colours4[i * 4]);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, tex_height);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, col0, row0, cols, rows, GL_RED, height_type,
+		displacement_float ? (const GLvoid*)&heights32[0] : (const GLvoid*)&heights16[0]);
+	glBindTexture(GL_TEXTURE_2D, tex_normal);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, col0, row0, cols, rows, GL_RG, GL_SHORT, &normals2[0]);
+	glBindTexture(GL_TEXTURE_2D, tex_colour);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, col0, row0, cols, rows, GL_RGBA, GL_UNSIGNED_BYTE, &colours4[0]);
+
+	glBindTexture(GL_TEXTURE_2D, previous_texture);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, previous_alignment);
+}
+
+
+/* Copy the vertices, normals and element indices into vertex buffers and
+   record the attribute layout in a vertex array object */
+void terrain_object::createObject()
+{
+	/* Remember the application's VAO so we can put it back when we're done */
+	GLint previous_vao;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous_vao);
+
+	if (!vao) glGenVertexArrays(1, &vao);
+	glBindVertexArray(vao);
+
+	if (vertex_format == TERRAIN_FORMAT_FLOAT)
+	{
+		/* Generate the vertex buffer object */
+		if (!vbo_mesh_vertices) glGenBuffers(1, &vbo_mesh_vertices);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_vertices);
+		glBufferData(GL_ARRAY_BUFFER, xsize * zsize  * sizeof(vec3), &(vertices[0]), GL_STATIC_DRAW);
+
+		/* Store the colours in a buffer object */
+		if (!vbo_mesh_colours) glGenBuffers(1, &vbo_mesh_colours);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_colours);
+		glBufferData(GL_ARRAY_BUFFER, xsize * zsize * sizeof(vec3), &(colours[0]), GL_STATIC_DRAW);
+
+		/* Store the normals in a buffer object */
+		if (!vbo_mesh_normals) glGenBuffers(1, &vbo_mesh_normals);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_normals);
+		glBufferData(GL_ARRAY_BUFFER, xsize * zsize * sizeof(vec3), &(normals[0]), GL_STATIC_DRAW);
+	}
+	else if (vertex_format == TERRAIN_FORMAT_DISPLACED)
+	{
+		/* Only a small patch in buffers, the grid goes into textures */
+		if (vbo_mesh_colours) glDeleteBuffers(1, &vbo_mesh_colours);
+		if (vbo_mesh_normals) glDeleteBuffers(1, &vbo_mesh_normals);
+		vbo_mesh_colours = vbo_mesh_normals = 0;
+
+		// New textures in case the grid size or height format changed
+		if (tex_height)
+		{
+			GLuint textures[] = { tex_height, tex_normal, tex_colour };
+			glDeleteTextures(3, textures);
+			tex_height = tex_normal = tex_colour = 0;
+		}
+
+		calculateDecode();
+		createPatch();
+		uploadTextures(0, 0, xsize, zsize);
+	}
+	else
+	{
+		/* All the attributes interleaved in one buffer */
+		if (vbo_mesh_colours) glDeleteBuffers(1, &vbo_mesh_colours);
+		if (vbo_mesh_normals) glDeleteBuffers(1, &vbo_mesh_normals);
+		vbo_mesh_colours = vbo_mesh_normals = 0;
+
+		calculateDecode();
+		vector<GLubyte> packed(xsize * zsize * vertexSize(vertex_format));
+		packVertices(0, xsize * zsize, &packed[0]);
+
+		if (!vbo_mesh_vertices) glGenBuffers(1, &vbo_mesh_vertices);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_vertices);
+		glBufferData(GL_ARRAY_BUFFER, packed.size(), &packed[0], GL_STATIC_DRAW);
+	}
+
+	// Generate a buffer for the indices
+	if (vertex_format != TERRAIN_FORMAT_DISPLACED)
+	{
+		if (!ibo_mesh_elements) glGenBuffers(1, &ibo_mesh_elements);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_mesh_elements);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, elements.size()* sizeof(GLuint), &(elements[0]), GL_STATIC_DRAW);
+	}
+
+	bindAttributes();
+
+	glBindVertexArray(previous_vao);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+/* Describe the vertex buffers to the bound VAO */
+void terrain_object::bindAttributes()
+{
+	if (vertex_format == TERRAIN_FORMAT_FLOAT)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_vertices);
+		glVertexAttribPointer(attribute_v_coord, 3, GL_FLOAT, GL_FALSE, 0, 0);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_colours);
+		glVertexAttribPointer(attribute_v_colour, 3, GL_FLOAT, GL_FALSE, 0, 0);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_normals);
+		glVertexAttribPointer(attribute_v_normal, 3, GL_FLOAT, GL_FALSE, 0, 0);
+	}
+	else if (vertex_format == TERRAIN_FORMAT_PACKED)
+	{
+		GLsizei stride = sizeof(terrain_vertex_packed);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_vertices);
+		glVertexAttribPointer(attribute_v_coord, 3, GL_FLOAT, GL_FALSE, stride, (GLvoid*)offsetof(terrain_vertex_packed, position));
+		glVertexAttribPointer(attribute_v_normal, 2, GL_SHORT, GL_TRUE, stride, (GLvoid*)offsetof(terrain_vertex_packed, normal));
+		glVertexAttribPointer(attribute_v_colour, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (GLvoid*)offsetof(terrain_vertex_packed, colour));
+	}
+	else if (vertex_format == TERRAIN_FORMAT_DISPLACED)
+	{
+		// Only the patch row and column, everything else comes from the textures
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_vertices);
+		glVertexAttribPointer(attribute_v_coord, 2, GL_UNSIGNED_SHORT, GL_FALSE, 0, 0);
+		glEnableVertexAttribArray(attribute_v_coord);
+		glDisableVertexAttribArray(attribute_v_colour);
+		glDisableVertexAttribArray(attribute_v_normal);
+		glDisableVertexAttribArray(attribute_v_morph);
+		return;
+	}
+	else
+	{
+		// The height arrives in position.x, x and z come from gl_VertexID in the shader
+		GLsizei stride = sizeof(terrain_vertex_height16);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_vertices);
+		glVertexAttribPointer(attribute_v_coord, 1, GL_UNSIGNED_SHORT, GL_TRUE, stride, (GLvoid*)offsetof(terrain_vertex_height16, height));
+		glVertexAttribPointer(attribute_v_normal, 2, GL_SHORT, GL_TRUE, stride, (GLvoid*)offsetof(terrain_vertex_height16, normal));
+		glVertexAttribPointer(attribute_v_colour, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (GLvoid*)offsetof(terrain_vertex_height16, colour));
+	}
+	glEnableVertexAttribArray(attribute_v_coord);
+	glEnableVertexAttribArray(attribute_v_colour);
+	glEnableVertexAttribArray(attribute_v_normal);
+
+	// The LOD morph targets, when enableLOD() has made them
+	if (vbo_mesh_morph)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_morph);
+		glVertexAttribPointer(attribute_v_morph, 4, GL_FLOAT, GL_FALSE, 0, 0);
+		glEnableVertexAttribArray(attribute_v_morph);
+	}
+}
+
+
+/* Send the uniforms that decode the current vertex format */
+void terrain_object::sendFormatUniforms()
+{
+	glUniform1ui(vertex_format_id, vertex_format);
+	if (vertex_format == TERRAIN_FORMAT_HEIGHT16)
+	{
+		glUniform1ui(grid_columns_id, zsize);
+		glUniform4fv(grid_decode_id, 1, &grid_decode[0]);
+		glUniform2fv(height_decode_id, 1, &height_decode[0]);
+	}
+	else if (vertex_format == TERRAIN_FORMAT_DISPLACED)
+	{
+		// R32F textures hold the heights themselves
+		vec2 decode = displacement_float ? vec2(0, 1) : height_decode;
+		glUniform4fv(grid_decode_id, 1, &grid_decode[0]);
+		glUniform2fv(height_decode_id, 1, &decode[0]);
+		glUniform1ui(patch_quads_id, displacement_patch);
+		glUniform1ui(patch_columns_id, patchColumns());
+		glUniform1i(height_map_id, 1);
+		glUniform1i(normal_map_id, 2);
+		glUniform1i(colour_map_id, 3);
+	}
+}
+
+
+/* Draw the object with the vertex layout recorded in our VAO by createObject() */
+void terrain_object::drawObject(int drawmode)
+{
+	GLint previous_vao;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous_vao);
+	glBindVertexArray(vao);
+	sendFormatUniforms();
+
+	// Enable this line to show model in wireframe
+	if (drawmode == 1)
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	else
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	/* Draw the whole terrain in one call, either as instances of the displaced patch,
+	   a triangle list or triangle strips separated by the restart index */
+	if (vertex_format == TERRAIN_FORMAT_DISPLACED)
+	{
+		// Textures on units 1 to 3, leaving unit 0 to the application
+		GLuint textures[] = { tex_height, tex_normal, tex_colour };
+		for (int t = 0; t < 3; t++)
+		{
+			glActiveTexture(GL_TEXTURE1 + t);
+			glBindTexture(GL_TEXTURE_2D, textures[t]);
+		}
+		glActiveTexture(GL_TEXTURE0);
+		glDrawElementsInstanced(GL_TRIANGLES, num_patch_elements, GL_UNSIGNED_SHORT, (GLvoid*)0, patchColumns() * patchRows());
+	}
+	else if (triangle_list)
+	{
+		glDrawElements(GL_TRIANGLES, (GLsizei)elements.size(), GL_UNSIGNED_INT, (GLvoid*)0);
+	}
+	else
+	{
+		glEnable(GL_PRIMITIVE_RESTART);
+		glPrimitiveRestartIndex(TERRAIN_RESTART_INDEX);
+		glDrawElements(GL_TRIANGLE_STRIP, (GLsizei)elements.size(), GL_UNSIGNED_INT, (GLvoid*)0);
+		glDisable(GL_PRIMITIVE_RESTART);
+	}
+	draw_calls++;
+
+	// Other objects drawn with this shader use float attributes
+	glUniform1ui(vertex_format_id, TERRAIN_FORMAT_FLOAT);
+	glBindVertexArray(previous_vao);
+}
+
+
+/* Prepare the LOD quadtree. Call after createObject().
+   leaf_quads is the number of quads along the side of a patch, every level doubles
+   the vertex stride of the patch so one patch covers four patches of the level below.
+   (xsize - 1) and (zsize - 1) must be multiples of leaf_quads, e.g. grids of 129, 257,
+   513 or 1025 vertices. base_range is the eye distance drawn at full resolution,
+   0 picks twice the size of a leaf patch. Returns false if the grid can't be split */
+bool terrain_object::enableLOD(GLuint leaf_quads, GLfloat base_range)
+{
+	GLuint xquads = xsize - 1;
+	GLuint zquads = zsize - 1;
+	if (leaf_quads < 2 || leaf_quads % 2 || xquads % leaf_quads || zquads % leaf_quads)
+	{
+		cout << "terrain_object::enableLOD: grid of " << xsize << " x " << zsize
+			<< " vertices can't be split into patches of " << leaf_quads << " quads" << endl;
+		return false;
+	}
+
+	/* Add levels while the grid still divides into whole patches */
+	lod_leaf = leaf_quads;
+	lod_levels = 1;
+	while (lod_levels < 10 && xquads % (leaf_quads << lod_levels) == 0 && zquads % (leaf_quads << lod_levels) == 0)
+		lod_levels++;
+
+	/* Eye distance covered by each level, doubling with each level */
+	GLfloat spacing = length(vertices[xsize] - vertices[0]);
+	if (base_range <= 0) base_range = 2.f * leaf_quads * spacing;
+	lod_ranges.resize(lod_levels);
+	for (GLuint level = 0; level < lod_levels; level++)
+		lod_ranges[level] = base_range * GLfloat(1 << level);
+
+	/* Minimum and maximum height of every node, built up from the leaves */
+	lod_height_range.resize(lod_levels);
+	for (GLuint level = 0; level < lod_levels; level++)
+		lod_height_range[level].resize((xquads / (leaf_quads << level)) * (zquads / (leaf_quads << level)));
+	updateLODHeights(0, 0, xsize, zsize);
+
+	vector<vec4> morph(xsize * zsize);
+	for (GLuint r = 0; r < xsize; r++)
+		for (GLuint c = 0; c < zsize; c++)
+			morph[r * zsize + c] = morphTarget(r, c);
+
+	/* Add the morph targets to our VAO */
+	GLint previous_vao;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous_vao);
+	glBindVertexArray(vao);
+
+	if (!vbo_mesh_morph) glGenBuffers(1, &vbo_mesh_morph);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_morph);
+	glBufferData(GL_ARRAY_BUFFER, morph.size() * sizeof(vec4), &morph[0], GL_STATIC_DRAW);
+	bindAttributes();
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	/* One patch index buffer per level, relative to the top left vertex of the patch
+	   (added as the base vertex when drawing). The quads are stored as four quadrant
+	   blocks so a single quadrant of a patch can be drawn on its own */
+	if (!ibo_lod_elements.empty()) glDeleteBuffers((GLsizei)ibo_lod_elements.size(), &ibo_lod_elements[0]);
+	ibo_lod_elements.resize(lod_levels);
+	glGenBuffers(lod_levels, &ibo_lod_elements[0]);
+	GLuint half = leaf_quads / 2;
+	for (GLuint level = 0; level < lod_levels; level++)
+	{
+		GLuint s = 1 << level;
+		vector<GLuint> patch;
+		patch.reserve(leaf_quads * leaf_quads * 6);
+		for (GLuint q = 0; q < 4; q++)
+		{
+			for (GLuint i = (q / 2) * half; i < (q / 2 + 1) * half; i++)
+			{
+				for (GLuint j = (q % 2) * half; j < (q % 2 + 1) * half; j++)
+				{
+					GLuint top = i * s * zsize + j * s;
+					GLuint bottom = top + s * zsize;
+					patch.push_back(top);
+					patch.push_back(bottom);
+					patch.push_back(top + s);
+					patch.push_back(top + s);
+					patch.push_back(bottom + s);
+					patch.push_back(bottom);
+				}
+			}
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_lod_elements[level]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, patch.size() * sizeof(GLuint), &patch[0], GL_STATIC_DRAW);
+	}
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_mesh_elements);
+	glBindVertexArray(previous_vao);
+
+	lod_enabled = true;
+	return true;
+}
+
+
+/* Recalculate the minimum and maximum height of the LOD nodes that contain any of the
+   vertices in rows row0 to row1, columns col0 to col1 (end exclusive).
+   Leaf nodes are calculated from the vertices, their parents from the children */
+void terrain_object::updateLODHeights(GLuint row0, GLuint col0, GLuint row1, GLuint col1)
+{
+	for (GLuint level = 0; level < lod_levels; level++)
+	{
+		GLuint node_quads = lod_leaf << level;
+		GLuint rows = (xsize - 1) / node_quads;
+		GLuint cols = (zsize - 1) / node_quads;
+
+		// Vertices on a node border belong to the nodes on both sides
+		GLuint nr0 = (row0 > 0) ? (row0 - 1) / node_quads : 0;
+		GLuint nc0 = (col0 > 0) ? (col0 - 1) / node_quads : 0;
+		GLuint nr1 = std::min((row1 - 1) / node_quads + 1, rows);
+		GLuint nc1 = std::min((col1 - 1) / node_quads + 1, cols);
+
+		for (GLuint nr = nr0; nr < nr1; nr++)
+		{
+			for (GLuint nc = nc0; nc < nc1; nc++)
+			{
+				vec2 range(vertices[nr * node_quads * zsize + nc * node_quads].y);
+				if (level == 0)
+				{
+					for (GLuint r = nr * node_quads; r <= (nr + 1) * node_quads; r++)
+					{
+						for (GLuint c = nc * node_quads; c <= (nc + 1) * node_quads; c++)
+						{
+							range.x = std::min(range.x, vertices[r * zsize + c].y);
+							range.y = std::max(range.y, vertices[r * zsize + c].y);
+						}
+					}
+				}
+				else
+				{
+					GLuint child_cols = cols * 2;
+					for (GLuint q = 0; q < 4; q++)
+					{
+						vec2 child = lod_height_range[level - 1][(nr * 2 + q / 2) * child_cols + nc * 2 + q % 2];
+						range.x = std::min(range.x, child.x);
+						range.y = std::max(range.y, child.y);
+					}
+				}
+				lod_height_range[level][nr * cols + nc] = range;
+			}
+		}
+	}
+}
+
+
+/* Morph target of vertex (r, c). A vertex first appears at the coarsest level whose
+   stride divides both its row and column. At the level below that it sits halfway
+   along an edge (or the diagonal) of the coarser grid, so it morphs to the midpoint
+   of that edge. The diagonal matches the (r+1, c) to (r, c+1) split of the patch quads.
+   w holds the level at which the vertex morphs, 255 if it never does */
+vec4 terrain_object::morphTarget(GLuint r, GLuint c)
+{
+	GLuint v = r * zsize + c;
+	GLuint level = 0;
+	while (level + 1 < lod_levels && r % (2u << level) == 0 && c % (2u << level) == 0)
+		level++;
+
+	GLuint s = 1 << level;
+	bool odd_r = (r / s) % 2 == 1;
+	bool odd_c = (c / s) % 2 == 1;
+	if (level + 1 == lod_levels || (!odd_r && !odd_c))
+		return vec4(vertices[v], 255.f);
+	else if (odd_r && odd_c)
+		return vec4((vertices[(r - s) * zsize + c + s] + vertices[(r + s) * zsize + c - s]) * 0.5f, GLfloat(level));
+	else if (odd_r)
+		return vec4((vertices[(r - s) * zsize + c] + vertices[(r + s) * zsize + c]) * 0.5f, GLfloat(level));
+	else
+		return vec4((vertices[r * zsize + c - s] + vertices[r * zsize + c + s]) * 0.5f, GLfloat(level));
+}
+
+
+/* Uniform locations in the terrain shader for the patch level, the morph
+   start/end distances of that level and the eye position */
+void terrain_object::setLODUniforms(GLuint lod_level, GLuint morph_range, GLuint eye)
+{
+	lod_level_id = lod_level;
+	morph_range_id = morph_range;
+	lod_eye_id = eye;
+}
+
+
+/* Draw one patch (quadrant = -1) or one quadrant of a patch at a level */
+void terrain_object::drawLODNode(GLuint level, GLuint nr, GLuint nc, int quadrant)
+{
+	GLuint node_quads = lod_leaf << level;
+	GLint base_vertex = nr * node_quads * zsize + nc * node_quads;
+	GLuint count = lod_leaf * lod_leaf * 6;
+	GLuint first = 0;
+	if (quadrant >= 0)
+	{
+		count /= 4;
+		first = quadrant * count;
+	}
+
+	/* Vertices of this level morph over the last 30% of its range */
+	GLfloat range_start = (level > 0) ? lod_ranges[level - 1] : 0;
+	GLfloat morph_end = lod_ranges[level];
+	GLfloat morph_start = morph_end - (morph_end - range_start) * 0.3f;
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_lod_elements[level]);
+	glUniform1i(lod_level_id, level);
+	glUniform2f(morph_range_id, morph_start, morph_end);
+	glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, (GLvoid*)(first * sizeof(GLuint)), base_vertex);
+
+	lod_triangles += count / 3;
+	lod_draw_calls++;
+	draw_calls++;
+}
+
+
+/* Quadtree selection: returns false if the node is out of range of its level
+   (the parent then draws that area itself), otherwise draws the node or its children */
+bool terrain_object::selectLODNode(GLuint level, GLuint nr, GLuint nc, vec3 eye)
+{
+	GLuint node_quads = lod_leaf << level;
+	GLuint cols = (zsize - 1) / node_quads;
+	vec2 heights = lod_height_range[level][nr * cols + nc];
+	vec3 corner0 = vertices[nr * node_quads * zsize + nc * node_quads];
+	vec3 corner1 = vertices[(nr + 1) * node_quads * zsize + (nc + 1) * node_quads];
+	vec3 box_min(std::min(corner0.x, corner1.x), heights.x, std::min(corner0.z, corner1.z));
+	vec3 box_max(std::max(corner0.x, corner1.x), heights.y, std::max(corner0.z, corner1.z));
+
+	// Distance from the eye to the node bounding box
+	GLfloat distance = length(clamp(eye, box_min, box_max) - eye);
+
+	if (distance > lod_ranges[level]) return false;
+
+	if (level == 0 || distance > lod_ranges[level - 1])
+	{
+		drawLODNode(level, nr, nc, -1);
+		return true;
+	}
+
+	for (GLuint q = 0; q < 4; q++)
+	{
+		if (!selectLODNode(level - 1, nr * 2 + q / 2, nc * 2 + q % 2, eye))
+			drawLODNode(level, nr, nc, q);
+	}
+	return true;
+}
+
+
+/* Draw the terrain with level of detail. Falls back to drawObject() if enableLOD()
+   has not succeeded */
+void terrain_object::drawObjectLOD(int drawmode, vec3 eye)
+{
+	// The displaced patches are all drawn at one resolution
+	if (!lod_enabled || vertex_format == TERRAIN_FORMAT_DISPLACED)
+	{
+		drawObject(drawmode);
+		return;
+	}
+
+	GLint previous_vao;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous_vao);
+	glBindVertexArray(vao);
+	sendFormatUniforms();
+
+	// Enable this line to show model in wireframe
+	if (drawmode == 1)
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	else
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	glUniform3fv(lod_eye_id, 1, &eye[0]);
+	lod_triangles = 0;
+	lod_draw_calls = 0;
+
+	/* The coarsest level patches are the roots of the quadtree, they are always drawn */
+	GLuint root_quads = lod_leaf << (lod_levels - 1);
+	GLuint root_level = lod_levels - 1;
+	for (GLuint nr = 0; nr < (xsize - 1) / root_quads; nr++)
+	{
+		for (GLuint nc = 0; nc < (zsize - 1) / root_quads; nc++)
+		{
+			if (!selectLODNode(root_level, nr, nc, eye))
+				drawLODNode(root_level, nr, nc, -1);
+		}
+	}
+
+	// Switch morphing and format decoding off again for anything else drawn with this shader
+	glUniform2f(morph_range_id, 0, 0);
+	glUniform1ui(vertex_format_id, TERRAIN_FORMAT_FLOAT);
+
+	// Put back the element buffer used by drawObject()
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_mesh_elements);
+	glBindVertexArray(previous_vao);
+}
+
+
+/* Print the triangles and draw calls of the last LOD frame against the full resolution strips */
+void terrain_object::printLODStats()
+{
+	GLuint full_triangles = (xsize - 1) * (zsize - 1) * 2;
+	printf("\nterrain_object LOD: %u levels of %u x %u quad patches\n", lod_levels, lod_leaf, lod_leaf);
+	printf("  full resolution: %8u triangles, 1 draw call\n", full_triangles);
+	printf("  LOD:             %8u triangles (%.1f%%), %u draw calls\n",
+		lod_triangles, 100.f * lod_triangles / full_triangles, lod_draw_calls);
+}
+
+
+/* Define the terrian heights */
+/* Uses code adapted from OpenGL Shading Language Cookbook: Chapter 8 */
+/* The octave sums are computed by noise_engine, which splits the rows across threads
+   and evaluates several samples at once with SSE/AVX while giving the same values as
+   calling glm::perlin() for each sample */
+void terrain_object::calculateNoise()
+{
+	/* Create the array to store the noise values */
+	/* The size is the number of vertices, or the number of vertices * number of octaves
+	   when we are keeping every octave */
+	GLuint noise_stride = keep_octaves ? perlin_octaves : 1;
+	if (noise) delete[] noise;
+	noise = new GLfloat[xsize * zsize * noise_stride];
+
+	GLfloat xfactor = 1.f / (xsize - 1);
+	GLfloat zfactor = 1.f / (zsize - 1);
+
+	noise_engine engine(perlin_octaves, perlin_freq, perlin_scale);
+	engine.setKeepOctaves(keep_octaves);
+	engine.generate(noise, xsize, zsize, 0, 0, xfactor, zfactor);
+}
+
+/* Define the vertex array that specifies the terrain
+   (xp, zp) specifies the pixel dimensions of the heightfield (x * y) vertices
+   (xs, ys) specifies the size of the heightfield region in world coords
+   */
+void terrain_object::createTerrain(GLuint xp, GLuint zp, GLfloat xs, GLfloat zs, GLfloat sealevel)
+{
+	xsize = xp;
+	zsize = zp;
+	width = xs;
+	height = zs;
+
+	/* Scale heights in relation to the terrain size */
+	height_scale = xs*4.f;
+
+	/* Create array of vertices */
+	GLuint numvertices = xsize * zsize;
+	vertices = new vec3[numvertices];
+	normals  = new vec3[numvertices];
+	colours = new vec3[numvertices];
+
+	/* First calculate the noise array which we'll use for our vertex height values */
+	calculateNoise();
+
+	/* Define starting (x,z) positions and the step changes */
+	GLfloat xpos = -width / 2.f;
+	GLfloat xpos_step = width / GLfloat(xp);
+	GLfloat zpos_step = height / GLfloat(zp);
+	GLfloat zpos_start = -height / 2.f;
+
+	/* Define the vertex positions for a flat surface */
+	/* Set the normals to zero */
+	/* Note, for a flat surface, set the normals to (0, 1, 0) but we don't do that because
+	   that will affect the true normal calculation in the next step */
+	GLuint noise_stride = keep_octaves ? perlin_octaves : 1;
+	for (GLuint row = 0; row < zsize; row++)
+	{
+		GLfloat zpos = zpos_start;
+		for (GLuint col = 0; col < zsize; col++)
+		{
+			// The height is the noise sum after the last octave
+			GLfloat height = noise[(row * xsize + col) * noise_stride + noise_stride - 1];
+			vertices[row * xsize + col] = vec3(xpos, (height - 0.5f) * height_scale, zpos);
+
+			// Zero the normal, it gets calculated at the end of this method after all the vertex positions
+			// have been set.
+			normals[row * xsize + col] = vec3(0, 0.0f, 0);
+			zpos += zpos_step;
+		}
+		xpos += xpos_step;
+	}
+
+	// The noise values are now in the vertex array so we don't need them any more
+	if (!keep_octaves)
+	{
+		delete[] noise;
+		noise = NULL;
+	}
+
+
+	createElements();
+
+	// Define the range of terrina heights
+	height_max = xs / 8.f;
+	height_min = -height_max;
+
+	// Stretch the height values to a defined height range 
+	stretchToRange(height_min, height_max);
+
+	defineSeaLevel(sealevel);
+
+	// Calculate the normals from the height differences around each vertex
+	calculateNormals();
+}
+
+/* Define the element indices */
+void terrain_object::createElements()
+{
+	elements.clear();
+	if (triangle_list)
+	{
+		/* Sweep the quads row by row within narrow column bands so the vertices
+		   shared with the previous row are still in the post-transform cache */
+		elements.reserve((xsize - 1) * (zsize - 1) * 6);
+		for (GLuint z0 = 0; z0 < zsize - 1; z0 += TERRAIN_CACHE_BAND)
+		{
+			GLuint z1 = std::min(z0 + TERRAIN_CACHE_BAND, zsize - 1);
+			for (GLuint x = 0; x < xsize - 1; x++)
+			{
+				for (GLuint z = z0; z < z1; z++)
+				{
+					GLuint top = x * zsize + z;
+					GLuint bottom = top + zsize;
+					elements.push_back(top);
+					elements.push_back(bottom);
+					elements.push_back(top + 1);
+					elements.push_back(top + 1);
+					elements.push_back(bottom);
+					elements.push_back(bottom + 1);
+				}
+			}
+		}
+	}
+	else
+	{
+		/* Triangle strips, one per row, joined with the primitive restart index */
+		elements.reserve((xsize - 1) * (zsize * 2 + 1));
+		for (GLuint x = 0; x < xsize - 1; x++)
+		{
+			GLuint top    = x * zsize;
+			GLuint bottom = top + zsize;
+			for (GLuint z = 0; z < zsize; z++)
+			{
+				elements.push_back(top++);
+				elements.push_back(bottom++);
+			}
+			if (x < xsize - 2) elements.push_back(TERRAIN_RESTART_INDEX);
+		}
+	}
+}
+
+
+/* Create the terrain from a 16 bit heightmap instead of noise, see heightmap.h.
+   The heightmap is resampled bilinearly to xp x zp vertices; vertex row r reads the
+   two heightmap rows around it, so only the vertex arrays and two rows of samples
+   are held at once and heightmap rows are released as soon as they are passed.
+   Heights 0 to 65535 map to 0 to height_range in world units */
+bool terrain_object::createTerrainFromHeightmap(const char* path, GLuint xp, GLuint zp, GLfloat xs, GLfloat zs,
+	GLfloat height_range, GLfloat sealevel)
+{
+	heightmap map;
+	if (!map.open(path) || map.width < 2 || map.height < 2 || xp < 2 || zp < 2) return false;
+
+	if (vertices) delete[] vertices;
+	if (normals) delete[] normals;
+	if (colours) delete[] colours;
+	if (noise) delete[] noise;
+	noise = NULL;
+
+	xsize = xp;
+	zsize = zp;
+	width = xs;
+	height = zs;
+	height_scale = height_range;
+
+	GLuint numvertices = xsize * zsize;
+	vertices = new vec3[numvertices];
+	normals = new vec3[numvertices];
+	colours = new vec3[numvertices];
+
+	/* Same vertex layout as createTerrain() */
+	GLfloat xpos = -width / 2.f;
+	GLfloat xpos_step = width / GLfloat(xp);
+	GLfloat zpos_step = height / GLfloat(zp);
+	GLfloat zpos_start = -height / 2.f;
+
+	// Heightmap column and weight of every vertex column
+	vector<GLuint> src_col(zsize);
+	vector<GLfloat> col_t(zsize);
+	for (GLuint col = 0; col < zsize; col++)
+	{
+		GLfloat fx = GLfloat(col) * GLfloat(map.width - 1) / GLfloat(zsize - 1);
+		src_col[col] = std::min(GLuint(fx), map.width - 2);
+		col_t[col] = fx - GLfloat(src_col[col]);
+	}
+
+	vector<GLushort> row_a(map.width), row_b(map.width);
+	GLint loaded_a = -1, loaded_b = -1;
+	GLfloat to_world = height_range / 65535.f;
+
+	height_min = height_max = 0;
+	for (GLuint row = 0; row < xsize; row++)
+	{
+		GLfloat fy = GLfloat(row) * GLfloat(map.height - 1) / GLfloat(xsize - 1);
+		GLint y0 = std::min(GLint(fy), GLint(map.height) - 2);
+		GLfloat row_t = fy - GLfloat(y0);
+
+		// Rows are read in increasing order, reuse the second row of the last pair
+		if (loaded_b == y0) { swap(row_a, row_b); loaded_a = y0; }
+		if (loaded_a != y0) { map.readRow(y0, &row_a[0]); loaded_a = y0; }
+		if (loaded_b != y0 + 1) { map.readRow(y0 + 1, &row_b[0]); loaded_b = y0 + 1; }
+		map.releaseRows(0, y0);
+
+		GLfloat zpos = zpos_start;
+		for (GLuint col = 0; col < zsize; col++)
+		{
+			GLuint c = src_col[col];
+			GLfloat t = col_t[col];
+			GLfloat top = row_a[c] + (row_a[c + 1] - row_a[c]) * t;
+			GLfloat bottom = row_b[c] + (row_b[c + 1] - row_b[c]) * t;
+			GLfloat y = (top + (bottom - top) * row_t) * to_world;
+
+			vertices[row * zsize + col] = vec3(xpos, y, zpos);
+			normals[row * zsize + col] = vec3(0, 0.0f, 0);
+			if (row == 0 && col == 0) height_min = height_max = y;
+			height_min = std::min(height_min, y);
+			height_max = std::max(height_max, y);
+			zpos += zpos_step;
+		}
+		xpos += xpos_step;
+	}
+	map.close();
+
+	createElements();
+	defineSeaLevel(sealevel);
+	calculateNormals();
+	return true;
+}
+
+
+/* Binary terrain cache file: this header followed by the vertices, normals and
+   colours (num_vertices vec3 each) and the elements (num_elements GLuint).
+   Bump TERRAIN_CACHE_VERSION whenever the generated terrain or the layout changes */
+const GLuint TERRAIN_CACHE_VERSION = 2;
+
+struct terrain_cache_header
+{
+	char magic[8];
+	GLuint version;
+
+	// Key: the parameters the terrain was generated from
+	GLuint octaves;
+	GLfloat freq, scale;
+	GLuint xsize, zsize;
+	GLfloat width, height, sealevel;
+	GLuint triangle_list;
+	GLuint colours;		// Hash of the colour seed and ramp
+
+	GLfloat height_scale, height_min, height_max;
+	GLuint num_vertices;
+	GLuint num_elements;
+};
+
+/* Fill in the parts of the header that identify the terrain */
+static void cacheKey(terrain_cache_header& h, GLuint octaves, GLfloat freq, GLfloat scale,
+	GLuint xp, GLuint zp, GLfloat xs, GLfloat zs, GLfloat sealevel, bool triangle_list)
+{
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, "TERRAIN", 8);
+	h.version = TERRAIN_CACHE_VERSION;
+	h.octaves = octaves;
+	h.freq = freq;
+	h.scale = scale;
+	h.xsize = xp;
+	h.zsize = zp;
+	h.width = xs;
+	h.height = zs;
+	h.sealevel = sealevel;
+	h.triangle_list = triangle_list;
+}
+
+/* Cache file name: FNV-1a hash of the key fields */
+static void cachePath(char* path, size_t size, const terrain_cache_header& key, const char* cache_dir)
+{
+	GLuint hash = 2166136261u;
+	const unsigned char* k = (const unsigned char*)&key;
+	for (size_t i = 0; i < offsetof(terrain_cache_header, height_scale); i++)
+		hash = (hash ^ k[i]) * 16777619u;
+
+	snprintf(path, size, "%s%sterrain_%08x.cache", cache_dir ? cache_dir : "", cache_dir ? "/" : "", hash);
+}
+
+
+/* createTerrain() followed by setColourBasedOnHeight(), or the same terrain loaded
+   from a cache file made by an earlier run. The file name is a hash of the terrain
+   parameters, in cache_dir or the working directory if that is NULL.
+   Returns true if the terrain came from the cache */
+bool terrain_object::createTerrainCached(GLuint xp, GLuint zp, GLfloat xs, GLfloat zs, GLfloat sealevel, const char* cache_dir)
+{
+	terrain_cache_header key;
+	char path[1024];
+	cacheFile(key, path, sizeof(path), xp, zp, xs, zs, sealevel, cache_dir);
+
+	if (loadCache(path, key)) return true;
+
+	createTerrain(xp, zp, xs, zs, sealevel);
+	setColourBasedOnHeight();
+	if (!saveCache(path))
+		cout << "terrain_object: could not write the terrain cache " << path << endl;
+	return false;
+}
+
+
+/* Key and file name of the cache createTerrainCached() uses for this terrain */
+void terrain_object::cacheFile(terrain_cache_header& key, char* path, size_t size,
+	GLuint xp, GLuint zp, GLfloat xs, GLfloat zs, GLfloat sealevel, const char* cache_dir)
+{
+	cacheKey(key, perlin_octaves, perlin_freq, perlin_scale, xp, zp, xs, zs, sealevel, triangle_list);
+	key.colours = colourKey();
+	cachePath(path, size, key, cache_dir);
+}
+
+
+/* FNV-1a hash of everything the colours depend on besides the heights */
+GLuint terrain_object::colourKey()
+{
+	GLuint hash = 2166136261u;
+	vector<GLuint> words;
+	words.push_back(colour_seed);
+	words.push_back(ramp_height_steps);
+	words.push_back(ramp_slope_steps);
+	words.resize(words.size() + 1 + colour_ramp.size() * 4);
+	memcpy(&words[3], &ramp_jitter, sizeof(GLfloat));
+	if (!colour_ramp.empty()) memcpy(&words[4], &colour_ramp[0], colour_ramp.size() * sizeof(vec4));
+	for (size_t i = 0; i < words.size(); i++)
+		hash = (hash ^ words[i]) * 16777619u;
+	return hash;
+}
+
+
+/* Write the finished terrain to a cache file */
+bool terrain_object::saveCache(const char* path)
+{
+	terrain_cache_header header;
+	cacheKey(header, perlin_octaves, perlin_freq, perlin_scale, xsize, zsize, width, height, sealevel, triangle_list);
+	header.colours = colourKey();
+	header.height_scale = height_scale;
+	header.height_min = height_min;
+	header.height_max = height_max;
+	header.num_vertices = xsize * zsize;
+	header.num_elements = (GLuint)elements.size();
+
+	FILE* f = fopen(path, "wb");
+	if (!f) return false;
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+	ok = ok && fwrite(vertices, sizeof(vec3), header.num_vertices, f) == header.num_vertices;
+	ok = ok && fwrite(normals, sizeof(vec3), header.num_vertices, f) == header.num_vertices;
+	ok = ok && fwrite(colours, sizeof(vec3), header.num_vertices, f) == header.num_vertices;
+	ok = ok && fwrite(&elements[0], sizeof(GLuint), header.num_elements, f) == header.num_elements;
+	ok = (fclose(f) == 0) && ok;
+
+	// Don't leave a partial file behind for the next run
+	if (!ok) remove(path);
+	return ok;
+}
+
+
+/* Load a terrain written by saveCache() if its key matches.
+   The file is memory mapped and the arrays copied straight out of the mapping */
+bool terrain_object::loadCache(const char* path, const terrain_cache_header& key)
+{
+	mapped_file file;
+	if (!file.open(path) || file.size() < sizeof(terrain_cache_header)) return false;
+
+	terrain_cache_header header;
+	memcpy(&header, file.data(), sizeof(header));
+	if (memcmp(&header, &key, offsetof(terrain_cache_header, height_scale)) != 0) return false;
+
+	size_t numvertices = header.num_vertices;
+	if (numvertices != size_t(header.xsize) * header.zsize) return false;
+	size_t expected = sizeof(header) + 3 * numvertices * sizeof(vec3) + size_t(header.num_elements) * sizeof(GLuint);
+	if (file.size() != expected) return false;
+
+	if (vertices) delete[] vertices;
+	if (normals) delete[] normals;
+	if (colours) delete[] colours;
+
+	xsize = header.xsize;
+	zsize = header.zsize;
+	width = header.width;
+	height = header.height;
+	sealevel = header.sealevel;
+	height_scale = header.height_scale;
+	height_min = header.height_min;
+	height_max = header.height_max;
+
+	const unsigned char* p = file.data() + sizeof(header);
+	vertices = new vec3[numvertices];
+	normals = new vec3[numvertices];
+	colours = new vec3[numvertices];
+	memcpy(vertices, p, numvertices * sizeof(vec3));
+	p += numvertices * sizeof(vec3);
+	memcpy(normals, p, numvertices * sizeof(vec3));
+	p += numvertices * sizeof(vec3);
+	memcpy(colours, p, numvertices * sizeof(vec3));
+	p += numvertices * sizeof(vec3);
+	elements.assign((const GLuint*)p, (const GLuint*)p + header.num_elements);
+
+	colour_by_height = true;
+	return true;
+}
+
+
+/* Calculate the normals of the whole grid */
+void terrain_object::calculateNormals()
+{
+	calculateNormals(0, 0, xsize, zsize);
+}
+
+
+/* Calculate normals from the heights with central differences.
+   Because the terrain is a regular grid the normal at (row, col) only depends on the
+   heights of its four neighbours: with the height differences across the vertex along
+   x (rows) and z (columns) the tangents are (xspan, dy_x, 0) and (0, dy_z, zspan) and
+   their cross product is (-dy_x * zspan, xspan * zspan, -dy_z * xspan).
+   Border vertices use a one sided difference.
+
+   row0, col0, row1, col1 is the rectangle of heights that changed (end exclusive).
+   The normals are recalculated one vertex beyond it because the neighbours use
+   those heights too. Bands of rows are calculated on separate threads */
+void terrain_object::calculateNormals(GLuint row0, GLuint col0, GLuint row1, GLuint col1)
+{
+	row0 = (row0 > 0) ? row0 - 1 : 0;
+	col0 = (col0 > 0) ? col0 - 1 : 0;
+	row1 = std::min(row1 + 1, xsize);
+	col1 = std::min(col1 + 1, zsize);
+	if (row0 >= row1 || col0 >= col1) return;
+
+	GLuint rows = row1 - row0;
+	GLuint threads = thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	// Small edits aren't worth the threads
+	const GLuint min_vertices_per_thread = 64 * 1024;
+	GLuint max_threads = rows * (col1 - col0) / min_vertices_per_thread;
+	if (threads > max_threads) threads = max_threads;
+	if (threads > rows) threads = rows;
+	if (threads < 2)
+	{
+		normalRows(row0, row1, col0, col1);
+		return;
+	}
+
+	vector<thread> workers;
+	GLuint band = (rows + threads - 1) / threads;
+	for (GLuint start = row0; start < row1; start += band)
+	{
+		GLuint end = std::min(start + band, row1);
+		workers.push_back(thread(&terrain_object::normalRows, this, start, end, col0, col1));
+	}
+	for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+}
+
+
+/* Central difference normal of one vertex, see calculateNormals() */
+vec3 terrain_object::gridNormal(GLuint row, GLuint col)
+{
+	GLuint rp = (row > 0) ? row - 1 : row;
+	GLuint rn = (row < xsize - 1) ? row + 1 : row;
+	GLuint cp = (col > 0) ? col - 1 : col;
+	GLuint cn = (col < zsize - 1) ? col + 1 : col;
+
+	GLfloat xspan = vertices[rn * zsize].x - vertices[rp * zsize].x;
+	GLfloat zspan = vertices[cn].z - vertices[cp].z;
+	GLfloat dy_x = vertices[rp * zsize + col].y - vertices[rn * zsize + col].y;
+	GLfloat dy_z = vertices[row * zsize + cp].y - vertices[row * zsize + cn].y;
+
+	return normalize(vec3(dy_x * zspan, xspan * zspan, dy_z * xspan));
+}
+
+
+/* Normals for rows row_start to row_end, columns col0 to col1.
+   The interior columns are done four at a time with SSE using the same operations
+   in the same order as gridNormal() and glm::normalize, so the results are identical */
+void terrain_object::normalRows(GLuint row_start, GLuint row_end, GLuint col0, GLuint col1)
+{
+	for (GLuint row = row_start; row < row_end; row++)
+	{
+		GLuint col = col0;
+
+#if TERRAIN_SIMD
+		GLuint rp = (row > 0) ? row - 1 : row;
+		GLuint rn = (row < xsize - 1) ? row + 1 : row;
+		const vec3* above = vertices + rp * zsize;
+		const vec3* here = vertices + row * zsize;
+		const vec3* below = vertices + rn * zsize;
+		__m128 xspan = _mm_set1_ps(below[0].x - above[0].x);
+
+		// Column 0 and the last column have one sided differences, do them as scalars
+		if (col == 0)
+		{
+			normals[row * zsize] = gridNormal(row, 0);
+			col++;
+		}
+		for (; col + 4 < zsize && col + 4 <= col1; col += 4)
+		{
+			__m128 zspan = _mm_setr_ps(here[col + 1].z - here[col - 1].z, here[col + 2].z - here[col].z,
+				here[col + 3].z - here[col + 1].z, here[col + 4].z - here[col + 2].z);
+			__m128 dy_x = _mm_sub_ps(_mm_setr_ps(above[col].y, above[col + 1].y, above[col + 2].y, above[col + 3].y),
+				_mm_setr_ps(below[col].y, below[col + 1].y, below[col + 2].y, below[col + 3].y));
+			__m128 dy_z = _mm_sub_ps(_mm_setr_ps(here[col - 1].y, here[col].y, here[col + 1].y, here[col + 2].y),
+				_mm_setr_ps(here[col + 1].y, here[col + 2].y, here[col + 3].y, here[col + 4].y));
+
+			__m128 nx = _mm_mul_ps(dy_x, zspan);
+			__m128 ny = _mm_mul_ps(xspan, zspan);
+			__m128 nz = _mm_mul_ps(dy_z, xspan);
+			__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz));
+			__m128 inv = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(len2));
+
+			float x[4], y[4], z[4];
+			_mm_storeu_ps(x, _mm_mul_ps(nx, inv));
+			_mm_storeu_ps(y, _mm_mul_ps(ny, inv));
+			_mm_storeu_ps(z, _mm_mul_ps(nz, inv));
+			for (int i = 0; i < 4; i++)
+				normals[row * zsize + col + i] = vec3(x[i], y[i], z[i]);
+		}
+#endif
+		for (; col < col1; col++)
+			normals[row * zsize + col] = gridNormal(row, col);
+	}
+}
+
+
+/* Stretch the height values to the range min to max */
+void terrain_object::stretchToRange(GLfloat min, GLfloat max)
+{
+	/* Calculate min and max values */
+	GLfloat cmin, cmax;
+	cmin = cmax = vertices[0].y;
+	for (GLuint v = 1; v < xsize*zsize; v++)
+	{
+		if (vertices[v].y < cmin) cmin = vertices[v].y;
+		if (vertices[v].y > cmax) cmax = vertices[v].y;
+	}
+
+	// Calculate stretch factor
+	GLfloat stretch_factor = (max - min) / (cmax - cmin);
+	GLfloat stretch_diff = cmin - min;
+
+	/* Rescale the vertices */
+	for (GLuint v = 0; v < xsize*zsize; v++)
+	{
+		vertices[v].y = (vertices[v].y - stretch_diff) * stretch_factor;
+	}
+}
+
+
+/* Calculate terrian colours */
+void terrain_object::setColour(vec3 c)
+{
+	GLuint numVertices = xsize * zsize;
+
+	// Loop through all vertices, set colours
+	// You could set height relayed colout here if you want to or add in some random variationd
+	for (GLuint i = 0; i < numVertices; i++)
+	{
+		// Define a brown terrain colour
+		colours[i] = c;
+
+		// You could add code here to set the terrain colour based on vertex height or any other conditions
+
+	}
+
+}
+
+
+/* Define a sea level in the terrain */
+void terrain_object::defineSeaLevel(GLfloat s)
+{
+	sealevel = s;
+	for (int v = 0; v < xsize*zsize; v++)
+	{
+		if (vertices[v].y < sealevel)
+		{
+			vertices[v].y = sealevel;
+		}
+	}
+}
+
+
+/* Calculate terrian colours based on height with small random variations, or from
+   the colour ramp if one has been set. Large terrains are split across hardware threads */
+void terrain_object::setColourBasedOnHeight()
+{
+	GLuint numVertices = xsize * zsize;
+	GLuint threads = thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	const GLuint min_vertices_per_thread = 64 * 1024;
+	if (threads > numVertices / min_vertices_per_thread) threads = numVertices / min_vertices_per_thread;
+	if (threads < 2)
+	{
+		colourRange(0, numVertices);
+	}
+	else
+	{
+		vector<thread> workers;
+		GLuint band = (numVertices + threads - 1) / threads;
+		band = (band + 3) & ~3u;		// Keep the SIMD groups together
+		for (GLuint start = 0; start < numVertices; start += band)
+		{
+			workers.push_back(thread(&terrain_object::colourRange, this, start, std::min(start + band, numVertices)));
+		}
+		for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+	}
+
+	// Terrain edits recolour the vertices they change
+	colour_by_height = true;
+}
+
+
+/* Colour by height and slope from a lookup table instead of the fixed height bands.
+   table holds height_steps x slope_steps colours, table[slope * height_steps + h]:
+   h runs from the lowest to the highest vertex, slope from flat (0) to vertical.
+   Colours are interpolated bilinearly and their brightness varied randomly by up
+   to +-jitter/2. A NULL table goes back to the height bands.
+   Call setColourBasedOnHeight() afterwards to recolour the terrain */
+void terrain_object::setColourRamp(const vec3* table, GLuint height_steps, GLuint slope_steps, GLfloat jitter)
+{
+	colour_ramp.clear();
+	ramp_height_steps = ramp_slope_steps = 0;
+	ramp_jitter = jitter;
+	if (!table || height_steps == 0 || slope_steps == 0) return;
+
+	// Stored as vec4 so the SIMD path can load whole entries
+	colour_ramp.resize(height_steps * slope_steps);
+	for (GLuint i = 0; i < height_steps * slope_steps; i++)
+		colour_ramp[i] = vec4(table[i], 0);
+	ramp_height_steps = height_steps;
+	ramp_slope_steps = slope_steps;
+}
+
+
+/* Colour vertices first to last - 1 */
+void terrain_object::colourRange(GLuint first, GLuint last)
+{
+	if (colour_ramp.empty())
+	{
+		for (GLuint i = first; i < last; i++) colourVertex(i);
+		return;
+	}
+
+	GLfloat height_steps = GLfloat(ramp_height_steps - 1);
+	GLfloat slope_steps = GLfloat(ramp_slope_steps - 1);
+	GLfloat inv_range = 1.f / (height_max - height_min);
+	GLuint i = first;
+
+#if TERRAIN_SIMD
+	/* Four vertices at a time: the table coordinates and weights are computed in SSE
+	   lanes, each lane's four table entries are blended as one vector */
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 hmin = _mm_set1_ps(height_min);
+	const __m128 hinv = _mm_set1_ps(inv_range);
+	const __m128 hsteps = _mm_set1_ps(height_steps);
+	const __m128 ssteps = _mm_set1_ps(slope_steps);
+	const __m128i hlast = _mm_set1_epi32(ramp_height_steps - 1);
+	const __m128i slast = _mm_set1_epi32(ramp_slope_steps - 1);
+	for (; i + 4 <= last; i += 4)
+	{
+		__m128 y = _mm_setr_ps(vertices[i].y, vertices[i + 1].y, vertices[i + 2].y, vertices[i + 3].y);
+		__m128 ny = _mm_setr_ps(normals[i].y, normals[i + 1].y, normals[i + 2].y, normals[i + 3].y);
+
+		__m128 h = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(y, hmin), hinv), zero), one);
+		__m128 sl = _mm_min_ps(_mm_max_ps(_mm_sub_ps(one, ny), zero), one);
+		__m128 fh = _mm_mul_ps(h, hsteps);
+		__m128 fs = _mm_mul_ps(sl, ssteps);
+
+		// Coordinates are positive so truncation is floor; SSE2 has no 32 bit min
+		__m128i h0 = _mm_cvttps_epi32(fh);
+		__m128i s0 = _mm_cvttps_epi32(fs);
+		h0 = _mm_sub_epi32(h0, _mm_and_si128(_mm_cmpgt_epi32(h0, hlast), _mm_sub_epi32(h0, hlast)));
+		s0 = _mm_sub_epi32(s0, _mm_and_si128(_mm_cmpgt_epi32(s0, slast), _mm_sub_epi32(s0, slast)));
+		__m128 th = _mm_sub_ps(fh, _mm_cvtepi32_ps(h0));
+		__m128 ts = _mm_sub_ps(fs, _mm_cvtepi32_ps(s0));
+
+		GLint hi[4], si[4];
+		GLfloat thl[4], tsl[4];
+		_mm_storeu_si128((__m128i*)hi, h0);
+		_mm_storeu_si128((__m128i*)si, s0);
+		_mm_storeu_ps(thl, th);
+		_mm_storeu_ps(tsl, ts);
+
+		for (int l = 0; l < 4; l++)
+		{
+			GLuint h1 = std::min(GLuint(hi[l]) + 1, ramp_height_steps - 1);
+			GLuint s1 = std::min(GLuint(si[l]) + 1, ramp_slope_steps - 1);
+			const GLfloat* r0 = &colour_ramp[si[l] * ramp_height_steps][0];
+			const GLfloat* r1 = &colour_ramp[s1 * ramp_height_steps][0];
+			__m128 a = _mm_loadu_ps(r0 + hi[l] * 4);
+			__m128 b = _mm_loadu_ps(r0 + h1 * 4);
+			__m128 c = _mm_loadu_ps(r1 + hi[l] * 4);
+			__m128 d = _mm_loadu_ps(r1 + h1 * 4);
+			__m128 wh = _mm_set1_ps(thl[l]);
+			__m128 top = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), wh));
+			__m128 bottom = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), wh));
+			__m128 colour = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), _mm_set1_ps(tsl[l])));
+
+			GLfloat brightness = 1.f + ramp_jitter * (hashRandom(colour_seed, i + l, 3) - 0.5f);
+			colour = _mm_mul_ps(colour, _mm_set1_ps(brightness));
+
+			GLfloat out[4];
+			_mm_storeu_ps(out, colour);
+			colours[i + l] = vec3(out[0], out[1], out[2]);
+		}
+	}
+#endif
+
+	/* Remaining vertices, the same operations one vertex at a time */
+	for (; i < last; i++)
+	{
+		GLfloat h = std::min(std::max((vertices[i].y - height_min) * inv_range, 0.f), 1.f);
+		GLfloat sl = std::min(std::max(1.f - normals[i].y, 0.f), 1.f);
+		GLfloat fh = h * height_steps;
+		GLfloat fs = sl * slope_steps;
+		GLuint h0 = std::min(GLuint(fh), ramp_height_steps - 1);
+		GLuint s0 = std::min(GLuint(fs), ramp_slope_steps - 1);
+		GLfloat th = fh - GLfloat(h0);
+		GLfloat ts = fs - GLfloat(s0);
+		GLuint h1 = std::min(h0 + 1, ramp_height_steps - 1);
+		GLuint s1 = std::min(s0 + 1, ramp_slope_steps - 1);
+
+		const vec4* r0 = &colour_ramp[s0 * ramp_height_steps];
+		const vec4* r1 = &colour_ramp[s1 * ramp_height_steps];
+		vec4 top = r0[h0] + (r0[h1] - r0[h0]) * th;
+		vec4 bottom = r1[h0] + (r1[h1] - r1[h0]) * th;
+		vec4 colour = top + (bottom - top) * ts;
+
+		GLfloat brightness = 1.f + ramp_jitter * (hashRandom(colour_seed, i, 3) - 0.5f);
+		colours[i] = vec3(colour) * brightness;
+	}
+}
+
+
+/* Set the colour of vertex i based on its height */
+void terrain_object::colourVertex(GLuint i)
+{
+	// Scale height to range 0 to 1 to use to define colours
+	float height = (vertices[i].y - height_min) / (height_max - height_min);
+	float sea_norm = (sealevel - height_min) / (height_max - height_min);
+
+	// Some random values to use for colour selection
+	float rand = 0.1f * hashRandom(colour_seed, i, 0);
+	float rand2 = 0.05f * hashRandom(colour_seed, i, 1);
+	float rand3 = 0.02f * hashRandom(colour_seed, i, 2);
+
+	// Define colour based on normalised height (0 to 1)
+	// with some random variations
+	if (height <= sea_norm)
+		colours[i] = glm::vec3(0.3 + rand2, 0.3 + rand2, 0.9);
+	else if (height <= 0.52 + rand3)
+		colours[i] = glm::vec3(0.7 + rand2, 0.7, 0.2);
+	else if (height <= 0.6 + rand3)
+		colours[i] = glm::vec3(0.2, 0.7 + rand, 0.2);
+	else if (height <= 0.93 + rand3)
+		colours[i] = glm::vec3(0.6 + rand2, 0.4, 0.3);
+	else
+		colours[i] = glm::vec3(0.9 + rand2, 0.9 + rand2, 0.9 + rand2);
+}
+
+// Get height on terrain from world coordinates
+// Rounds the floating point grid values to get the nearest (int) grid point
+// heightsAtPositions() gives the bilinear interpolation of the four nearest
+// grid points for many positions at once
+float terrain_object::heightAtPosition(GLfloat x, GLfloat z)
+{
+	// Get grid position in floating point
+	vec2 grid_pos = getGridPos(x, z);
+
+	// Get integer grid position to
+	int gx = round(grid_pos.x);
+	int gz = round(grid_pos.y);
+
+	// Check that the grid position is in range before getting the height value
+	float grid_height = 0;
+	if (gx >= 0 && gx < (int)xsize && gz >= 0 && gz < (int)zsize)
+	{
+		// Get vertex number from integer grid position, x is the row and z the column
+		grid_height = vertices[gx * zsize + gz].y;
+	}
+
+	return grid_height;
+}
+
+
+/* Bilinearly interpolated heights (and optionally normals) at count world (x, z)
+   positions. Positions outside the terrain are clamped to its edge.
+   Large batches are split across hardware threads */
+void terrain_object::heightsAtPositions(const vec2* positions, GLuint count, GLfloat* heights, vec3* out_normals)
+{
+	GLuint threads = thread::hardware_concurrency();
+	if (threads == 0) threads = 1;
+
+	const GLuint min_queries_per_thread = 16 * 1024;
+	if (threads > count / min_queries_per_thread) threads = count / min_queries_per_thread;
+	if (threads < 2)
+	{
+		queryRange(positions, 0, count, heights, out_normals);
+		return;
+	}
+
+	vector<thread> workers;
+	GLuint band = (count + threads - 1) / threads;
+	band = (band + 3) & ~3u;		// Keep the SIMD groups together
+	for (GLuint start = 0; start < count; start += band)
+	{
+		GLuint end = std::min(start + band, count);
+		workers.push_back(thread(&terrain_object::queryRange, this, positions, start, end, heights, out_normals));
+	}
+	for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+}
+
+
+/* Answer queries first to last. Groups of four are done with SSE, the rest with the
+   scalar code, both doing the same operations in the same order */
+void terrain_object::queryRange(const vec2* positions, GLuint first, GLuint last, GLfloat* heights, vec3* out_normals)
+{
+	GLuint q = first;
+	GLfloat max_x = GLfloat(xsize - 1);
+	GLfloat max_z = GLfloat(zsize - 1);
+
+#if TERRAIN_SIMD
+	__m128 half_width = _mm_set1_ps(width / 2.f), half_height = _mm_set1_ps(height / 2.f);
+	__m128 w = _mm_set1_ps(width), h = _mm_set1_ps(height);
+	__m128 xs = _mm_set1_ps(float(xsize)), zs = _mm_set1_ps(float(zsize));
+	__m128 zero = _mm_setzero_ps();
+	__m128i last_row = _mm_set1_epi32(xsize - 2), last_col = _mm_set1_epi32(zsize - 2);
+	for (; q + 4 <= last; q += 4)
+	{
+		__m128 x = _mm_setr_ps(positions[q].x, positions[q + 1].x, positions[q + 2].x, positions[q + 3].x);
+		__m128 z = _mm_setr_ps(positions[q].y, positions[q + 1].y, positions[q + 2].y, positions[q + 3].y);
+
+		// Grid position as in getGridPos(), clamped to the grid
+		__m128 gx = _mm_mul_ps(_mm_div_ps(_mm_add_ps(x, half_width), w), xs);
+		__m128 gz = _mm_mul_ps(_mm_div_ps(_mm_add_ps(z, half_height), h), zs);
+		gx = _mm_min_ps(_mm_max_ps(gx, zero), _mm_set1_ps(max_x));
+		gz = _mm_min_ps(_mm_max_ps(gz, zero), _mm_set1_ps(max_z));
+
+		// Cell (row, col) and the position within it. Truncation is floor as gx, gz >= 0
+		__m128i row = _mm_cvttps_epi32(gx);
+		__m128i col = _mm_cvttps_epi32(gz);
+		row = _mm_sub_epi32(row, _mm_and_si128(_mm_cmpgt_epi32(row, last_row), _mm_sub_epi32(row, last_row)));
+		col = _mm_sub_epi32(col, _mm_and_si128(_mm_cmpgt_epi32(col, last_col), _mm_sub_epi32(col, last_col)));
+		__m128 fx = _mm_sub_ps(gx, _mm_cvtepi32_ps(row));
+		__m128 fz = _mm_sub_ps(gz, _mm_cvtepi32_ps(col));
+
+		int r[4], c[4];
+		_mm_storeu_si128((__m128i*)r, row);
+		_mm_storeu_si128((__m128i*)c, col);
+		const vec3* v00[4];
+		for (int i = 0; i < 4; i++) v00[i] = vertices + r[i] * zsize + c[i];
+
+		// Interpolate along z on the two rows of the cell, then along x
+		__m128 h00 = _mm_setr_ps(v00[0][0].y, v00[1][0].y, v00[2][0].y, v00[3][0].y);
+		__m128 h01 = _mm_setr_ps(v00[0][1].y, v00[1][1].y, v00[2][1].y, v00[3][1].y);
+		__m128 h10 = _mm_setr_ps(v00[0][zsize].y, v00[1][zsize].y, v00[2][zsize].y, v00[3][zsize].y);
+		__m128 h11 = _mm_setr_ps(v00[0][zsize + 1].y, v00[1][zsize + 1].y, v00[2][zsize + 1].y, v00[3][zsize + 1].y);
+		__m128 h0 = _mm_add_ps(h00, _mm_mul_ps(_mm_sub_ps(h01, h00), fz));
+		__m128 h1 = _mm_add_ps(h10, _mm_mul_ps(_mm_sub_ps(h11, h10), fz));
+		_mm_storeu_ps(heights + q, _mm_add_ps(h0, _mm_mul_ps(_mm_sub_ps(h1, h0), fx)));
+
+		if (out_normals)
+		{
+			// Each normal component the same way, then normalise
+			__m128 n[3];
+			for (int k = 0; k < 3; k++)
+			{
+				__m128 n00 = _mm_setr_ps(normals[v00[0] - vertices][k], normals[v00[1] - vertices][k], normals[v00[2] - vertices][k], normals[v00[3] - vertices][k]);
+				__m128 n01 = _mm_setr_ps(normals[v00[0] - vertices + 1][k], normals[v00[1] - vertices + 1][k], normals[v00[2] - vertices + 1][k], normals[v00[3] - vertices + 1][k]);
+				__m128 n10 = _mm_setr_ps(normals[v00[0] - vertices + zsize][k], normals[v00[1] - vertices + zsize][k], normals[v00[2] - vertices + zsize][k], normals[v00[3] - vertices + zsize][k]);
+				__m128 n11 = _mm_setr_ps(normals[v00[0] - vertices + zsize + 1][k], normals[v00[1] - vertices + zsize + 1][k], normals[v00[2] - vertices + zsize + 1][k], normals[v00[3] - vertices + zsize + 1][k]);
+				__m128 n0 = _mm_add_ps(n00, _mm_mul_ps(_mm_sub_ps(n01, n00), fz));
+				__m128 n1 = _mm_add_ps(n10, _mm_mul_ps(_mm_sub_ps(n11, n10), fz));
+				n[k] = _mm_add_ps(n0, _mm_mul_ps(_mm_sub_ps(n1, n0), fx));
+			}
+			__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n[0], n[0]), _mm_mul_ps(n[1], n[1])), _mm_mul_ps(n[2], n[2]));
+			__m128 inv = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(len2));
+			float nx[4], ny[4], nz[4];
+			_mm_storeu_ps(nx, _mm_mul_ps(n[0], inv));
+			_mm_storeu_ps(ny, _mm_mul_ps(n[1], inv));
+			_mm_storeu_ps(nz, _mm_mul_ps(n[2], inv));
+			for (int i = 0; i < 4; i++) out_normals[q + i] = vec3(nx[i], ny[i], nz[i]);
+		}
+	}
+#endif
+
+	for (; q < last; q++)
+	{
+		GLfloat gx = ((positions[q].x + (width / 2.f)) / width) * float(xsize);
+		GLfloat gz = ((positions[q].y + (height / 2.f)) / height) * float(zsize);
+		gx = std::min(std::max(gx, 0.f), max_x);
+		gz = std::min(std::max(gz, 0.f), max_z);
+
+		GLuint row = std::min((GLuint)gx, xsize - 2);
+		GLuint col = std::min((GLuint)gz, zsize - 2);
+		GLfloat fx = gx - GLfloat(row);
+		GLfloat fz = gz - GLfloat(col);
+
+		GLuint v = row * zsize + col;
+		GLfloat h0 = vertices[v].y + (vertices[v + 1].y - vertices[v].y) * fz;
+		GLfloat h1 = vertices[v + zsize].y + (vertices[v + zsize + 1].y - vertices[v + zsize].y) * fz;
+		heights[q] = h0 + (h1 - h0) * fx;
+
+		if (out_normals)
+		{
+			vec3 n0 = normals[v] + (normals[v + 1] - normals[v]) * fz;
+			vec3 n1 = normals[v + zsize] + (normals[v + zsize + 1] - normals[v + zsize]) * fz;
+			out_normals[q] = normalize(n0 + (n1 - n0) * fx);
+		}
+	}
+}
+
+/* Raise, lower or flatten the terrain in a circle of radius around world (x, z).
+   For raise and lower, strength is the height change at the centre. For flatten it is
+   how far (0 to 1) the heights move towards the height at the centre.
+   The brush falls off smoothly to the edge of the circle and heights stay above the
+   sea level. Only the heights, normals and colours in the rectangle around the circle
+   are recalculated and only those vertices are uploaded */
+void terrain_object::deform(terrain_brush brush, GLfloat x, GLfloat z, GLfloat radius, GLfloat strength)
+{
+	vec2 g0 = getGridPos(x - radius, z - radius);
+	vec2 g1 = getGridPos(x + radius, z + radius);
+	GLuint row0 = (GLuint)std::max(GLint(floor(g0.x)), 0);
+	GLuint col0 = (GLuint)std::max(GLint(floor(g0.y)), 0);
+	GLuint row1 = (GLuint)std::min(GLint(ceil(g1.x)) + 1, (GLint)xsize);
+	GLuint col1 = (GLuint)std::min(GLint(ceil(g1.y)) + 1, (GLint)zsize);
+	if (row0 >= row1 || col0 >= col1) return;
+
+	GLfloat target = 0;
+	if (brush == TERRAIN_BRUSH_FLATTEN)
+	{
+		vec2 centre(x, z);
+		heightsAtPositions(&centre, 1, &target);
+	}
+
+	for (GLuint row = row0; row < row1; row++)
+	{
+		for (GLuint col = col0; col < col1; col++)
+		{
+			vec3& v = vertices[row * zsize + col];
+			GLfloat d = length(vec2(v.x - x, v.z - z));
+			if (d >= radius) continue;
+
+			// Smoothstep falloff from 1 at the centre to 0 at the radius
+			GLfloat w = 1.f - d / radius;
+			w = w * w * (3.f - 2.f * w);
+
+			if (brush == TERRAIN_BRUSH_RAISE)
+				v.y += strength * w;
+			else if (brush == TERRAIN_BRUSH_LOWER)
+				v.y -= strength * w;
+			else
+				v.y += (target - v.y) * std::min(strength * w, 1.f);
+
+			if (v.y < sealevel) v.y = sealevel;
+		}
+	}
+
+	// The normals change one vertex beyond the heights
+	calculateNormals(row0, col0, row1, col1);
+	row0 = (row0 > 0) ? row0 - 1 : 0;
+	col0 = (col0 > 0) ? col0 - 1 : 0;
+	row1 = std::min(row1 + 1, xsize);
+	col1 = std::min(col1 + 1, zsize);
+
+	// Colours can depend on the slope so they follow the normals
+	if (colour_by_height)
+	{
+		for (GLuint row = row0; row < row1; row++) colourRange(row * zsize + col0, row * zsize + col1);
+	}
+
+	if (lod_enabled) updateLODHeights(row0, col0, row1, col1);
+	if (vao) uploadRect(row0, col0, row1, col1);
+}
+
+
+/* Copy the vertices in rows row0 to row1, columns col0 to col1 (end exclusive) to the
+   vertex buffers made by createObject() with one glBufferSubData per row and buffer,
+   or to the textures with one glTexSubImage2D each for TERRAIN_FORMAT_DISPLACED.
+   The LOD morph targets of the area (and as far away as the coarsest stride, because
+   they are midpoints of coarse edges) are updated too */
+void terrain_object::uploadRect(GLuint row0, GLuint col0, GLuint row1, GLuint col1)
+{
+	if (vertex_format == TERRAIN_FORMAT_HEIGHT16 || (vertex_format == TERRAIN_FORMAT_DISPLACED && !displacement_float))
+	{
+		// Heights outside the 16 bit range need a new range and all the vertices packed again
+		bool repack = false;
+		for (GLuint row = row0; row < row1; row++)
+		{
+			for (GLuint col = col0; col < col1; col++)
+			{
+				GLfloat h = vertices[row * zsize + col].y;
+				if (h < height_decode.x || h > height_decode.x + height_decode.y) repack = true;
+			}
+		}
+		if (repack)
+		{
+			calculateDecode();
+			row0 = col0 = 0;
+			row1 = xsize;
+			col1 = zsize;
+		}
+	}
+
+	GLuint count = col1 - col0;
+	if (vertex_format == TERRAIN_FORMAT_DISPLACED)
+	{
+		// A height update is a texture sub-upload
+		uploadTextures(row0, col0, row1, col1);
+	}
+	else if (vertex_format == TERRAIN_FORMAT_FLOAT)
+	{
+		vec3* arrays[] = { vertices, colours, normals };
+		GLuint buffers[] = { vbo_mesh_vertices, vbo_mesh_colours, vbo_mesh_normals };
+		for (int b = 0; b < 3; b++)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, buffers[b]);
+			for (GLuint row = row0; row < row1; row++)
+			{
+				GLuint v = row * zsize + col0;
+				glBufferSubData(GL_ARRAY_BUFFER, v * sizeof(vec3), count * sizeof(vec3), &arrays[b][v]);
+			}
+		}
+	}
+	else
+	{
+		GLuint size = vertexSize(vertex_format);
+		vector<GLubyte> packed(count * size);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_vertices);
+		for (GLuint row = row0; row < row1; row++)
+		{
+			GLuint v = row * zsize + col0;
+			packVertices(v, count, &packed[0]);
+			glBufferSubData(GL_ARRAY_BUFFER, v * size, count * size, &packed[0]);
+		}
+	}
+
+	if (vbo_mesh_morph)
+	{
+		GLuint stride = 1 << (lod_levels - 1);
+		GLuint mr0 = (row0 > stride) ? row0 - stride : 0;
+		GLuint mc0 = (col0 > stride) ? col0 - stride : 0;
+		GLuint mr1 = std::min(row1 + stride, xsize);
+		GLuint mc1 = std::min(col1 + stride, zsize);
+		vector<vec4> morph(mc1 - mc0);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_mesh_morph);
+		for (GLuint row = mr0; row < mr1; row++)
+		{
+			for (GLuint col = mc0; col < mc1; col++)
+				morph[col - mc0] = morphTarget(row, col);
+			glBufferSubData(GL_ARRAY_BUFFER, (row * zsize + mc0) * sizeof(vec4), morph.size() * sizeof(vec4), &morph[0]);
+		}
+	}
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
+// Get a terrain height array gtid position from a world coordinate
+// Note that this will only work if you DON'T scale and shift the terrain object
+vec2 terrain_object::getGridPos(GLfloat x, GLfloat z)
+{
+	GLfloat Xgrid = ((x + (width / 2.f)) / width) * float(xsize);
+	GLfloat Zgrid = ((z + (height / 2.f)) / height) * float(zsize);
+
+	return vec2(Xgrid, Zgrid);
+}
+
+
+/* Print the peak memory (resident set size) used to build a size x size heightfield
+   when only the final noise height is stored and when every octave is kept.
+   The streaming build runs first because the peak can only go up */
+void terrain_object::memoryReport(GLuint size, GLuint octaves)
+{
+	size_t start_peak = peakResidentBytes();
+	double t0 = secondsNow();
+	{
+		terrain_object terrain(octaves, 1.f, 2.f);
+		terrain.createTerrain(size, size, 2.f, 2.f);
+	}
+	size_t streaming_peak = peakResidentBytes();
+	double t1 = secondsNow();
+	{
+		terrain_object terrain(octaves, 1.f, 2.f);
+		terrain.setKeepOctaves(true);
+		terrain.createTerrain(size, size, 2.f, 2.f);
+	}
+	size_t octaves_peak = peakResidentBytes();
+	double t2 = secondsNow();
+
+	const double mb = 1024.0 * 1024.0;
+	printf("\nterrain_object memory report: %u x %u grid, %u octaves\n", size, size, octaves);
+	printf("  peak RSS before:            %8.1f MB\n", start_peak / mb);
+	printf("  final height only:          %8.1f MB peak (+%.1f MB), noise array %.1f MB, %.2f s\n",
+		streaming_peak / mb, (streaming_peak - start_peak) / mb, double(size) * size * sizeof(GLfloat) / mb, t1 - t0);
+	printf("  keep every octave:          %8.1f MB peak (+%.1f MB), noise array %.1f MB, %.2f s\n",
+		octaves_peak / mb, (octaves_peak - start_peak) / mb, double(size) * size * octaves * sizeof(GLfloat) / mb, t2 - t1);
+}
+
+
+/* Print the GPU memory used by a size x size terrain in each vertex format and
+   the largest error introduced by packing the normals and heights */
+void terrain_object::formatReport(GLuint size)
+{
+	terrain_object terrain(4, 1.f, 2.f);
+	terrain.createTerrain(size, size, 20.f, 20.f);
+	terrain.setColourBasedOnHeight();
+	terrain.calculateDecode();
+
+	const double mb = 1024.0 * 1024.0;
+	GLuint numvertices = size * size;
+	double index_mb = terrain.elements.size() * sizeof(GLuint) / mb;
+	double float_mb = numvertices * vertexSize(TERRAIN_FORMAT_FLOAT) / mb + index_mb;
+
+	printf("\nterrain_object vertex formats: %u x %u grid, index buffer %.2f MB\n", size, size, index_mb);
+	const char* names[] = { "float (3 buffers)", "packed interleaved", "16 bit height", "displaced textures" };
+	for (int f = TERRAIN_FORMAT_FLOAT; f <= TERRAIN_FORMAT_DISPLACED; f++)
+	{
+		terrain_vertex_format format = (terrain_vertex_format)f;
+		double vertex_mb = numvertices * vertexSize(format) / mb;
+
+		// The displaced format draws one small patch instead of the grid elements
+		GLuint n = terrain.displacement_patch;
+		double patch_mb = ((n + 1) * (n + 1) * 2 * sizeof(GLushort) + n * n * 6 * sizeof(GLushort)) / mb;
+		double elements_mb = (format == TERRAIN_FORMAT_DISPLACED) ? patch_mb : index_mb;
+		printf("  %-20s %2u bytes/vertex, vertices %7.2f MB, total %7.2f MB (%5.1f%%)",
+			names[f], vertexSize(format), vertex_mb, vertex_mb + elements_mb, 100.0 * (vertex_mb + elements_mb) / float_mb);
+
+		if (format == TERRAIN_FORMAT_DISPLACED)
+		{
+			/* Run the instancing and texel fetches of terrain.vert on the CPU and compare
+			   the displaced positions and normals with the grid vertices */
+			terrain.vertex_format = format;
+			vector<GLushort> heights(numvertices);
+			vector<GLshort> normals2(numvertices * 2);
+			vector<GLubyte> colours4(numvertices * 4);
+			terrain.packTexels(0, numvertices, &heights[0], NULL, &normals2[0], &colours4[0]);
+
+			vector<bool> covered(numvertices, false);
+			float max_angle = 0, max_position = 0;
+			GLuint patch_columns = terrain.patchColumns();
+			GLuint instances = patch_columns * terrain.patchRows();
+			for (GLuint instance = 0; instance < instances; instance++)
+			{
+				for (GLuint r = 0; r <= n; r++)
+				{
+					for (GLuint c = 0; c <= n; c++)
+					{
+						GLuint row = std::min((instance / patch_columns) * n + r, size - 1);
+						GLuint col = std::min((instance % patch_columns) * n + c, size - 1);
+						GLuint v = row * size + col;
+						vec3 position(terrain.grid_decode.x + float(row) * terrain.grid_decode.z,
+							terrain.height_decode.x + heights[v] / 65535.f * terrain.height_decode.y,
+							terrain.grid_decode.y + float(col) * terrain.grid_decode.w);
+						float d = clamp(dot(octDecode(&normals2[v * 2]), terrain.normals[v]), -1.f, 1.f);
+						max_angle = std::max(max_angle, degrees(acos(d)));
+						max_position = std::max(max_position, length(position - terrain.vertices[v]));
+						covered[v] = true;
+					}
+				}
+			}
+			printf(", max normal error %.4f deg, max position error %.6f, %u instances cover %u of %u vertices",
+				max_angle, max_position, instances, (GLuint)std::count(covered.begin(), covered.end(), true), numvertices);
+		}
+		else if (format != TERRAIN_FORMAT_FLOAT)
+		{
+			terrain.vertex_format = format;
+			vector<GLubyte> packed(numvertices * vertexSize(format));
+			terrain.packVertices(0, numvertices, &packed[0]);
+
+			// Compare the decoded normals and heights with the originals
+			float max_angle = 0, max_height = 0;
+			for (GLuint v = 0; v < numvertices; v++)
+			{
+				const GLshort* normal;
+				float height;
+				if (format == TERRAIN_FORMAT_PACKED)
+				{
+					terrain_vertex_packed* p = (terrain_vertex_packed*)&packed[0] + v;
+					normal = p->normal;
+					height = p->position.y;
+				}
+				else
+				{
+					terrain_vertex_height16* p = (terrain_vertex_height16*)&packed[0] + v;
+					normal = p->normal;
+					height = terrain.height_decode.x + p->height / 65535.f * terrain.height_decode.y;
+				}
+				float d = clamp(dot(octDecode(normal), terrain.normals[v]), -1.f, 1.f);
+				max_angle = std::max(max_angle, degrees(acos(d)));
+				max_height = std::max(max_height, fabs(height - terrain.vertices[v].y));
+			}
+			printf(", max normal error %.4f deg, max height error %.6f", max_angle, max_height);
+		}
+		printf("\n");
+	}
+}
+
+
+/* Print queries/second for heightAtPosition() against heightsAtPositions()
+   on a size x size terrain */
+void terrain_object::queryBenchmark(GLuint size, GLuint count)
+{
+	terrain_object terrain(4, 1.f, 2.f);
+	terrain.createTerrain(size, size, 20.f, 20.f);
+
+	vector<vec2> positions(count);
+	for (GLuint i = 0; i < count; i++)
+		positions[i] = vec2(linearRand(-10.f, 10.f), linearRand(-10.f, 10.f));
+	vector<GLfloat> heights(count);
+	vector<vec3> query_normals(count);
+
+	double t0 = secondsNow();
+	GLfloat sum = 0;
+	for (GLuint i = 0; i < count; i++)
+		sum += terrain.heightAtPosition(positions[i].x, positions[i].y);
+	double t1 = secondsNow();
+	terrain.heightsAtPositions(&positions[0], count, &heights[0]);
+	double t2 = secondsNow();
+	terrain.heightsAtPositions(&positions[0], count, &heights[0], &query_normals[0]);
+	double t3 = secondsNow();
+
+	printf("\nterrain_object height queries: %u x %u grid, %u random positions (checksum %.3f)\n", size, size, count, sum);
+	printf("  heightAtPosition (nearest):      %8.2f M queries/s\n", count / (t1 - t0) / 1e6);
+	printf("  heightsAtPositions (bilinear):   %8.2f M queries/s\n", count / (t2 - t1) / 1e6);
+	printf("  heightsAtPositions with normals: %8.2f M queries/s\n", count / (t3 - t2) / 1e6);
+}
+
+
+/* Print the time to build a size x size terrain from scratch (cold, which also
+   writes the cache) and from the cache written by the cold run (warm) */
+void terrain_object::cacheReport(GLuint size)
+{
+	// Start cold: remove the cache left by an earlier report
+	terrain_cache_header key;
+	char path[1024];
+	terrain_object(8, 1.f, 2.f).cacheFile(key, path, sizeof(path), size, size, 20.f, 20.f, 0, NULL);
+	remove(path);
+
+	double t0 = secondsNow();
+	bool cold_hit, warm_hit;
+	{
+		terrain_object terrain(8, 1.f, 2.f);
+		cold_hit = terrain.createTerrainCached(size, size, 20.f, 20.f);
+	}
+	double t1 = secondsNow();
+	{
+		terrain_object terrain(8, 1.f, 2.f);
+		warm_hit = terrain.createTerrainCached(size, size, 20.f, 20.f);
+	}
+	double t2 = secondsNow();
+
+	double mb = (3.0 * size * size * sizeof(vec3) + (size - 1.0) * (2.0 * size + 1.0) * sizeof(GLuint)) / (1024.0 * 1024.0);
+	printf("\nterrain_object cache: %u x %u grid, 8 octaves, %.1f MB cache file\n", size, size, mb);
+	printf("  cold (%s): %8.1f ms\n", cold_hit ? "already cached" : "generate and save", (t1 - t0) * 1000.0);
+	printf("  warm (%s):  %8.1f ms\n", warm_hit ? "load from cache" : "cache not written", (t2 - t1) * 1000.0);
+	remove(path);
+}
+
+
+/* Write a size x size 16 bit RAW heightmap one row at a time and print the time,
+   throughput and peak memory of loading it into a grid x grid terrain */
+void terrain_object::heightmapReport(GLuint size, GLuint grid)
+{
+	const char* path = "heightmap_report.r16";
+	FILE* f = fopen(path, "wb");
+	if (!f) return;
+	vector<unsigned char> row(size * 2);
+	for (GLuint y = 0; y < size; y++)
+	{
+		for (GLuint x = 0; x < size; x++)
+		{
+			GLushort h = GLushort(32767.5f + 16000.f * sin(x * 0.003f) * cos(y * 0.002f) + 8000.f * sin((x + y) * 0.011f));
+			row[x * 2] = GLubyte(h & 0xff);
+			row[x * 2 + 1] = GLubyte(h >> 8);
+		}
+		fwrite(&row[0], 1, row.size(), f);
+	}
+	fclose(f);
+	vector<unsigned char>().swap(row);
+
+	size_t start_peak = peakResidentBytes();
+	double t0 = secondsNow();
+	bool ok;
+	{
+		terrain_object terrain(4, 1.f, 2.f);
+		ok = terrain.createTerrainFromHeightmap(path, grid, grid, 20.f, 20.f, 5.f);
+	}
+	double t1 = secondsNow();
+	size_t end_peak = peakResidentBytes();
+	remove(path);
+
+	const double mb = 1024.0 * 1024.0;
+	double source_mb = double(size) * size * sizeof(GLushort) / mb;
+	double vertex_mb = 3.0 * grid * grid * sizeof(vec3) / mb;
+	printf("\nterrain_object heightmap import: %u x %u RAW (%.1f MB) to %u x %u grid%s\n",
+		size, size, source_mb, grid, grid, ok ? "" : " FAILED");
+	printf("  load:                       %8.1f ms, %.1f MB/s of heightmap\n", (t1 - t0) * 1000.0, source_mb / (t1 - t0));
+	printf("  peak RSS before:            %8.1f MB\n", start_peak / mb);
+	printf("  peak RSS after:             %8.1f MB (+%.1f MB), vertex arrays %.1f MB\n",
+		end_peak / mb, (end_peak - start_peak) / mb, vertex_mb);
+	printf("  decoded + float copies would add %.1f MB\n", source_mb * 3.0);
+}
+
+
+/* Print the time to colour a size x size terrain by height bands and from a
+   height/slope ramp, on one thread and on all hardware threads */
+void terrain_object::colourBenchmark(GLuint size)
+{
+	terrain_object terrain(4, 1.f, 2.f);
+	terrain.createTerrain(size, size, 20.f, 20.f);
+	GLuint numvertices = size * size;
+
+	// Sand, grass, rock and snow on flat ground, rock on steep slopes
+	const vec3 ramp[] = {
+		vec3(0.76f, 0.7f, 0.5f), vec3(0.2f, 0.6f, 0.2f), vec3(0.5f, 0.45f, 0.4f), vec3(0.95f, 0.95f, 0.95f),
+		vec3(0.5f, 0.45f, 0.4f), vec3(0.45f, 0.4f, 0.35f), vec3(0.4f, 0.38f, 0.35f), vec3(0.7f, 0.7f, 0.7f) };
+
+	printf("\nterrain_object colouring: %u x %u grid, %u hardware threads\n", size, size, thread::hardware_concurrency());
+	for (int mode = 0; mode < 2; mode++)
+	{
+		if (mode == 1) terrain.setColourRamp(ramp, 4, 2, 0.1f);
+
+		double t0 = secondsNow();
+		terrain.colourRange(0, numvertices);
+		double t1 = secondsNow();
+		terrain.setColourBasedOnHeight();
+		double t2 = secondsNow();
+
+		printf("  %-12s 1 thread %7.1f ms (%6.1f M vertices/s), threaded %7.1f ms\n", mode ? "height/slope" : "height bands",
+			(t1 - t0) * 1000.0, numvertices / (t1 - t0) / 1e6, (t2 - t1) * 1000.0);
+	}
+}
@@ -1,59 +1,186 @@
-#pragma once
-/* terrain_object.h
-   Example class to show how to create and render a height map
-   Iain Martin November 2018
-*/
-
-#pragma once
-
-#include "wrapper_glfw.h"
-#include <vector>
-#include <glm/glm.hpp>
-
-class terrain_object
-{
-public:
-	terrain_object(int octaves, GLfloat freq, GLfloat scale);
-	~terrain_object();
-
-	void calculateNoise();
-	void createTerrain(GLuint xp, GLuint yp, GLfloat xs, GLfloat ys, GLfloat sealevel=0);
-	void calculateNormals();
-	void stretchToRange(GLfloat min, GLfloat max);
-	void setColour(glm::vec3 c);
-	void setColourBasedOnHeight();
-	void defineSeaLevel(GLfloat s);
-	float heightAtPosition(GLfloat x, GLfloat z);
-	glm::vec2 getGridPos(GLfloat x, GLfloat z);
-
-
-	void createObject();
-	void drawObject(int drawmode);
-
-	glm::vec3 *vertices;
-	glm::vec3 *normals;
-	glm::vec3 *colours;
-	std::vector<GLuint> elements;
-	GLfloat* noise;
-
-	GLuint vbo_mesh_vertices;
-	GLuint vbo_mesh_normals;
-	GLuint vbo_mesh_colours;
-	GLuint ibo_mesh_elements;
-	GLuint attribute_v_coord;
-	GLuint attribute_v_normal;
-	GLuint attribute_v_colour;
-
-	GLuint xsize;
-	GLuint zsize;
-	GLfloat width;
-	GLfloat height;
-	GLuint perlin_octaves;
-	GLfloat perlin_freq;
-	GLfloat perlin_scale;
-	GLfloat height_scale;
-	GLfloat sealevel;
-
-	float height_min, height_max;	// range of terrain heights
-};
-
+#pragma once
+/* terrain_object.h
+   Example class to show how to create and render a height map
+   Iain Martin November 2018
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include <vector>
+#include <glm/glm.hpp>
+
+/* Vertex buffer layouts used by createObject() */
+enum terrain_vertex_format
+{
+	TERRAIN_FORMAT_FLOAT,		// Separate float position, colour and normal buffers (36 bytes)
+	TERRAIN_FORMAT_PACKED,		// Interleaved float position, octahedral normal, RGBA8 colour (20 bytes)
+	TERRAIN_FORMAT_HEIGHT16,	// Interleaved 16 bit height, octahedral normal, RGBA8 colour (12 bytes)
+	TERRAIN_FORMAT_DISPLACED	// Instanced flat patch displaced in the vertex shader from a 16 bit height,
+								// octahedral normal and RGBA8 colour texture (10 bytes per grid vertex)
+};
+
+/* Terrain editing brushes, see terrain_object::deform() */
+enum terrain_brush
+{
+	TERRAIN_BRUSH_RAISE,
+	TERRAIN_BRUSH_LOWER,
+	TERRAIN_BRUSH_FLATTEN
+};
+
+struct terrain_vertex_packed
+{
+	glm::vec3 position;
+	GLshort normal[2];		// Octahedral encoded, normalized
+	GLubyte colour[4];
+};
+
+struct terrain_vertex_height16
+{
+	GLushort height;		// Normalized between the minimum and maximum height
+	GLushort pad;			// Keeps the normal 4 byte aligned
+	GLshort normal[2];
+	GLubyte colour[4];
+};
+
+struct terrain_cache_header;
+
+class terrain_object
+{
+public:
+	terrain_object(int octaves, GLfloat freq, GLfloat scale);
+	~terrain_object();
+
+	void calculateNoise();
+	void createTerrain(GLuint xp, GLuint yp, GLfloat xs, GLfloat ys, GLfloat sealevel=0);
+	bool createTerrainCached(GLuint xp, GLuint zp, GLfloat xs, GLfloat zs, GLfloat sealevel = 0, const char* cache_dir = NULL);
+	bool saveCache(const char* path);
+	bool createTerrainFromHeightmap(const char* path, GLuint xp, GLuint zp, GLfloat xs, GLfloat zs,
+		GLfloat height_range, GLfloat sealevel = 0);
+	void calculateNormals();
+	void calculateNormals(GLuint row0, GLuint col0, GLuint row1, GLuint col1);	// Dirty rectangle
+	void stretchToRange(GLfloat min, GLfloat max);
+	void setColour(glm::vec3 c);
+	void setColourBasedOnHeight();
+	void setColourRamp(const glm::vec3* table, GLuint height_steps, GLuint slope_steps, GLfloat jitter = 0);
+	void defineSeaLevel(GLfloat s);
+	float heightAtPosition(GLfloat x, GLfloat z);
+	void deform(terrain_brush brush, GLfloat x, GLfloat z, GLfloat radius, GLfloat strength);
+	void heightsAtPositions(const glm::vec2* positions, GLuint count, GLfloat* heights, glm::vec3* normals = NULL);
+	glm::vec2 getGridPos(GLfloat x, GLfloat z);
+	void setKeepOctaves(bool keep);
+	void setTriangleList(bool enable);
+	void setVertexFormat(terrain_vertex_format format);
+	void setFormatUniforms(GLuint program);
+	void setDisplacement(GLuint patch_quads, bool float_heights = false);
+
+	static void memoryReport(GLuint size, GLuint octaves);
+	static void formatReport(GLuint size);
+	static GLuint vertexSize(terrain_vertex_format format);
+	static void queryBenchmark(GLuint size, GLuint count);
+	static void cacheReport(GLuint size);
+	static void heightmapReport(GLuint size, GLuint grid);
+	static void colourBenchmark(GLuint size);
+
+
+	void createObject();
+	void drawObject(int drawmode);
+
+	/* Level of detail rendering (CDLOD). The grid is split into a quadtree of patches,
+	   patches further from the eye are drawn with a coarser vertex stride and vertices
+	   morph towards the next coarser level in the vertex shader to avoid popping */
+	bool enableLOD(GLuint leaf_quads = 16, GLfloat base_range = 0);
+	void setLODUniforms(GLuint lod_level_id, GLuint morph_range_id, GLuint eye_id);
+	void drawObjectLOD(int drawmode, glm::vec3 eye);	// eye in terrain model coordinates
+	void printLODStats();
+
+	glm::vec3 *vertices;
+	glm::vec3 *normals;
+	glm::vec3 *colours;
+	std::vector<GLuint> elements;
+	GLfloat* noise;		// Final noise height per vertex (every octave if keep_octaves is set)
+	bool keep_octaves;	// Debug mode: keep the running sum of every octave in noise
+	bool colour_by_height;	// Colours come from setColourBasedOnHeight(), deform() keeps them up to date
+	bool triangle_list;	// Elements are a cache ordered triangle list, not restart separated strips
+	GLuint colour_seed;	// Seed of the random colour variations, the same seed gives the same colours
+
+	/* Height/slope colour lookup table, see setColourRamp() */
+	std::vector<glm::vec4> colour_ramp;
+	GLuint ramp_height_steps, ramp_slope_steps;
+	GLfloat ramp_jitter;
+
+	static GLuint draw_calls;	// Draw calls issued by all terrain objects, reset by the application
+
+	GLuint vao;					// Attribute layout recorded once by createObject()
+	GLuint vbo_mesh_vertices;	// Interleaved vertices for the packed formats
+	GLuint vbo_mesh_normals;
+	GLuint vbo_mesh_colours;
+	GLuint ibo_mesh_elements;
+	GLuint attribute_v_coord;
+	GLuint attribute_v_normal;
+	GLuint attribute_v_colour;
+	GLuint attribute_v_morph;
+
+	terrain_vertex_format vertex_format;
+	glm::vec4 grid_decode;		// x, z of the first vertex, x step between rows, z step between columns
+	glm::vec2 height_decode;	// Minimum height and height range of the 16 bit heights
+	GLuint vertex_format_id, grid_columns_id, grid_decode_id, height_decode_id;
+
+	/* TERRAIN_FORMAT_DISPLACED state, see setDisplacement() */
+	GLuint displacement_patch;		// Quads along the side of the instanced patch
+	bool displacement_float;		// R32F heights instead of R16
+	GLuint tex_height, tex_normal, tex_colour;
+	GLuint num_patch_elements;
+	GLuint patch_quads_id, patch_columns_id, height_map_id, normal_map_id, colour_map_id;
+
+	/* LOD state, see enableLOD() */
+	bool lod_enabled;
+	GLuint lod_leaf;							// Quads along the side of every patch
+	GLuint lod_levels;							// Number of levels, level 0 is full resolution
+	std::vector<GLfloat> lod_ranges;			// Eye distance covered by each level
+	std::vector<std::vector<glm::vec2> > lod_height_range;	// Min/max height of every node, per level
+	std::vector<GLuint> ibo_lod_elements;		// One shared patch index buffer per level
+	GLuint vbo_mesh_morph;
+	GLuint lod_level_id, morph_range_id, lod_eye_id;
+	GLuint lod_triangles;						// Triangles submitted by the last drawObjectLOD()
+	GLuint lod_draw_calls;						// Draw calls issued by the last drawObjectLOD()
+
+	GLuint xsize;
+	GLuint zsize;
+	GLfloat width;
+	GLfloat height;
+	GLuint perlin_octaves;
+	GLfloat perlin_freq;
+	GLfloat perlin_scale;
+	GLfloat height_scale;
+	GLfloat sealevel;
+
+	float height_min, height_max;	// range of terrain heights
+
+private:
+	void createElements();
+	bool loadCache(const char* path, const terrain_cache_header& key);
+	void calculateDecode();
+	void packVertices(GLuint first, GLuint count, GLubyte* out);
+	void packTexels(GLuint first, GLuint count, GLushort* heights16, GLfloat* heights32, GLshort* normals2, GLubyte* colours4);
+	void createPatch();
+	void uploadTextures(GLuint row0, GLuint col0, GLuint row1, GLuint col1);
+	GLuint patchColumns();
+	GLuint patchRows();
+	void bindAttributes();
+	void sendFormatUniforms();
+	glm::vec3 gridNormal(GLuint row, GLuint col);
+	void normalRows(GLuint row_start, GLuint row_end, GLuint col0, GLuint col1);
+	void updateLODHeights(GLuint row0, GLuint col0, GLuint row1, GLuint col1);
+	glm::vec4 morphTarget(GLuint r, GLuint c);
+	void colourVertex(GLuint i);
+	void colourRange(GLuint first, GLuint last);
+	GLuint colourKey();
+	void cacheFile(terrain_cache_header& key, char* path, size_t size,
+		GLuint xp, GLuint zp, GLfloat xs, GLfloat zs, GLfloat sealevel, const char* cache_dir);
+	void uploadRect(GLuint row0, GLuint col0, GLuint row1, GLuint col1);
+	void queryRange(const glm::vec2* positions, GLuint first, GLuint last, GLfloat* heights, glm::vec3* normals);
+	bool selectLODNode(GLuint level, GLuint nr, GLuint nc, glm::vec3 eye);
+	void drawLODNode(GLuint level, GLuint nr, GLuint nc, int quadrant);
+};
+
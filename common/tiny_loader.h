@@ -1,45 +1,55 @@
-/* tiny_loader2.h
-Example class to demonstrate the use of TinyObjectLoader to load an obj (WaveFront)
-object file and copy the date into vertex, normal and element buffers.
-This is incomplete: I've tested it with vertices, normals and elements but not
-with texture coordinates.
-Iain Martin November 2018
-*/
-
-#pragma once
-
-#include "wrapper_glfw.h"
-#include <vector>
-#include <glm/glm.hpp>
-
-class TinyObjLoader
-{
-public:
-	TinyObjLoader();
-	~TinyObjLoader();
-
-	void load_obj(std::string inputfile, bool debugPrint = false);
-	void drawObject(int drawmode);
-	void overrideColour(glm::vec4 c);
-
-private:
-	// Define vertex buffer object names (e.g as globals)
-	GLuint positionBufferObject;
-	GLuint colourBufferObject;
-	GLuint normalBufferObject;
-	GLuint elementBufferObject;
-	GLuint texCoordsObject;
-
-	GLuint attribute_v_coord;
-	GLuint attribute_v_normal;
-	GLuint attribute_v_colours;
-	GLuint attribute_v_texcoord;
-
-	int drawmode;
-	GLuint numVertices;
-	GLuint numNormals;
-	GLint  numTexCoords;
-	GLuint numPIndexes;
-	
-
-};
+/* tiny_loader2.h
+Example class to demonstrate the use of TinyObjectLoader to load an obj (WaveFront)
+object file and copy the date into vertex, normal and element buffers.
+This is incomplete: I've tested it with vertices, normals and elements but not
+with texture coordinates.
+With setQuantizeEnabled(true) the attributes are uploaded in the formats of
+vertex_quantize.h: draw with the model matrix multiplied by dequantize, and decode the
+normals in the shader as shaders/object_loader_texture.vert does.
+Iain Martin November 2018
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include "vertex_quantize.h"
+#include <vector>
+#include <glm/glm.hpp>
+
+class TinyObjLoader
+{
+public:
+	TinyObjLoader();
+	~TinyObjLoader();
+
+	void load_obj(std::string inputfile, bool debugPrint = false);
+	void drawObject(int drawmode);
+	void overrideColour(glm::vec4 c);
+	void setQuantizeEnabled(bool enable);	// Call before load_obj()
+	void setFormatUniforms(GLuint program);	// Shader uniform that selects the normal decoding
+
+	bool quantized;					// The attributes were loaded quantized
+	glm::mat4 dequantize;			// Identity unless quantized, draw with model * dequantize
+
+private:
+	// Define vertex buffer object names (e.g as globals)
+	GLuint positionBufferObject;
+	GLuint colourBufferObject;
+	GLuint normalBufferObject;
+	GLuint elementBufferObject;
+	GLuint texCoordsObject;
+
+	GLuint attribute_v_coord;
+	GLuint attribute_v_normal;
+	GLuint attribute_v_colours;
+	GLuint attribute_v_texcoord;
+
+	int drawmode;
+	GLuint numVertices;
+	GLuint numNormals;
+	GLint  numTexCoords;
+	GLuint numPIndexes;
+	bool quantize;
+	GLuint vertex_format_id;
+
+};
@@ -1,343 +1,1479 @@
-/* tiny_loader_texture.cpp
-Example class to demonstrate the use of TinyObjectLoader to load an obj (WaveFront)
-object file with normals and texture coordinates, and copy the data into vertex, normal texture coordinate buffers.
-A colour buffer is not included as it is expected that the colour be taken form the texture.
-Please be careful to match the vertex attribute indices in your shaders. See code in the
-constructor:
-
-	attribute_v_coord = 0;
-	attribute_v_normal = 1;
-	attribute_v_texcoord = 2;
-
-Iain Martin November 2018
-*/
-
-#include "tiny_loader_texture.h"
-#include <iostream>
-#include <stdio.h>
-
-//Tinyobjloader library used to import models
-#ifndef TINYOBJLOADER_IMPLEMENTATION
-	#define TINYOBJLOADER_IMPLEMENTATION // define this in only *one* .cc
-	#include "tiny_obj_loader.h"
-#endif
-
-using namespace std;
-using namespace glm;
-
-// Debig print method to print out the attributres loaded from the obj file
-static  void PrintInfo(const tinyobj::attrib_t& attrib,
-	const vector<tinyobj::shape_t>& shapes,
-	const vector<tinyobj::material_t>& materials); 
-
-TinyObjLoader::TinyObjLoader()
-{
-	attribute_v_coord = 0;
-	attribute_v_normal = 1;
-	attribute_v_texcoord = 2;
-
-	numVertices = 0;
-	numNormals = 0;
-	numTexCoords = 0;
-}
-
-TinyObjLoader::~TinyObjLoader()
-{
-}
-
-
-void TinyObjLoader::load_obj(string inputfile, bool debugPrint)
-{
-	tinyobj::attrib_t attrib;
-	vector<tinyobj::shape_t> shapes;
-	vector<tinyobj::material_t> materials;
-
-
-	string err, warn;
-	bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &err, &warn, inputfile.c_str());
-
-	if (!err.empty()) { // `err` may contain error messages.
-		cerr << err << endl;
-	}
-	
-	if (!err.empty()) { // `warn` may contain warning messages.
-		cerr << err << endl;
-	}
-
-	if (!ret) {
-		exit(1);
-	}
-
-	// Calculate the number of vertices from the shapes
-	numVertices = 0;
-	for (size_t s = 0; s < shapes.size(); s++) {
-		numVertices += shapes[s].mesh.num_face_vertices.size() * 3;//3 vertexes for each face
-	}
-
-	numNormals = numTexCoords = numVertices;
-
-	//have to duplicate vertices (glDrawElements not possible) because of texture
-	std::vector<tinyobj::real_t> pVertices(numVertices * 3);
-	std::vector<tinyobj::real_t> pTextureCoords(numVertices * 2);
-	std::vector<tinyobj::real_t> pNormals(numVertices * 3);
-
-	GLuint ind = 0;
-	for (size_t s = 0; s < shapes.size(); s++) {
-
-		// Loop over faces(polygon)
-		size_t index_offset = 0;
-
-		//number of faces; vert, text, norm
-		for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) 
-		{
-			int fv = shapes[s].mesh.num_face_vertices[f];//number of vertices per face (3)
-
-			// Loop over vertices in the face.
-			for (size_t v = 0; v < fv; v++) 
-			{
-				// access to vertex
-				tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
-
-				pVertices[ind * 3 + 0] = attrib.vertices[3 * idx.vertex_index + 0];
-				pVertices[ind * 3 + 1] = attrib.vertices[3 * idx.vertex_index + 1];
-				pVertices[ind * 3 + 2] = attrib.vertices[3 * idx.vertex_index + 2];
-
-				pTextureCoords[ind * 2 + 0] = attrib.texcoords[2 * idx.texcoord_index + 0];
-				pTextureCoords[ind * 2 + 1] = attrib.texcoords[2 * idx.texcoord_index + 1];
-
-				pNormals[ind * 3 + 0] = attrib.normals[3 * idx.normal_index + 0];
-				pNormals[ind * 3 + 1] = attrib.normals[3 * idx.normal_index + 1];
-				pNormals[ind * 3 + 2] = attrib.normals[3 * idx.normal_index + 2];
-
-				ind++;
-			}
-			index_offset += fv;
-		}
-	}
-
-	// Copy the vertix, normal and textcoord data into OpenGL buffers
-	glGenBuffers(1, &positionBufferObject);
-	glBindBuffer(GL_ARRAY_BUFFER, positionBufferObject);
-	glBufferData(GL_ARRAY_BUFFER, pVertices.size() * sizeof(tinyobj::real_t), &pVertices.front(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	glGenBuffers(1, &normalBufferObject);
-	glBindBuffer(GL_ARRAY_BUFFER, normalBufferObject);
-	glBufferData(GL_ARRAY_BUFFER, pNormals.size() * sizeof(tinyobj::real_t), &pNormals.front(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-	glGenBuffers(1, &texCoordsObject);
-	glBindBuffer(GL_ARRAY_BUFFER, texCoordsObject);
-	glBufferData(GL_ARRAY_BUFFER, pTextureCoords.size() * sizeof(tinyobj::real_t), &pTextureCoords.front(), GL_STATIC_DRAW);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-}
-
-
-void TinyObjLoader::drawObject(int drawmode)
-{
-
-	/* Draw the object as GL_POINTS */
-	glBindBuffer(GL_ARRAY_BUFFER, positionBufferObject);
-	glVertexAttribPointer(attribute_v_coord, 3, GL_FLOAT, GL_FALSE, 0, 0);
-	glEnableVertexAttribArray(attribute_v_coord);
-
-	/* Bind the object normals */
-	glBindBuffer(GL_ARRAY_BUFFER, normalBufferObject);
-	glVertexAttribPointer(attribute_v_normal, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-	glEnableVertexAttribArray(attribute_v_normal);
-
-	/* Bind the object texture coords if they exist */
-	glEnableVertexAttribArray(attribute_v_texcoord);
-	glBindBuffer(GL_ARRAY_BUFFER, texCoordsObject);
-	glVertexAttribPointer(attribute_v_texcoord, 2, GL_FLOAT, GL_FALSE, 0, (void*)0);
-
-	glPointSize(3.f);
-
-	// Enable this line to show model in wireframe
-	if (drawmode == 1)
-		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	else
-		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-
-	if (drawmode == 2)
-	{
-		glDrawArrays(GL_POINTS, 0, numVertices);
-	}
-	else
-	{
-		glDrawArrays(GL_TRIANGLES, 0, numVertices);
-	}
-}
-
-static void PrintInfo(const tinyobj::attrib_t& attrib,
-	const vector<tinyobj::shape_t>& shapes,
-	const vector<tinyobj::material_t>& materials) {
-	cout << "# of vertices  : " << (attrib.vertices.size() / 3) << endl;
-	cout << "# of normals   : " << (attrib.normals.size() / 3) << endl;
-	cout << "# of texcoords : " << (attrib.texcoords.size() / 2)
-		<< endl;
-
-	cout << "# of shapes    : " << shapes.size() << endl;
-	cout << "# of materials : " << materials.size() << endl;
-
-	for (size_t v = 0; v < attrib.vertices.size() / 3; v++) {
-		printf("  v[%ld] = (%f, %f, %f)\n", static_cast<long>(v),
-			static_cast<const double>(attrib.vertices[3 * v + 0]),
-			static_cast<const double>(attrib.vertices[3 * v + 1]),
-			static_cast<const double>(attrib.vertices[3 * v + 2]));
-	}
-
-	for (size_t v = 0; v < attrib.normals.size() / 3; v++) {
-		printf("  n[%ld] = (%f, %f, %f)\n", static_cast<long>(v),
-			static_cast<const double>(attrib.normals[3 * v + 0]),
-			static_cast<const double>(attrib.normals[3 * v + 1]),
-			static_cast<const double>(attrib.normals[3 * v + 2]));
-	}
-
-	for (size_t v = 0; v < attrib.texcoords.size() / 2; v++) {
-		printf("  uv[%ld] = (%f, %f)\n", static_cast<long>(v),
-			static_cast<const double>(attrib.texcoords[2 * v + 0]),
-			static_cast<const double>(attrib.texcoords[2 * v + 1]));
-	}
-
-	// For each shape
-	for (size_t i = 0; i < shapes.size(); i++) {
-		printf("shape[%ld].name = %s\n", static_cast<long>(i),
-			shapes[i].name.c_str());
-		printf("Size of shape[%ld].mesh.indices: %lu\n", static_cast<long>(i),
-			static_cast<unsigned long>(shapes[i].mesh.indices.size()));
-		printf("Size of shape[%ld].path.indices: %lu\n", static_cast<long>(i),
-			static_cast<unsigned long>(shapes[i].path.indices.size()));
-
-		size_t index_offset = 0;
-
-		assert(shapes[i].mesh.num_face_vertices.size() ==
-			shapes[i].mesh.material_ids.size());
-
-		assert(shapes[i].mesh.num_face_vertices.size() ==
-			shapes[i].mesh.smoothing_group_ids.size());
-
-		printf("shape[%ld].num_faces: %lu\n", static_cast<long>(i),
-			static_cast<unsigned long>(shapes[i].mesh.num_face_vertices.size()));
-
-		// For each face
-		for (size_t f = 0; f < shapes[i].mesh.num_face_vertices.size(); f++) {
-			size_t fnum = shapes[i].mesh.num_face_vertices[f];
-
-			printf("  face[%ld].fnum = %ld\n", static_cast<long>(f),
-				static_cast<unsigned long>(fnum));
-
-			// For each vertex in the face
-			for (size_t v = 0; v < fnum; v++) {
-				tinyobj::index_t idx = shapes[i].mesh.indices[index_offset + v];
-				printf("    face[%ld].v[%ld].idx = %d/%d/%d\n", static_cast<long>(f),
-					static_cast<long>(v), idx.vertex_index, idx.normal_index,
-					idx.texcoord_index);
-			}
-
-			printf("  face[%ld].material_id = %d\n", static_cast<long>(f),
-				shapes[i].mesh.material_ids[f]);
-			printf("  face[%ld].smoothing_group_id = %d\n", static_cast<long>(f),
-				shapes[i].mesh.smoothing_group_ids[f]);
-
-			index_offset += fnum;
-		}
-
-		printf("shape[%ld].num_tags: %lu\n", static_cast<long>(i),
-			static_cast<unsigned long>(shapes[i].mesh.tags.size()));
-		for (size_t t = 0; t < shapes[i].mesh.tags.size(); t++) {
-			printf("  tag[%ld] = %s ", static_cast<long>(t),
-				shapes[i].mesh.tags[t].name.c_str());
-			printf(" ints: [");
-			for (size_t j = 0; j < shapes[i].mesh.tags[t].intValues.size(); ++j) {
-				printf("%ld", static_cast<long>(shapes[i].mesh.tags[t].intValues[j]));
-				if (j < (shapes[i].mesh.tags[t].intValues.size() - 1)) {
-					printf(", ");
-				}
-			}
-			printf("]");
-
-			printf(" floats: [");
-			for (size_t j = 0; j < shapes[i].mesh.tags[t].floatValues.size(); ++j) {
-				printf("%f", static_cast<const double>(
-					shapes[i].mesh.tags[t].floatValues[j]));
-				if (j < (shapes[i].mesh.tags[t].floatValues.size() - 1)) {
-					printf(", ");
-				}
-			}
-			printf("]");
-
-			printf(" strings: [");
-			for (size_t j = 0; j < shapes[i].mesh.tags[t].stringValues.size(); ++j) {
-				printf("%s", shapes[i].mesh.tags[t].stringValues[j].c_str());
-				if (j < (shapes[i].mesh.tags[t].stringValues.size() - 1)) {
-					printf(", ");
-				}
-			}
-			printf("]");
-			printf("\n");
-		}
-	}
-
-	for (size_t i = 0; i < materials.size(); i++) {
-		printf("material[%ld].name = %s\n", static_cast<long>(i),
-			materials[i].name.c_str());
-		printf("  material.Ka = (%f, %f ,%f)\n",
-			static_cast<const double>(materials[i].ambient[0]),
-			static_cast<const double>(materials[i].ambient[1]),
-			static_cast<const double>(materials[i].ambient[2]));
-		printf("  material.Kd = (%f, %f ,%f)\n",
-			static_cast<const double>(materials[i].diffuse[0]),
-			static_cast<const double>(materials[i].diffuse[1]),
-			static_cast<const double>(materials[i].diffuse[2]));
-		printf("  material.Ks = (%f, %f ,%f)\n",
-			static_cast<const double>(materials[i].specular[0]),
-			static_cast<const double>(materials[i].specular[1]),
-			static_cast<const double>(materials[i].specular[2]));
-		printf("  material.Tr = (%f, %f ,%f)\n",
-			static_cast<const double>(materials[i].transmittance[0]),
-			static_cast<const double>(materials[i].transmittance[1]),
-			static_cast<const double>(materials[i].transmittance[2]));
-		printf("  material.Ke = (%f, %f ,%f)\n",
-			static_cast<const double>(materials[i].emission[0]),
-			static_cast<const double>(materials[i].emission[1]),
-			static_cast<const double>(materials[i].emission[2]));
-		printf("  material.Ns = %f\n",
-			static_cast<const double>(materials[i].shininess));
-		printf("  material.Ni = %f\n", static_cast<const double>(materials[i].ior));
-		printf("  material.dissolve = %f\n",
-			static_cast<const double>(materials[i].dissolve));
-		printf("  material.illum = %d\n", materials[i].illum);
-		printf("  material.map_Ka = %s\n", materials[i].ambient_texname.c_str());
-		printf("  material.map_Kd = %s\n", materials[i].diffuse_texname.c_str());
-		printf("  material.map_Ks = %s\n", materials[i].specular_texname.c_str());
-		printf("  material.map_Ns = %s\n",
-			materials[i].specular_highlight_texname.c_str());
-		printf("  material.map_bump = %s\n", materials[i].bump_texname.c_str());
-		printf("    bump_multiplier = %f\n", static_cast<const double>(materials[i].bump_texopt.bump_multiplier));
-		printf("  material.map_d = %s\n", materials[i].alpha_texname.c_str());
-		printf("  material.disp = %s\n", materials[i].displacement_texname.c_str());
-		printf("  <<PBR>>\n");
-		printf("  material.Pr     = %f\n", static_cast<const double>(materials[i].roughness));
-		printf("  material.Pm     = %f\n", static_cast<const double>(materials[i].metallic));
-		printf("  material.Ps     = %f\n", static_cast<const double>(materials[i].sheen));
-		printf("  material.Pc     = %f\n", static_cast<const double>(materials[i].clearcoat_thickness));
-		printf("  material.Pcr    = %f\n", static_cast<const double>(materials[i].clearcoat_thickness));
-		printf("  material.aniso  = %f\n", static_cast<const double>(materials[i].anisotropy));
-		printf("  material.anisor = %f\n", static_cast<const double>(materials[i].anisotropy_rotation));
-		printf("  material.map_Ke = %s\n", materials[i].emissive_texname.c_str());
-		printf("  material.map_Pr = %s\n", materials[i].roughness_texname.c_str());
-		printf("  material.map_Pm = %s\n", materials[i].metallic_texname.c_str());
-		printf("  material.map_Ps = %s\n", materials[i].sheen_texname.c_str());
-		printf("  material.norm   = %s\n", materials[i].normal_texname.c_str());
-		map<string, string>::const_iterator it(
-			materials[i].unknown_parameter.begin());
-		map<string, string>::const_iterator itEnd(
-			materials[i].unknown_parameter.end());
-
-		for (; it != itEnd; it++) {
-			printf("  material.%s = %s\n", it->first.c_str(), it->second.c_str());
-		}
-		printf("\n");
-	}
+/* tiny_loader_texture.cpp
+Example class to demonstrate the use of TinyObjectLoader to load an obj (WaveFront)
+object file with normals and texture coordinates, and copy the data into vertex, normal texture coordinate buffers.
+The triangles are reordered for the vertex cache and overdraw, see optimizeMesh().
+The compiled mesh is cached in a binary .mesh file next to the obj file, see loadCache().
+With setQuantizeEnabled(true) the vertices are uploaded as quantized_vertex, half the size.
+A colour buffer is not included as it is expected that the colour be taken form the texture.
+Please be careful to match the vertex attribute indices in your shaders. See code in the
+constructor:
+
+	attribute_v_coord = 0;
+	attribute_v_normal = 1;
+	attribute_v_texcoord = 2;
+
+Iain Martin November 2018
+*/
+
+#include "tiny_loader_texture.h"
+#include "mapped_file.h"
+#include "mesh_optimizer.h"
+#include "vertex_quantize.h"
+#include "perf_stats.h"
+#include <algorithm>
+#include <iostream>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unordered_map>
+
+//Tinyobjloader library used to import models
+#ifndef TINYOBJLOADER_IMPLEMENTATION
+	#define TINYOBJLOADER_IMPLEMENTATION // define this in only *one* .cc
+	#include "tiny_obj_loader.h"
+#endif
+
+using namespace std;
+using namespace glm;
+
+/* Entries in the post transform cache modelled by printVertexStats() */
+const GLuint VERTEX_CACHE_SIZE = 32;
+
+/* Bytes per interleaved vertex: position, normal and texture coordinate */
+const GLuint MESH_VERTEX_STRIDE = 8 * sizeof(GLfloat);
+
+/* Quantized vertex, see vertex_quantize.h */
+struct quantized_vertex
+{
+	GLushort position[4];			// Normalized across the bounds, the 4th keeps the normal aligned
+	GLshort normal[2];				// Octahedral
+	GLushort texcoord[2];			// Half floats
+};
+
+/* A face corner is identified by its position, normal and texture coordinate indices
+   in the obj file. Corners with the same key become one vertex */
+struct corner_key
+{
+	int vertex, normal, texcoord;
+	bool operator==(const corner_key& k) const
+	{
+		return vertex == k.vertex && normal == k.normal && texcoord == k.texcoord;
+	}
+};
+
+struct corner_hash
+{
+	size_t operator()(const corner_key& k) const
+	{
+		return ((size_t)(unsigned)k.vertex * 73856093u) ^ ((size_t)(unsigned)k.normal * 19349663u)
+			^ ((size_t)(unsigned)k.texcoord * 83492791u);
+	}
+};
+
+/* Bounds of the positions, and the vertices quantized across them if packed isn't NULL */
+static quantize_bounds quantizeVertices(const vector<GLfloat>& vertexData, vector<quantized_vertex>* packed)
+{
+	const GLuint stride = MESH_VERTEX_STRIDE / sizeof(GLfloat);
+	size_t num_vertices = vertexData.size() / stride;
+	quantize_bounds bounds = quantizeBounds(vertexData.data(), num_vertices, stride);
+	if (!packed) return bounds;
+
+	packed->resize(num_vertices);
+	for (size_t v = 0; v < num_vertices; v++)
+	{
+		const GLfloat* source = &vertexData[v * stride];
+		quantized_vertex& q = (*packed)[v];
+		quantizePosition(bounds, source, q.position);
+		q.position[3] = 0;
+		quantizeNormal(vec3(source[3], source[4], source[5]), q.normal);
+		q.texcoord[0] = quantizeHalf(source[6]);
+		q.texcoord[1] = quantizeHalf(source[7]);
+	}
+	return bounds;
+}
+
+// Debig print method to print out the attributres loaded from the obj file
+static  void PrintInfo(const tinyobj::attrib_t& attrib,
+	const vector<tinyobj::shape_t>& shapes,
+	const vector<tinyobj::material_t>& materials); 
+
+TinyObjLoader::TinyObjLoader()
+{
+	attribute_v_coord = 0;
+	attribute_v_normal = 1;
+	attribute_v_texcoord = 2;
+
+	vertexBufferObject = 0;
+	elementBufferObject = 0;
+	numVertices = 0;
+	numNormals = 0;
+	numTexCoords = 0;
+	numPIndexes = 0;
+	numCorners = 0;
+	cacheMisses = 0;
+	fileOrderMisses = 0;
+	vertexStride = MESH_VERTEX_STRIDE;
+	indexType = GL_UNSIGNED_INT;
+	jobs = &job_system::shared();
+	use_cache = true;
+	optimize = true;
+	quantize = false;
+	quantized = false;
+	dequantize = mat4(1.0f);
+	vertex_format_id = (GLuint)-1;
+	loaded_from_cache = false;
+}
+
+TinyObjLoader::~TinyObjLoader()
+{
+}
+
+
+void TinyObjLoader::setCacheEnabled(bool enable)
+{
+	use_cache = enable;
+}
+
+
+void TinyObjLoader::setJobSystem(job_system* pool)
+{
+	jobs = pool;
+}
+
+
+void TinyObjLoader::setOptimizeEnabled(bool enable)
+{
+	optimize = enable;
+}
+
+
+void TinyObjLoader::setQuantizeEnabled(bool enable)
+{
+	quantize = enable;
+}
+
+
+/* Look up the uniform in program (e.g. object_loader_texture.vert) that says whether the
+   normals need octDecode(). drawObject() sets it */
+void TinyObjLoader::setFormatUniforms(GLuint program)
+{
+	vertex_format_id = glGetUniformLocation(program, "vertex_format");
+}
+
+
+/* Load the mesh from its .mesh file if that was compiled from this obj file, otherwise
+   parse the obj text and write the .mesh file for next time */
+void TinyObjLoader::load_obj(string inputfile, bool debugPrint)
+{
+	loaded_from_cache = use_cache && !debugPrint && loadCache(inputfile);
+	if (loaded_from_cache) return;
+
+	vector<GLfloat> vertexData;
+	vector<GLuint> pIndices;
+	parseObj(inputfile, debugPrint, vertexData, pIndices);
+
+	// 16 bit indices when they are enough, half the index data
+	vector<GLushort> shortIndices;
+	const void* indexData = &pIndices.front();
+	indexType = GL_UNSIGNED_INT;
+	if (numVertices <= 65536)
+	{
+		shortIndices.assign(pIndices.begin(), pIndices.end());
+		indexData = &shortIndices.front();
+		indexType = GL_UNSIGNED_SHORT;
+	}
+
+	// Quantized vertices replace the floats in the buffer and in the .mesh file
+	vector<quantized_vertex> packed;
+	const void* vertices = &vertexData.front();
+	setQuantized(quantize, quantizeVertices(vertexData, quantize ? &packed : NULL));
+	if (quantize) vertices = &packed.front();
+
+	if (use_cache && !saveCache(inputfile, vertices, indexData))
+		cout << "TinyObjLoader: could not write the mesh cache " << cachePath(inputfile) << endl;
+
+	upload(vertices, indexData);
+	printVertexStats();
+}
+
+
+/* Parallel obj parsing: the file is memory mapped and split at line boundaries into
+   chunks of OBJ_CHUNK_SIZE bytes, which the job system threads parse on their own.
+   Vertex lines are parsed straight into per chunk arrays, face lines into raw
+   indices, and the few lines that change the shape state (usemtl, mtllib, g, o, s)
+   are kept to replay. Then the chunk arrays are joined, relative and one based face
+   indices are fixed with the vertex counts summed over the chunks before, and the
+   faces and state lines are replayed in file order through the same code as
+   tinyobj::LoadObj, so the result is the same as parsing the file with it.
+   Each line is parsed with tinyobj's own number parsers, so the numbers are the same
+   to the bit */
+
+/* Bytes of obj text per parsing job */
+const size_t OBJ_CHUNK_SIZE = 256 * 1024;
+
+/* A line replayed in file order: a face, or a line that changes the shape state */
+struct obj_record
+{
+	char type;						// 'f'ace, 'u'semtl, 'm'tllib, 'g'roup, 'o'bject, 's'moothing
+	GLuint line;					// Line in the chunk, from 0
+	GLuint first, count;			// Face: corners in obj_chunk::corners. Else: byte offset and length in the chunk
+	GLuint num_v, num_vn, num_vt;	// Positions, normals and texcoords before the line in the chunk
+};
+
+struct obj_chunk
+{
+	const char* begin;
+	const char* end;
+	vector<tinyobj::real_t> v, vn, vt, vc;
+	vector<int> corners;			// v, vt, vn index of each face corner, as written (0 = none) then fixed
+	vector<obj_record> records;
+	GLuint lines;
+	bool unsupported;				// Something only tinyobj::LoadObj handles, or an error it should report
+};
+
+/* Copy a line without its line ending and with a terminating 0 for tinyobj's parsers,
+   skipping the leading space like LoadObj */
+static const char* lineToken(string& buffer, const char* begin, const char* end)
+{
+	buffer.assign(begin, end);
+	const char* token = buffer.c_str();
+	return token + strspn(token, " \t");
+}
+
+/* One face corner like tinyobj::parseTriple, keeping the indices as written: i, i/j,
+   i//k or i/j/k. False for a zero index, which LoadObj reports as an error */
+static bool parseCorner(const char** token, int* raw)
+{
+	raw[0] = atoi(*token);
+	raw[1] = raw[2] = 0;
+	if (raw[0] == 0) return false;
+	(*token) += strcspn((*token), "/ \t\r");
+	if ((*token)[0] != '/') return true;
+	(*token)++;
+
+	// i//k
+	if ((*token)[0] == '/')
+	{
+		(*token)++;
+		raw[2] = atoi(*token);
+		(*token) += strcspn((*token), "/ \t\r");
+		return raw[2] != 0;
+	}
+
+	// i/j/k or i/j
+	raw[1] = atoi(*token);
+	if (raw[1] == 0) return false;
+	(*token) += strcspn((*token), "/ \t\r");
+	if ((*token)[0] != '/') return true;
+	(*token)++;
+	raw[2] = atoi(*token);
+	(*token) += strcspn((*token), "/ \t\r");
+	return raw[2] != 0;
+}
+
+static void parseChunk(obj_chunk& chunk)
+{
+	string buffer;
+	const char* p = chunk.begin;
+	while (p < chunk.end)
+	{
+		const char* line_begin = p;
+		const char* line_end = (const char*)memchr(p, '\n', chunk.end - p);
+		if (!line_end) line_end = chunk.end;
+		p = (line_end < chunk.end) ? line_end + 1 : chunk.end;
+		GLuint line = chunk.lines++;
+
+		// LoadObj also ends lines at a lone '\r', which would change the line numbers
+		if (line_end > line_begin && line_end[-1] == '\r') line_end--;
+		if (memchr(line_begin, '\r', line_end - line_begin))
+		{
+			chunk.unsupported = true;
+			return;
+		}
+		if (line_end == line_begin) continue;
+
+		const char* token = lineToken(buffer, line_begin, line_end);
+		if (token[0] == '\0' || token[0] == '#') continue;
+
+		// vertex
+		if (token[0] == 'v' && IS_SPACE(token[1]))
+		{
+			token += 2;
+			tinyobj::real_t x, y, z, r, g, b;
+			tinyobj::parseVertexWithColor(&x, &y, &z, &r, &g, &b, &token);
+			chunk.v.push_back(x);
+			chunk.v.push_back(y);
+			chunk.v.push_back(z);
+			chunk.vc.push_back(r);
+			chunk.vc.push_back(g);
+			chunk.vc.push_back(b);
+			continue;
+		}
+
+		// normal
+		if (token[0] == 'v' && token[1] == 'n' && IS_SPACE(token[2]))
+		{
+			token += 3;
+			tinyobj::real_t x, y, z;
+			tinyobj::parseReal3(&x, &y, &z, &token);
+			chunk.vn.push_back(x);
+			chunk.vn.push_back(y);
+			chunk.vn.push_back(z);
+			continue;
+		}
+
+		// texcoord
+		if (token[0] == 'v' && token[1] == 't' && IS_SPACE(token[2]))
+		{
+			token += 3;
+			tinyobj::real_t x, y;
+			tinyobj::parseReal2(&x, &y, &token);
+			chunk.vt.push_back(x);
+			chunk.vt.push_back(y);
+			continue;
+		}
+
+		// Lines and tags are rare, leave them to LoadObj
+		if ((token[0] == 'l' || token[0] == 't') && IS_SPACE(token[1]))
+		{
+			chunk.unsupported = true;
+			return;
+		}
+
+		obj_record record;
+		record.line = line;
+		record.num_v = (GLuint)chunk.v.size() / 3;
+		record.num_vn = (GLuint)chunk.vn.size() / 3;
+		record.num_vt = (GLuint)chunk.vt.size() / 2;
+
+		// face
+		if (token[0] == 'f' && IS_SPACE(token[1]))
+		{
+			token += 2;
+			token += strspn(token, " \t");
+			record.type = 'f';
+			record.first = (GLuint)chunk.corners.size() / 3;
+			record.count = 0;
+			while (!IS_NEW_LINE(token[0]))
+			{
+				int raw[3];
+				if (!parseCorner(&token, raw))
+				{
+					chunk.unsupported = true;
+					return;
+				}
+				chunk.corners.insert(chunk.corners.end(), raw, raw + 3);
+				record.count++;
+				token += strspn(token, " \t\r");
+			}
+			chunk.records.push_back(record);
+			continue;
+		}
+
+		// Lines that change the shape state are replayed from the text
+		if ((0 == strncmp(token, "usemtl", 6)) && IS_SPACE(token[6])) record.type = 'u';
+		else if ((0 == strncmp(token, "mtllib", 6)) && IS_SPACE(token[6])) record.type = 'm';
+		else if ((token[0] == 'g' || token[0] == 'o' || token[0] == 's') && IS_SPACE(token[1])) record.type = token[0];
+		else continue;	// Ignore unknown command
+		record.first = (GLuint)(line_begin - chunk.begin);
+		record.count = (GLuint)(line_end - line_begin);
+		chunk.records.push_back(record);
+	}
+}
+
+/* Index as written to zero based like tinyobj::fixIndex, -1 if it isn't in 0..n-1
+   (LoadObj keeps those, the loader couldn't use them anyway) */
+static inline int fixCorner(int raw, int n)
+{
+	int index = raw > 0 ? raw - 1 : n + raw;
+	return (index >= 0 && index < n) ? index : -1;
+}
+
+/* Parse an obj file on the job system threads. Returns false without touching the
+   outputs if the file has something only tinyobj::LoadObj handles (or an error for it
+   to report), so the caller can fall back to it */
+static bool loadObjParallel(tinyobj::attrib_t* attrib, vector<tinyobj::shape_t>* shapes,
+	vector<tinyobj::material_t>* materials, string* warn, string* err, const string& filename,
+	const string& mtl_basedir, job_system* jobs)
+{
+	mapped_file file;
+	if (!file.open(filename.c_str())) return false;
+
+	// Chunks end at line boundaries
+	vector<obj_chunk> chunks;
+	const char* text = (const char*)file.data();
+	const char* text_end = text + file.size();
+	for (const char* p = text; p < text_end;)
+	{
+		const char* end = p + std::min(OBJ_CHUNK_SIZE, size_t(text_end - p));
+		if (end < text_end)
+		{
+			const char* eol = (const char*)memchr(end, '\n', text_end - end);
+			end = eol ? eol + 1 : text_end;
+		}
+		chunks.push_back(obj_chunk());
+		chunks.back().begin = p;
+		chunks.back().end = end;
+		chunks.back().lines = 0;
+		chunks.back().unsupported = false;
+		p = end;
+	}
+
+	jobs->parallelFor((GLuint)chunks.size(), 1, [&chunks](GLuint first, GLuint last)
+	{
+		for (GLuint c = first; c < last; c++) parseChunk(chunks[c]);
+	});
+
+	// Totals before each chunk
+	size_t count = chunks.size();
+	vector<size_t> v_base(count + 1, 0), vn_base(count + 1, 0), vt_base(count + 1, 0), line_base(count + 1, 0);
+	for (size_t c = 0; c < count; c++)
+	{
+		if (chunks[c].unsupported) return false;
+		v_base[c + 1] = v_base[c] + chunks[c].v.size();
+		vn_base[c + 1] = vn_base[c] + chunks[c].vn.size();
+		vt_base[c + 1] = vt_base[c] + chunks[c].vt.size();
+		line_base[c + 1] = line_base[c] + chunks[c].lines;
+	}
+
+	// Fix the face indices. A corner outside the vertices read so far goes to LoadObj,
+	// which keeps it and warns
+	bool out_of_range = false;
+	jobs->parallelFor((GLuint)count, 1, [&](GLuint first, GLuint last)
+	{
+		for (GLuint c = first; c < last; c++)
+			for (size_t r = 0; r < chunks[c].records.size(); r++)
+			{
+				const obj_record& record = chunks[c].records[r];
+				if (record.type != 'f') continue;
+				int num_v = int(v_base[c] / 3 + record.num_v);
+				int num_vn = int(vn_base[c] / 3 + record.num_vn);
+				int num_vt = int(vt_base[c] / 2 + record.num_vt);
+				int* corner = &chunks[c].corners[record.first * 3];
+				for (GLuint i = 0; i < record.count; i++, corner += 3)
+				{
+					int v = fixCorner(corner[0], num_v);
+					int vt = corner[1] ? fixCorner(corner[1], num_vt) : -1;
+					int vn = corner[2] ? fixCorner(corner[2], num_vn) : -1;
+					if (v < 0 || (corner[1] && vt < 0) || (corner[2] && vn < 0)) out_of_range = true;
+					corner[0] = v;
+					corner[1] = vt;
+					corner[2] = vn;
+				}
+			}
+	});
+	if (out_of_range) return false;
+
+	// Join the vertex arrays, default vertex colours are kept like LoadObj
+	attrib->vertices.resize(v_base[count]);
+	attrib->normals.resize(vn_base[count]);
+	attrib->texcoords.resize(vt_base[count]);
+	attrib->colors.resize(v_base[count]);
+	jobs->parallelFor((GLuint)count, 1, [&](GLuint first, GLuint last)
+	{
+		for (GLuint c = first; c < last; c++)
+		{
+			std::copy(chunks[c].v.begin(), chunks[c].v.end(), attrib->vertices.begin() + v_base[c]);
+			std::copy(chunks[c].vc.begin(), chunks[c].vc.end(), attrib->colors.begin() + v_base[c]);
+			std::copy(chunks[c].vn.begin(), chunks[c].vn.end(), attrib->normals.begin() + vn_base[c]);
+			std::copy(chunks[c].vt.begin(), chunks[c].vt.end(), attrib->texcoords.begin() + vt_base[c]);
+		}
+	});
+
+	// Replay the faces and state lines in file order, as in tinyobj::LoadObj
+	string baseDir = mtl_basedir;
+	if (!baseDir.empty())
+	{
+#ifndef _WIN32
+		const char dirsep = '/';
+#else
+		const char dirsep = '\\';
+#endif
+		if (baseDir[baseDir.length() - 1] != dirsep) baseDir += dirsep;
+	}
+	tinyobj::MaterialFileReader readMatFn(baseDir);
+
+	const vector<tinyobj::real_t>& v = attrib->vertices;
+	vector<tinyobj::tag_t> tags;
+	vector<tinyobj::face_t> faceGroup;
+	vector<int> lineGroup;
+	string name;
+	std::map<string, int> material_map;
+	int material = -1;
+	unsigned int current_smoothing_id = 0;
+	tinyobj::shape_t shape;
+	shapes->clear();
+	string buffer;
+
+	for (size_t c = 0; c < count; c++)
+		for (size_t r = 0; r < chunks[c].records.size(); r++)
+		{
+			const obj_record& record = chunks[c].records[r];
+			size_t line_num = line_base[c] + record.line + 1;
+
+			if (record.type == 'f')
+			{
+				tinyobj::face_t face;
+				face.smoothing_group_id = current_smoothing_id;
+				face.vertex_indices.resize(record.count);
+				const int* corner = &chunks[c].corners[record.first * 3];
+				for (GLuint i = 0; i < record.count; i++, corner += 3)
+					face.vertex_indices[i] = tinyobj::vertex_index_t(corner[0], corner[1], corner[2]);
+				faceGroup.push_back(face);
+				continue;
+			}
+
+			const char* token = lineToken(buffer, chunks[c].begin + record.first, chunks[c].begin + record.first + record.count);
+
+			// use mtl
+			if (record.type == 'u')
+			{
+				token += 7;
+				std::stringstream ss;
+				ss << token;
+				string namebuf = ss.str();
+
+				int newMaterialId = -1;
+				if (material_map.find(namebuf) != material_map.end())
+					newMaterialId = material_map[namebuf];
+
+				if (newMaterialId != material)
+				{
+					tinyobj::exportGroupsToShape(&shape, faceGroup, lineGroup, tags, material, name, true, v);
+					faceGroup.clear();
+					material = newMaterialId;
+				}
+			}
+
+			// load mtl
+			else if (record.type == 'm')
+			{
+				token += 7;
+				vector<string> filenames;
+				tinyobj::SplitString(string(token), ' ', filenames);
+
+				if (filenames.empty())
+				{
+					std::stringstream ss;
+					ss << "Looks like empty filename for mtllib. Use default "
+						"material (line " << line_num << ".)\n";
+					(*warn) += ss.str();
+				}
+				else
+				{
+					bool found = false;
+					for (size_t s = 0; s < filenames.size(); s++)
+					{
+						string warn_mtl, err_mtl;
+						bool ok = readMatFn(filenames[s].c_str(), materials, &material_map, &warn_mtl, &err_mtl);
+						(*warn) += warn_mtl;
+						(*err) += err_mtl;
+						if (ok)
+						{
+							found = true;
+							break;
+						}
+					}
+					if (!found) (*warn) += "Failed to load material file(s). Use default material.\n";
+				}
+			}
+
+			// group name
+			else if (record.type == 'g')
+			{
+				tinyobj::exportGroupsToShape(&shape, faceGroup, lineGroup, tags, material, name, true, v);
+				if (shape.mesh.indices.size() > 0) shapes->push_back(shape);
+				shape = tinyobj::shape_t();
+				faceGroup.clear();
+
+				vector<string> names;
+				while (!IS_NEW_LINE(token[0]))
+				{
+					names.push_back(tinyobj::parseString(&token));
+					token += strspn(token, " \t\r");
+				}
+
+				if (names.size() < 2)
+				{
+					std::stringstream ss;
+					ss << "Empty group name. line: " << line_num << "\n";
+					(*warn) += ss.str();
+					name = "";
+				}
+				else
+				{
+					std::stringstream ss;
+					ss << names[1];
+					for (size_t i = 2; i < names.size(); i++) ss << " " << names[i];
+					name = ss.str();
+				}
+			}
+
+			// object name
+			else if (record.type == 'o')
+			{
+				if (tinyobj::exportGroupsToShape(&shape, faceGroup, lineGroup, tags, material, name, true, v))
+					shapes->push_back(shape);
+				faceGroup.clear();
+				shape = tinyobj::shape_t();
+
+				token += 2;
+				std::stringstream ss;
+				ss << token;
+				name = ss.str();
+			}
+
+			// smoothing group id
+			else if (record.type == 's')
+			{
+				token += 2;
+				token += strspn(token, " \t");
+				if (token[0] == '\0') continue;
+				if (token[0] == '\r' || token[1] == '\n') continue;
+
+				if (strlen(token) >= 3)
+				{
+					if (token[0] == 'o' && token[1] == 'f' && token[2] == 'f') current_smoothing_id = 0;
+				}
+				else
+				{
+					int smGroupId = tinyobj::parseInt(&token);
+					current_smoothing_id = smGroupId < 0 ? 0 : (unsigned int)smGroupId;
+				}
+			}
+		}
+
+	bool ret = tinyobj::exportGroupsToShape(&shape, faceGroup, lineGroup, tags, material, name, true, v);
+	if (ret || shape.mesh.indices.size()) shapes->push_back(shape);
+	return true;
+}
+
+
+/* Reorder the triangles of each submesh for the vertex cache and then for overdraw,
+   around the centre of the whole mesh, and renumber the vertices in the order the
+   indices now use them. The submesh index ranges stay where they were */
+static void optimizeMesh(vector<GLfloat>& vertexData, vector<GLuint>& indices, const vector<mesh_submesh>& submeshes)
+{
+	const GLuint stride = MESH_VERTEX_STRIDE / sizeof(GLfloat);
+	GLuint num_vertices = GLuint(vertexData.size() / stride);
+	if (indices.empty()) return;
+
+	vec3 centre = meshCentroid(indices.data(), indices.size(), vertexData.data(), stride);
+	for (size_t s = 0; s < submeshes.size(); s++)
+	{
+		GLuint* range = indices.data() + submeshes[s].first_index;
+		optimizeVertexCache(range, submeshes[s].num_indices, num_vertices);
+		optimizeOverdraw(range, submeshes[s].num_indices, vertexData.data(), stride, num_vertices, centre, VERTEX_CACHE_SIZE);
+	}
+	optimizeVertexFetch(indices.data(), indices.size(), vertexData.data(), stride, num_vertices);
+}
+
+
+void TinyObjLoader::setQuantized(bool enable, const quantize_bounds& quantize_bounds)
+{
+	quantized = enable;
+	bounds = quantize_bounds;
+	vertexStride = quantized ? sizeof(quantized_vertex) : MESH_VERTEX_STRIDE;
+	dequantize = quantized ? bounds.dequantize() : mat4(1.0f);
+}
+
+
+void TinyObjLoader::parseObj(const string& inputfile, bool debugPrint, vector<GLfloat>& vertexData, vector<GLuint>& pIndices)
+{
+	tinyobj::attrib_t attrib;
+	vector<tinyobj::shape_t> shapes;
+	vector<tinyobj::material_t> objMaterials;
+
+	// Materials are looked for in the obj file's directory
+	string base_dir;
+	size_t slash = inputfile.find_last_of("/\\");
+	if (slash != string::npos) base_dir = inputfile.substr(0, slash + 1);
+
+	// Large files parse on the job system threads, anything the parallel parser
+	// doesn't handle goes to tinyobj::LoadObj
+	string err, warn;
+	bool ret = jobs && loadObjParallel(&attrib, &shapes, &objMaterials, &err, &warn, inputfile, base_dir, jobs);
+	if (!ret)
+		ret = tinyobj::LoadObj(&attrib, &shapes, &objMaterials, &err, &warn, inputfile.c_str(), base_dir.c_str());
+
+	if (!err.empty()) { // `err` may contain error messages.
+		cerr << err << endl;
+	}
+	
+	if (!err.empty()) { // `warn` may contain warning messages.
+		cerr << err << endl;
+	}
+
+	if (!ret) {
+		exit(1);
+	}
+
+	// Debug print if requested to
+	if (debugPrint)	PrintInfo(attrib, shapes, objMaterials);
+
+	// Calculate the number of face corners from the shapes
+	numCorners = 0;
+	for (size_t s = 0; s < shapes.size(); s++) {
+		numCorners += shapes[s].mesh.num_face_vertices.size() * 3;//3 vertexes for each face
+	}
+
+	// Corners can't share a vertex just because they share a position, the normal or
+	// texture coordinate may differ. So each distinct (position, normal, texcoord) index
+	// triple becomes a vertex, and the faces are drawn from an index buffer
+	unordered_map<corner_key, GLuint, corner_hash> unique;
+	unique.reserve(numCorners);
+	pIndices.clear();
+	pIndices.reserve(numCorners);
+	vertexData.clear();
+	submeshes.clear();
+
+	for (size_t s = 0; s < shapes.size(); s++) {
+
+		// Loop over faces(polygon)
+		size_t index_offset = 0;
+
+		//number of faces; vert, text, norm
+		for (size_t f = 0; f < shapes[s].mesh.num_face_vertices.size(); f++) 
+		{
+			int fv = shapes[s].mesh.num_face_vertices[f];//number of vertices per face (3)
+
+			// A new submesh at the start of each shape and wherever the material changes
+			GLint material = shapes[s].mesh.material_ids[f];
+			if (f == 0 || submeshes.back().material != material)
+			{
+				mesh_submesh submesh = { (GLuint)pIndices.size(), 0, material };
+				submeshes.push_back(submesh);
+			}
+			submeshes.back().num_indices += fv;
+
+			// Loop over vertices in the face.
+			for (size_t v = 0; v < fv; v++) 
+			{
+				// access to vertex
+				tinyobj::index_t idx = shapes[s].mesh.indices[index_offset + v];
+				corner_key key = { idx.vertex_index, idx.normal_index, idx.texcoord_index };
+				auto found = unique.emplace(key, (GLuint)unique.size());
+				pIndices.push_back(found.first->second);
+				if (!found.second) continue;
+
+				// First time this corner is seen, add a vertex: position, normal and
+				// texture coordinate interleaved. Missing normals and texture
+				// coordinates are zero
+				for (int c = 0; c < 3; c++)
+					vertexData.push_back(attrib.vertices[3 * idx.vertex_index + c]);
+				for (int c = 0; c < 3; c++)
+					vertexData.push_back(idx.normal_index < 0 ? 0 : attrib.normals[3 * idx.normal_index + c]);
+				for (int c = 0; c < 2; c++)
+					vertexData.push_back(idx.texcoord_index < 0 ? 0 : attrib.texcoords[2 * idx.texcoord_index + c]);
+			}
+			index_offset += fv;
+		}
+	}
+
+	numVertices = (GLuint)unique.size();
+	numNormals = numTexCoords = numVertices;
+	numPIndexes = (GLuint)pIndices.size();
+
+	materials.resize(objMaterials.size());
+	for (size_t m = 0; m < objMaterials.size(); m++)
+	{
+		mesh_material& material = materials[m];
+		memset(&material, 0, sizeof(material));
+		strncpy(material.name, objMaterials[m].name.c_str(), sizeof(material.name) - 1);
+		strncpy(material.diffuse_texname, objMaterials[m].diffuse_texname.c_str(), sizeof(material.diffuse_texname) - 1);
+		for (int c = 0; c < 3; c++)
+		{
+			material.ambient[c] = objMaterials[m].ambient[c];
+			material.diffuse[c] = objMaterials[m].diffuse[c];
+			material.specular[c] = objMaterials[m].specular[c];
+		}
+		material.shininess = objMaterials[m].shininess;
+	}
+
+	// Vertex shader runs with a FIFO post transform cache: a vertex runs again once
+	// VERTEX_CACHE_SIZE other vertices have gone through since it last ran
+	fileOrderMisses = fifoCacheMisses(pIndices.data(), pIndices.size(), numVertices, VERTEX_CACHE_SIZE);
+	cacheMisses = fileOrderMisses;
+	if (optimize)
+	{
+		optimizeMesh(vertexData, pIndices, submeshes);
+		cacheMisses = fifoCacheMisses(pIndices.data(), pIndices.size(), numVertices, VERTEX_CACHE_SIZE);
+	}
+}
+
+
+/* Copy the interleaved vertices and the indices into OpenGL buffers */
+void TinyObjLoader::upload(const void* vertexData, const void* indexData)
+{
+	size_t index_bytes = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+
+	if (!vertexBufferObject) glGenBuffers(1, &vertexBufferObject);
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBufferObject);
+	glBufferData(GL_ARRAY_BUFFER, numVertices * vertexStride, vertexData, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (!elementBufferObject) glGenBuffers(1, &elementBufferObject);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBufferObject);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, numPIndexes * index_bytes, indexData, GL_STATIC_DRAW);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+
+/* Binary mesh file: this header, the interleaved vertices (num_vertices *
+   vertex_stride bytes, float or quantized), the indices (num_indices of index_size bytes), then the
+   submesh and material tables. Bump MESH_CACHE_VERSION whenever the layout or the
+   way the mesh is built changes */
+const GLuint MESH_CACHE_VERSION = 3;
+
+struct mesh_cache_header
+{
+	char magic[8];
+	GLuint version;
+	GLuint vertex_stride;
+
+	// Key: the obj file the mesh was compiled from
+	unsigned long long source_size;
+	long long source_mtime;
+	GLuint source_hash;				// FNV-1a of the obj text, checked when the mtime has changed
+
+	GLuint num_vertices;
+	GLuint num_indices;
+	GLuint index_size;
+	GLuint num_submeshes;
+	GLuint num_materials;
+	GLuint num_corners;
+	GLuint cache_misses;
+	GLuint file_order_misses;
+	GLuint optimized;				// Built with optimizeMesh(), a different mesh from the same obj
+	GLfloat bounds_origin[3];		// Dequantization of quantized positions
+	GLfloat bounds_scale;
+};
+
+/* FNV-1a hash of a whole file, 0 if it can't be read */
+static GLuint fileHash(const string& path)
+{
+	mapped_file file;
+	if (!file.open(path.c_str())) return 0;
+	GLuint hash = 2166136261u;
+	const unsigned char* p = file.data();
+	for (size_t i = 0; i < file.size(); i++)
+		hash = (hash ^ p[i]) * 16777619u;
+	return hash;
+}
+
+/* Size and modification time of the obj file, false if it doesn't exist */
+static bool sourceStamp(const string& path, unsigned long long& size, long long& mtime)
+{
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) return false;
+	size = (unsigned long long)st.st_size;
+	mtime = (long long)st.st_mtime;
+	return true;
+}
+
+/* Store a new modification time in the header of a .mesh file whose obj has been
+   touched but not changed, so later loads don't hash the obj again */
+static void restampCache(const string& path, long long mtime)
+{
+	FILE* f = fopen(path.c_str(), "r+b");
+	if (!f) return;
+	if (fseek(f, offsetof(mesh_cache_header, source_mtime), SEEK_SET) == 0)
+		fwrite(&mtime, sizeof(mtime), 1, f);
+	fclose(f);
+}
+
+
+/* name.obj -> name.mesh in the same directory */
+string TinyObjLoader::cachePath(const string& inputfile)
+{
+	size_t dot = inputfile.find_last_of('.');
+	size_t slash = inputfile.find_last_of("/\\");
+	if (dot == string::npos || (slash != string::npos && dot < slash)) return inputfile + ".mesh";
+	return inputfile.substr(0, dot) + ".mesh";
+}
+
+
+/* Write the finished mesh to the .mesh file next to the obj file */
+bool TinyObjLoader::saveCache(const string& inputfile, const void* vertexData, const void* indexData)
+{
+	mesh_cache_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "OBJMESH", 8);
+	header.version = MESH_CACHE_VERSION;
+	header.vertex_stride = vertexStride;
+	if (!sourceStamp(inputfile, header.source_size, header.source_mtime)) return false;
+	header.source_hash = fileHash(inputfile);
+	header.num_vertices = numVertices;
+	header.num_indices = numPIndexes;
+	header.index_size = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+	header.num_submeshes = (GLuint)submeshes.size();
+	header.num_materials = (GLuint)materials.size();
+	header.num_corners = numCorners;
+	header.cache_misses = cacheMisses;
+	header.file_order_misses = fileOrderMisses;
+	header.optimized = optimize;
+	for (int c = 0; c < 3; c++) header.bounds_origin[c] = bounds.origin[c];
+	header.bounds_scale = bounds.scale;
+
+	string path = cachePath(inputfile);
+	FILE* f = fopen(path.c_str(), "wb");
+	if (!f) return false;
+	bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+	ok = ok && fwrite(vertexData, vertexStride, numVertices, f) == numVertices;
+	ok = ok && fwrite(indexData, header.index_size, numPIndexes, f) == numPIndexes;
+	ok = ok && (submeshes.empty() || fwrite(&submeshes.front(), sizeof(mesh_submesh), submeshes.size(), f) == submeshes.size());
+	ok = ok && (materials.empty() || fwrite(&materials.front(), sizeof(mesh_material), materials.size(), f) == materials.size());
+	ok = (fclose(f) == 0) && ok;
+
+	// Don't leave a partial file behind for the next run
+	if (!ok) remove(path.c_str());
+	return ok;
+}
+
+
+/* Load the .mesh file if it was compiled from the obj file as it is now: the same
+   size and modification time, or failing that the same contents, in which case the
+   new time is written to the header. The file is memory mapped and the vertex and
+   index blobs are uploaded straight from the mapping */
+bool TinyObjLoader::loadCache(const string& inputfile)
+{
+	mapped_file file;
+	if (!file.open(cachePath(inputfile).c_str()) || file.size() < sizeof(mesh_cache_header)) return false;
+
+	mesh_cache_header header;
+	memcpy(&header, file.data(), sizeof(header));
+	if (memcmp(header.magic, "OBJMESH", 8) != 0 || header.version != MESH_CACHE_VERSION
+		|| header.optimized != GLuint(optimize)) return false;
+	if (header.vertex_stride != (quantize ? sizeof(quantized_vertex) : MESH_VERTEX_STRIDE)) return false;
+	if (header.index_size != sizeof(GLushort) && header.index_size != sizeof(GLuint)) return false;
+
+	unsigned long long source_size;
+	long long source_mtime;
+	if (!sourceStamp(inputfile, source_size, source_mtime) || source_size != header.source_size) return false;
+	if (source_mtime != header.source_mtime && fileHash(inputfile) != header.source_hash) return false;
+
+	size_t vertex_bytes = size_t(header.num_vertices) * header.vertex_stride;
+	size_t index_bytes = size_t(header.num_indices) * header.index_size;
+	size_t expected = sizeof(header) + vertex_bytes + index_bytes
+		+ header.num_submeshes * sizeof(mesh_submesh) + header.num_materials * sizeof(mesh_material);
+	if (file.size() != expected) return false;
+
+	numVertices = numNormals = numTexCoords = header.num_vertices;
+	numPIndexes = header.num_indices;
+	indexType = header.index_size == sizeof(GLushort) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	numCorners = header.num_corners;
+	cacheMisses = header.cache_misses;
+	fileOrderMisses = header.file_order_misses;
+	quantize_bounds header_bounds;
+	header_bounds.origin = vec3(header.bounds_origin[0], header.bounds_origin[1], header.bounds_origin[2]);
+	header_bounds.scale = header.bounds_scale;
+	setQuantized(quantize, header_bounds);
+
+	const unsigned char* p = file.data() + sizeof(header);
+	upload(p, p + vertex_bytes);
+	p += vertex_bytes + index_bytes;
+	submeshes.assign((const mesh_submesh*)p, (const mesh_submesh*)p + header.num_submeshes);
+	p += header.num_submeshes * sizeof(mesh_submesh);
+	materials.assign((const mesh_material*)p, (const mesh_material*)p + header.num_materials);
+
+	// Unmap first, Windows won't open a mapped file for writing
+	if (source_mtime != header.source_mtime)
+	{
+		file.close();
+		restampCache(cachePath(inputfile), source_mtime);
+	}
+	return true;
+}
+
+
+/* Print how many of the face corners were unique vertices, and the vertex shader runs
+   of glDrawElements with a FIFO post transform cache against one run per corner for
+   glDrawArrays. The unique vertex count is the fewest runs a perfect cache could do.
+   ACMR is runs per triangle (3 is no reuse, about 0.5 the best on a regular grid) and
+   ATVR runs per vertex (1 is perfect) */
+void TinyObjLoader::printVertexStats()
+{
+	if (numCorners == 0) return;
+	size_t vertex_bytes = vertexStride;
+	size_t index_bytes = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+	printf("TinyObjLoader: %u face corners, %u unique vertices (%.1f%%), %u %u bit indices\n",
+		numCorners, numVertices, 100.0 * numVertices / numCorners, numPIndexes, (GLuint)index_bytes * 8);
+	printf("  vertex data %.2f MB, was %.2f MB unindexed%s\n",
+		(numVertices * vertex_bytes + numPIndexes * index_bytes) / 1048576.0, numCorners * vertex_bytes / 1048576.0,
+		quantized ? ", quantized" : "");
+	printf("  vertex shader runs %u with a %u entry FIFO cache, was %u (%u saved, %.1f%%)\n",
+		cacheMisses, VERTEX_CACHE_SIZE, numCorners, numCorners - cacheMisses,
+		100.0 * (numCorners - cacheMisses) / numCorners);
+	if (numPIndexes < 3) return;
+	printf("  ACMR %.3f, ATVR %.3f (file order ACMR %.3f, ATVR %.3f)\n",
+		cacheMisses * 3.0 / numPIndexes, double(cacheMisses) / numVertices,
+		fileOrderMisses * 3.0 / numPIndexes, double(fileOrderMisses) / numVertices);
+}
+
+
+/* Print the time to load each obj file by parsing its text and from its .mesh file.
+   Needs a GL context, both loads include the upload */
+void TinyObjLoader::cacheReport(const char** files, int count)
+{
+	printf("\nTinyObjLoader load times, ms\n");
+	for (int i = 0; i < count; i++)
+	{
+		TinyObjLoader text, binary;
+		text.setCacheEnabled(false);
+		double t0 = secondsNow();
+		text.load_obj(files[i]);
+		double t1 = secondsNow();
+
+		// Make sure the .mesh file exists, then time loading it
+		{
+			TinyObjLoader writer;
+			writer.load_obj(files[i]);
+		}
+		double t2 = secondsNow();
+		binary.load_obj(files[i]);
+		double t3 = secondsNow();
+
+		mapped_file obj, mesh;
+		obj.open(files[i]);
+		mesh.open(cachePath(files[i]).c_str());
+		printf("  %-24s text %8.2f (%.2f MB), binary %8.2f (%.2f MB, %s), %5.1fx faster\n", files[i],
+			(t1 - t0) * 1000.0, obj.size() / 1048576.0, (t3 - t2) * 1000.0, mesh.size() / 1048576.0,
+			binary.loaded_from_cache ? "mapped" : "NOT CACHED", (t1 - t0) / (t3 - t2));
+	}
+}
+
+/* The parallel parser has to give exactly what tinyobj::LoadObj gives */
+static bool sameObj(const tinyobj::attrib_t& a, const vector<tinyobj::shape_t>& as,
+	const tinyobj::attrib_t& b, const vector<tinyobj::shape_t>& bs)
+{
+	if (a.vertices != b.vertices || a.normals != b.normals || a.texcoords != b.texcoords
+		|| a.colors != b.colors || as.size() != bs.size()) return false;
+	for (size_t s = 0; s < as.size(); s++)
+	{
+		const tinyobj::mesh_t& am = as[s].mesh;
+		const tinyobj::mesh_t& bm = bs[s].mesh;
+		if (as[s].name != bs[s].name || am.indices.size() != bm.indices.size()
+			|| am.num_face_vertices != bm.num_face_vertices || am.material_ids != bm.material_ids
+			|| am.smoothing_group_ids != bm.smoothing_group_ids) return false;
+		for (size_t i = 0; i < am.indices.size(); i++)
+			if (am.indices[i].vertex_index != bm.indices[i].vertex_index
+				|| am.indices[i].normal_index != bm.indices[i].normal_index
+				|| am.indices[i].texcoord_index != bm.indices[i].texcoord_index) return false;
+	}
+	return true;
+}
+
+
+/* Writes a grid of quads with positions, normals and texture coordinates, groups,
+   materials and smoothing groups, and some relative indices, parses it with
+   tinyobj::LoadObj and then in parallel with 1 thread up to all the hardware threads */
+void TinyObjLoader::parseReport(GLuint faces)
+{
+	const char* path = "parse_report.obj";
+	GLuint side = (GLuint)ceil(sqrt((double)faces));
+	GLuint rows = (faces + side - 1) / side;
+
+	FILE* file = fopen(path, "w");
+	if (!file)
+	{
+		printf("TinyObjLoader::parseReport: could not write %s\n", path);
+		return;
+	}
+	fprintf(file, "# parseReport: %u faces\n", faces);
+	for (GLuint y = 0; y <= rows; y++)
+		for (GLuint x = 0; x <= side; x++)
+		{
+			float u = float(x) / side, v = float(y) / rows;
+			fprintf(file, "v %f %f %f\nvt %f %f\nvn %f %f %f\n", u * 2.f - 1.f, sin(u * 12.f) * cos(v * 9.f) * 0.1f,
+				v * 2.f - 1.f, u, v, 0.f, 1.f, 0.f);
+		}
+	GLuint total = (side + 1) * (rows + 1);
+	GLuint rows_per_group = std::max(rows / 8, 1u);
+	for (GLuint f = 0; f < faces; f++)
+	{
+		GLuint x = f % side, y = f / side;
+		if (x == 0 && y % rows_per_group == 0)
+			fprintf(file, "g part%u\nusemtl material%u\ns %s\n", y / rows_per_group, (y / rows_per_group) % 3,
+				y % 2 ? "off" : "1");
+		GLuint i = y * (side + 1) + x + 1;
+		GLuint j[4] = { i, i + 1, i + side + 2, i + side + 1 };
+		fprintf(file, "f");
+		for (int k = 0; k < 4; k++)
+		{
+			if (y % 7 == 3) fprintf(file, " %d/%d/%d", int(j[k]) - int(total) - 1, int(j[k]) - int(total) - 1, int(j[k]) - int(total) - 1);
+			else fprintf(file, " %u/%u/%u", j[k], j[k], j[k]);
+		}
+		fprintf(file, "\n");
+	}
+	fclose(file);
+
+	mapped_file obj;
+	obj.open(path);
+	double mb = obj.size() / 1048576.0;
+	obj.close();
+
+	string err, warn;
+	tinyobj::attrib_t reference;
+	vector<tinyobj::shape_t> reference_shapes;
+	vector<tinyobj::material_t> materials;
+	double t0 = secondsNow();
+	tinyobj::LoadObj(&reference, &reference_shapes, &materials, &err, &warn, path);
+	double single_ms = (secondsNow() - t0) * 1000.0;
+
+	GLuint max_threads = job_system::hardwareThreads();
+	vector<GLuint> thread_counts;
+	for (GLuint t = 1; t < max_threads; t *= 2) thread_counts.push_back(t);
+	thread_counts.push_back(max_threads);
+
+	printf("\nTinyObjLoader parse: %u faces, %.1f MB, ms (%u hardware threads)\n", faces, mb, max_threads);
+	printf("  tinyobj:    %8.1f ms, %6.1f MB/s\n", single_ms, mb * 1000.0 / single_ms);
+	for (size_t c = 0; c < thread_counts.size(); c++)
+	{
+		job_system pool(thread_counts[c]);
+		tinyobj::attrib_t attrib;
+		vector<tinyobj::shape_t> shapes;
+		materials.clear();
+		t0 = secondsNow();
+		bool parsed = loadObjParallel(&attrib, &shapes, &materials, &err, &warn, path, "", &pool);
+		double ms = (secondsNow() - t0) * 1000.0;
+		printf("  %2u threads: %8.1f ms, %6.1f MB/s, speedup %5.2f, %s\n", thread_counts[c], ms, mb * 1000.0 / ms,
+			single_ms / ms, !parsed ? "NOT PARSED" : sameObj(reference, reference_shapes, attrib, shapes) ? "same result" : "RESULT DIFFERS");
+	}
+	remove(path);
+}
+
+
+/* Print the FIFO cache, overdraw and vertex fetch statistics of each obj file in file
+   order and after each optimisation stage in turn. Only parses the text, no GL needed */
+void TinyObjLoader::optimizeReport(const char** files, int count)
+{
+	const GLuint stride = MESH_VERTEX_STRIDE / sizeof(GLfloat);
+	const char* stages[] = { "file order", "vertex cache", "+ overdraw", "+ vertex fetch" };
+
+	printf("\nTinyObjLoader mesh optimisation, FIFO cache of %u (and 16) vertices\n", VERTEX_CACHE_SIZE);
+	for (int i = 0; i < count; i++)
+	{
+		TinyObjLoader loader;
+		loader.setOptimizeEnabled(false);
+		vector<GLfloat> vertexData;
+		vector<GLuint> indices;
+		loader.parseObj(files[i], false, vertexData, indices);
+		GLuint num_vertices = loader.numVertices;
+		size_t num_indices = indices.size();
+		if (num_indices < 3) continue;
+		printf("  %s: %u triangles, %u vertices, %u submeshes\n", files[i], GLuint(num_indices / 3), num_vertices,
+			(GLuint)loader.submeshes.size());
+
+		vec3 centre = meshCentroid(indices.data(), num_indices, vertexData.data(), stride);
+		for (int stage = 0; stage < 4; stage++)
+		{
+			double t0 = secondsNow();
+			for (size_t s = 0; s < loader.submeshes.size() && (stage == 1 || stage == 2); s++)
+			{
+				GLuint* range = indices.data() + loader.submeshes[s].first_index;
+				GLuint range_count = loader.submeshes[s].num_indices;
+				if (stage == 1) optimizeVertexCache(range, range_count, num_vertices);
+				else optimizeOverdraw(range, range_count, vertexData.data(), stride, num_vertices, centre, VERTEX_CACHE_SIZE);
+			}
+			if (stage == 3) optimizeVertexFetch(indices.data(), num_indices, vertexData.data(), stride, num_vertices);
+			double ms = (secondsNow() - t0) * 1000.0;
+
+			GLuint misses = fifoCacheMisses(indices.data(), num_indices, num_vertices, VERTEX_CACHE_SIZE);
+			GLuint misses16 = fifoCacheMisses(indices.data(), num_indices, num_vertices, 16);
+			printf("    %-14s ACMR %.3f (%.3f), ATVR %.3f (%.3f), overdraw %.3f, fetch %.3f, %7.2f ms\n", stages[stage],
+				misses * 3.0 / num_indices, misses16 * 3.0 / num_indices, double(misses) / num_vertices,
+				double(misses16) / num_vertices, overdrawRatio(indices.data(), num_indices, vertexData.data(), stride),
+				vertexFetchRatio(indices.data(), num_indices, num_vertices, MESH_VERTEX_STRIDE, VERTEX_CACHE_SIZE), ms);
+		}
+	}
+}
+
+
+/* Print the vertex memory of each obj file as floats and quantized, and the worst error
+   of the quantized attributes against the floats, decoded the way the GL and the shader
+   decode them, with the position going through the dequantize matrix. The bounds are
+   half a step of the 16 bit grid for positions, 0.01 degrees for the octahedral normals
+   and half float rounding for texture coordinates */
+void TinyObjLoader::quantizeReport(const char** files, int count)
+{
+	const GLuint stride = MESH_VERTEX_STRIDE / sizeof(GLfloat);
+
+	printf("\nTinyObjLoader quantized vertices\n");
+	for (int i = 0; i < count; i++)
+	{
+		TinyObjLoader loader;
+		vector<GLfloat> vertexData;
+		vector<GLuint> indices;
+		loader.parseObj(files[i], false, vertexData, indices);
+		vector<quantized_vertex> packed;
+		quantize_bounds bounds = quantizeVertices(vertexData, &packed);
+		mat4 dequantize = bounds.dequantize();
+
+		double position_error = 0, normal_error = 0, texcoord_excess = 0, texcoord_error = 0;
+		for (size_t v = 0; v < packed.size(); v++)
+		{
+			const GLfloat* source = &vertexData[v * stride];
+			const quantized_vertex& q = packed[v];
+
+			vec3 normalized = vec3(q.position[0], q.position[1], q.position[2]) / 65535.f;
+			vec3 position = vec3(dequantize * vec4(normalized, 1.f));
+			for (int c = 0; c < 3; c++) position_error = std::max(position_error, (double)fabs(position[c] - source[c]));
+
+			dvec3 normal(source[3], source[4], source[5]);
+			if (length(normal) > 0)
+			{
+				dvec3 decoded(dequantizeNormal(q.normal));
+				normal = normalize(normal);
+				double angle = atan2(length(cross(decoded, normal)), dot(decoded, normal)) * 180.0 / 3.14159265358979;
+				normal_error = std::max(normal_error, angle);
+			}
+
+			for (int c = 0; c < 2; c++)
+			{
+				double error = fabs((double)dequantizeHalf(q.texcoord[c]) - source[6 + c]);
+				double bound = std::max(fabs((double)source[6 + c]) / 2048.0, 1.0 / 33554432.0);
+				texcoord_error = std::max(texcoord_error, error);
+				texcoord_excess = std::max(texcoord_excess, error / bound);
+			}
+		}
+
+		double position_bound = bounds.scale * (0.5 / 65535.0 + 1e-6);
+		const double normal_bound = 0.01;
+		size_t float_bytes = packed.size() * MESH_VERTEX_STRIDE, quantized_bytes = packed.size() * sizeof(quantized_vertex);
+		size_t index_bytes = indices.size() * (packed.size() <= 65536 ? sizeof(GLushort) : sizeof(GLuint));
+		bool within = position_error <= position_bound && normal_error <= normal_bound && texcoord_excess <= 1.0;
+
+		printf("  %s: %u vertices, vertex data %.1f KB -> %.1f KB, with indices %.1f KB -> %.1f KB (%.0f%% saved)\n",
+			files[i], (GLuint)packed.size(), float_bytes / 1024.0, quantized_bytes / 1024.0,
+			(float_bytes + index_bytes) / 1024.0, (quantized_bytes + index_bytes) / 1024.0,
+			100.0 * (float_bytes - quantized_bytes) / (float_bytes + index_bytes));
+		printf("    worst error: position %.3g (bound %.3g), normal %.4f deg (bound %.2f), texcoord %.3g (%.2f of bound), %s\n",
+			position_error, position_bound, normal_error, normal_bound, texcoord_error, texcoord_excess,
+			within ? "within bounds" : "OUT OF BOUNDS");
+	}
+}
+
+
+
+void TinyObjLoader::drawObject(int drawmode)
+{
+
+	/* Draw the object as GL_POINTS */
+	glBindBuffer(GL_ARRAY_BUFFER, vertexBufferObject);
+	if (quantized)
+		glVertexAttribPointer(attribute_v_coord, 3, GL_UNSIGNED_SHORT, GL_TRUE, vertexStride, (void*)offsetof(quantized_vertex, position));
+	else
+		glVertexAttribPointer(attribute_v_coord, 3, GL_FLOAT, GL_FALSE, vertexStride, 0);
+	glEnableVertexAttribArray(attribute_v_coord);
+
+	/* Bind the object normals, octahedral ones need octDecode() in the vertex shader */
+	if (quantized)
+		glVertexAttribPointer(attribute_v_normal, 2, GL_SHORT, GL_TRUE, vertexStride, (void*)offsetof(quantized_vertex, normal));
+	else
+		glVertexAttribPointer(attribute_v_normal, 3, GL_FLOAT, GL_FALSE, vertexStride, (void*)(3 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(attribute_v_normal);
+
+	/* Bind the object texture coords if they exist */
+	glEnableVertexAttribArray(attribute_v_texcoord);
+	if (quantized)
+		glVertexAttribPointer(attribute_v_texcoord, 2, GL_HALF_FLOAT, GL_FALSE, vertexStride, (void*)offsetof(quantized_vertex, texcoord));
+	else
+		glVertexAttribPointer(attribute_v_texcoord, 2, GL_FLOAT, GL_FALSE, vertexStride, (void*)(6 * sizeof(GLfloat)));
+
+	glUniform1ui(vertex_format_id, quantized ? 1 : 0);
+	glPointSize(3.f);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBufferObject);
+
+	// Enable this line to show model in wireframe
+	if (drawmode == 1)
+		glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+	else
+		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+	if (drawmode == 2)
+	{
+		glDrawArrays(GL_POINTS, 0, numVertices);
+	}
+	else
+	{
+		glDrawElements(GL_TRIANGLES, numPIndexes, indexType, (GLvoid*)(0));
+	}
+
+	/* Put the format back so other objects drawn with the same program read float normals */
+	if (quantized)
+		glUniform1ui(vertex_format_id, 0);
+}
+
+static void PrintInfo(const tinyobj::attrib_t& attrib,
+	const vector<tinyobj::shape_t>& shapes,
+	const vector<tinyobj::material_t>& materials) {
+	cout << "# of vertices  : " << (attrib.vertices.size() / 3) << endl;
+	cout << "# of normals   : " << (attrib.normals.size() / 3) << endl;
+	cout << "# of texcoords : " << (attrib.texcoords.size() / 2)
+		<< endl;
+
+	cout << "# of shapes    : " << shapes.size() << endl;
+	cout << "# of materials : " << materials.size() << endl;
+
+	for (size_t v = 0; v < attrib.vertices.size() / 3; v++) {
+		printf("  v[%ld] = (%f, %f, %f)\n", static_cast<long>(v),
+			static_cast<const double>(attrib.vertices[3 * v + 0]),
+			static_cast<const double>(attrib.vertices[3 * v + 1]),
+			static_cast<const double>(attrib.vertices[3 * v + 2]));
+	}
+
+	for (size_t v = 0; v < attrib.normals.size() / 3; v++) {
+		printf("  n[%ld] = (%f, %f, %f)\n", static_cast<long>(v),
+			static_cast<const double>(attrib.normals[3 * v + 0]),
+			static_cast<const double>(attrib.normals[3 * v + 1]),
+			static_cast<const double>(attrib.normals[3 * v + 2]));
+	}
+
+	for (size_t v = 0; v < attrib.texcoords.size() / 2; v++) {
+		printf("  uv[%ld] = (%f, %f)\n", static_cast<long>(v),
+			static_cast<const double>(attrib.texcoords[2 * v + 0]),
+			static_cast<const double>(attrib.texcoords[2 * v + 1]));
+	}
+
+	// For each shape
+	for (size_t i = 0; i < shapes.size(); i++) {
+		printf("shape[%ld].name = %s\n", static_cast<long>(i),
+			shapes[i].name.c_str());
+		printf("Size of shape[%ld].mesh.indices: %lu\n", static_cast<long>(i),
+			static_cast<unsigned long>(shapes[i].mesh.indices.size()));
+		printf("Size of shape[%ld].path.indices: %lu\n", static_cast<long>(i),
+			static_cast<unsigned long>(shapes[i].path.indices.size()));
+
+		size_t index_offset = 0;
+
+		assert(shapes[i].mesh.num_face_vertices.size() ==
+			shapes[i].mesh.material_ids.size());
+
+		assert(shapes[i].mesh.num_face_vertices.size() ==
+			shapes[i].mesh.smoothing_group_ids.size());
+
+		printf("shape[%ld].num_faces: %lu\n", static_cast<long>(i),
+			static_cast<unsigned long>(shapes[i].mesh.num_face_vertices.size()));
+
+		// For each face
+		for (size_t f = 0; f < shapes[i].mesh.num_face_vertices.size(); f++) {
+			size_t fnum = shapes[i].mesh.num_face_vertices[f];
+
+			printf("  face[%ld].fnum = %ld\n", static_cast<long>(f),
+				static_cast<unsigned long>(fnum));
+
+			// For each vertex in the face
+			for (size_t v = 0; v < fnum; v++) {
+				tinyobj::index_t idx = shapes[i].mesh.indices[index_offset + v];
+				printf("    face[%ld].v[%ld].idx = %d/%d/%d\n", static_cast<long>(f),
+					static_cast<long>(v), idx.vertex_index, idx.normal_index,
+					idx.texcoord_index);
+			}
+
+			printf("  face[%ld].material_id = %d\n", static_cast<long>(f),
+				shapes[i].mesh.material_ids[f]);
+			printf("  face[%ld].smoothing_group_id = %d\n", static_cast<long>(f),
+				shapes[i].mesh.smoothing_group_ids[f]);
+
+			index_offset += fnum;
+		}
+
+		printf("shape[%ld].num_tags: %lu\n", static_cast<long>(i),
+			static_cast<unsigned long>(shapes[i].mesh.tags.size()));
+		for (size_t t = 0; t < shapes[i].mesh.tags.size(); t++) {
+			printf("  tag[%ld] = %s ", static_cast<long>(t),
+				shapes[i].mesh.tags[t].name.c_str());
+			printf(" ints: [");
+			for (size_t j = 0; j < shapes[i].mesh.tags[t].intValues.size(); ++j) {
+				printf("%ld", static_cast<long>(shapes[i].mesh.tags[t].intValues[j]));
+				if (j < (shapes[i].mesh.tags[t].intValues.size() - 1)) {
+					printf(", ");
+				}
+			}
+			printf("]");
+
+			printf(" floats: [");
+			for (size_t j = 0; j < shapes[i].mesh.tags[t].floatValues.size(); ++j) {
+				printf("%f", static_cast<const double>(
+					shapes[i].mesh.tags[t].floatValues[j]));
+				if (j < (shapes[i].mesh.tags[t].floatValues.size() - 1)) {
+					printf(", ");
+				}
+			}
+			printf("]");
+
+			printf(" strings: [");
+			for (size_t j = 0; j < shapes[i].mesh.tags[t].stringValues.size(); ++j) {
+				printf("%s", shapes[i].mesh.tags[t].stringValues[j].c_str());
+				if (j < (shapes[i].mesh.tags[t].stringValues.size() - 1)) {
+					printf(", ");
+				}
+			}
+			printf("]");
+			printf("\n");
+		}
+	}
+
+	for (size_t i = 0; i < materials.size(); i++) {
+		printf("material[%ld].name = %s\n", static_cast<long>(i),
+			materials[i].name.c_str());
+		printf("  material.Ka = (%f, %f ,%f)\n",
+			static_cast<const double>(materials[i].ambient[0]),
+			static_cast<const double>(materials[i].ambient[1]),
+			static_cast<const double>(materials[i].ambient[2]));
+		printf("  material.Kd = (%f, %f ,%f)\n",
+			static_cast<const double>(materials[i].diffuse[0]),
+			static_cast<const double>(materials[i].diffuse[1]),
+			static_cast<const double>(materials[i].diffuse[2]));
+		printf("  material.Ks = (%f, %f ,%f)\n",
+			static_cast<const double>(materials[i].specular[0]),
+			static_cast<const double>(materials[i].specular[1]),
+			static_cast<const double>(materials[i].specular[2]));
+		printf("  material.Tr = (%f, %f ,%f)\n",
+			static_cast<const double>(materials[i].transmittance[0]),
+			static_cast<const double>(materials[i].transmittance[1]),
+			static_cast<const double>(materials[i].transmittance[2]));
+		printf("  material.Ke = (%f, %f ,%f)\n",
+			static_cast<const double>(materials[i].emission[0]),
+			static_cast<const double>(materials[i].emission[1]),
+			static_cast<const double>(materials[i].emission[2]));
+		printf("  material.Ns = %f\n",
+			static_cast<const double>(materials[i].shininess));
+		printf("  material.Ni = %f\n", static_cast<const double>(materials[i].ior));
+		printf("  material.dissolve = %f\n",
+			static_cast<const double>(materials[i].dissolve));
+		printf("  material.illum = %d\n", materials[i].illum);
+		printf("  material.map_Ka = %s\n", materials[i].ambient_texname.c_str());
+		printf("  material.map_Kd = %s\n", materials[i].diffuse_texname.c_str());
+		printf("  material.map_Ks = %s\n", materials[i].specular_texname.c_str());
+		printf("  material.map_Ns = %s\n",
+			materials[i].specular_highlight_texname.c_str());
+		printf("  material.map_bump = %s\n", materials[i].bump_texname.c_str());
+		printf("    bump_multiplier = %f\n", static_cast<const double>(materials[i].bump_texopt.bump_multiplier));
+		printf("  material.map_d = %s\n", materials[i].alpha_texname.c_str());
+		printf("  material.disp = %s\n", materials[i].displacement_texname.c_str());
+		printf("  <<PBR>>\n");
+		printf("  material.Pr     = %f\n", static_cast<const double>(materials[i].roughness));
+		printf("  material.Pm     = %f\n", static_cast<const double>(materials[i].metallic));
+		printf("  material.Ps     = %f\n", static_cast<const double>(materials[i].sheen));
+		printf("  material.Pc     = %f\n", static_cast<const double>(materials[i].clearcoat_thickness));
+		printf("  material.Pcr    = %f\n", static_cast<const double>(materials[i].clearcoat_thickness));
+		printf("  material.aniso  = %f\n", static_cast<const double>(materials[i].anisotropy));
+		printf("  material.anisor = %f\n", static_cast<const double>(materials[i].anisotropy_rotation));
+		printf("  material.map_Ke = %s\n", materials[i].emissive_texname.c_str());
+		printf("  material.map_Pr = %s\n", materials[i].roughness_texname.c_str());
+		printf("  material.map_Pm = %s\n", materials[i].metallic_texname.c_str());
+		printf("  material.map_Ps = %s\n", materials[i].sheen_texname.c_str());
+		printf("  material.norm   = %s\n", materials[i].normal_texname.c_str());
+		map<string, string>::const_iterator it(
+			materials[i].unknown_parameter.begin());
+		map<string, string>::const_iterator itEnd(
+			materials[i].unknown_parameter.end());
+
+		for (; it != itEnd; it++) {
+			printf("  material.%s = %s\n", it->first.c_str(), it->second.c_str());
+		}
+		printf("\n");
+	}
 }
\ No newline at end of file
@@ -1,38 +1,104 @@
-/* tiny_loader_texture.h
-Example class to demonstrate the use of TinyObjectLoader to load an obj (WaveFront)
-object file with normals and texture coordinates, and copy the data into vertex, normal texture coordinate buffers.
-
-Iain Martin November 2018
-*/
-
-#pragma once
-
-#include "wrapper_glfw.h"
-#include <vector>
-#include <glm/glm.hpp>
-
-class TinyObjLoader
-{
-public:
-	TinyObjLoader();
-	~TinyObjLoader();
-
-	void load_obj(std::string inputfile, bool debugPrint = false);
-	void drawObject(int drawmode);
-
-private:
-	// Define vertex buffer object names (e.g as globals)
-	GLuint positionBufferObject;
-	GLuint normalBufferObject;
-	GLuint texCoordsObject;
-
-	GLuint attribute_v_coord;
-	GLuint attribute_v_normal;
-	GLuint attribute_v_texcoord;
-
-	int drawmode;
-	GLuint numVertices;
-	GLuint numNormals;
-	GLint  numTexCoords;
-	GLuint numPIndexes;
-};
+/* tiny_loader_texture.h
+Example class to demonstrate the use of TinyObjectLoader to load an obj (WaveFront)
+object file with normals and texture coordinates, and copy the data into vertex, normal texture coordinate buffers.
+Face corners that share a position, normal and texture coordinate become one vertex, drawn
+through an index buffer.
+The finished mesh is saved next to the obj file as a binary .mesh file, which later loads
+memory map and upload without parsing any text.
+Large obj files are parsed in chunks on the job system threads.
+The triangles are reordered for the vertex cache and overdraw and the vertices for
+fetching before they are uploaded, see mesh_optimizer.h.
+Quantized loading halves the vertex size. The positions then reach the vertex shader
+normalized across the bounds of the mesh, so draw with the model matrix multiplied by
+dequantize, and the normals need decoding, see setFormatUniforms().
+
+Iain Martin November 2018
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include "job_system.h"
+#include "vertex_quantize.h"
+#include <vector>
+#include <string>
+#include <glm/glm.hpp>
+
+/* Faces of one shape with the same material, a range of the index buffer */
+struct mesh_submesh
+{
+	GLuint first_index;
+	GLuint num_indices;
+	GLint material;					// Index in materials, -1 for none
+};
+
+/* The parts of an obj material a renderer is likely to use */
+struct mesh_material
+{
+	char name[64];
+	char diffuse_texname[128];
+	GLfloat ambient[3];
+	GLfloat diffuse[3];
+	GLfloat specular[3];
+	GLfloat shininess;
+};
+
+class TinyObjLoader
+{
+public:
+	TinyObjLoader();
+	~TinyObjLoader();
+
+	void load_obj(std::string inputfile, bool debugPrint = false);
+	void drawObject(int drawmode);
+	void printVertexStats();		// Unique vertex ratio and vertex shader runs saved by indexing
+	void setCacheEnabled(bool enable);	// false = always parse the obj text, don't write a .mesh file
+	void setJobSystem(job_system* pool);	// NULL = parse with tinyobj::LoadObj on the calling thread
+	void setOptimizeEnabled(bool enable);	// false = keep the triangles and vertices in file order
+	void setQuantizeEnabled(bool enable);	// true = 16 bit positions, octahedral normals, half texcoords
+	void setFormatUniforms(GLuint program);	// Shader uniform that selects the normal decoding
+
+	static std::string cachePath(const std::string& inputfile);	// The .mesh file next to the obj file
+	static void cacheReport(const char** files, int count);	// Time loading each obj from text and from its .mesh
+	static void parseReport(GLuint faces = 1000000);	// Time parsing a generated obj with 1 to all hardware threads
+	static void optimizeReport(const char** files, int count);	// ACMR, ATVR, overdraw and fetch after each optimisation
+	static void quantizeReport(const char** files, int count);	// Size and worst error of the quantized vertices
+
+	std::vector<mesh_submesh> submeshes;
+	std::vector<mesh_material> materials;
+	bool loaded_from_cache;			// The last load_obj() used the .mesh file
+	bool quantized;					// The vertices were loaded quantized
+	glm::mat4 dequantize;			// Identity unless quantized, draw with model * dequantize
+
+private:
+	void parseObj(const std::string& inputfile, bool debugPrint, std::vector<GLfloat>& vertexData, std::vector<GLuint>& indices);
+	bool loadCache(const std::string& inputfile);
+	bool saveCache(const std::string& inputfile, const void* vertexData, const void* indexData);
+	void setQuantized(bool enable, const quantize_bounds& quantize_bounds);
+	void upload(const void* vertexData, const void* indexData);
+
+	// Define vertex buffer object names (e.g as globals)
+	GLuint vertexBufferObject;		// Interleaved position, normal and texture coordinate
+	GLuint elementBufferObject;
+
+	GLuint attribute_v_coord;
+	GLuint attribute_v_normal;
+	GLuint attribute_v_texcoord;
+	GLuint vertex_format_id;
+
+	int drawmode;
+	GLuint numVertices;
+	GLuint numNormals;
+	GLint  numTexCoords;
+	GLuint numPIndexes;
+	GLenum indexType;				// GL_UNSIGNED_SHORT when every vertex fits, else GL_UNSIGNED_INT
+	GLuint numCorners;				// Face corners in the obj file, the vertices glDrawArrays would need
+	GLuint cacheMisses;				// Vertex shader runs for the indices with a FIFO post transform cache
+	GLuint fileOrderMisses;			// The same for the indices in file order, before optimizing
+	GLuint vertexStride;			// Bytes per vertex in the buffer, float or quantized
+	quantize_bounds bounds;
+	bool use_cache;
+	bool optimize;
+	bool quantize;
+	job_system* jobs;				// Parses the obj text in chunks, see loadObjParallel()
+};
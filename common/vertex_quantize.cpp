@@ -0,0 +1,119 @@
+/* vertex_quantize.cpp
+   Position, normal and texture coordinate quantization, see vertex_quantize.h
+*/
+
+#include "vertex_quantize.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
+#include <cmath>
+#include <cfloat>
+
+using namespace std;
+using namespace glm;
+
+mat4 quantize_bounds::dequantize() const
+{
+	return glm::scale(translate(mat4(1.0f), origin), vec3(scale));
+}
+
+
+quantize_bounds quantizeBounds(const GLfloat* positions, size_t count, GLuint stride)
+{
+	vec3 lo(FLT_MAX), hi(-FLT_MAX);
+	for (size_t i = 0; i < count; i++)
+	{
+		const GLfloat* p = positions + i * stride;
+		lo = min(lo, vec3(p[0], p[1], p[2]));
+		hi = max(hi, vec3(p[0], p[1], p[2]));
+	}
+
+	quantize_bounds bounds;
+	bounds.origin = count ? lo : vec3(0);
+	vec3 size = count ? hi - lo : vec3(0);
+	bounds.scale = std::max(size.x, std::max(size.y, size.z));
+	if (bounds.scale <= 0) bounds.scale = 1.f;
+	return bounds;
+}
+
+
+void quantizePosition(const quantize_bounds& bounds, const GLfloat* position, GLushort* q)
+{
+	for (int c = 0; c < 3; c++)
+	{
+		GLfloat t = (position[c] - bounds.origin[c]) / bounds.scale;
+		q[c] = GLushort(clamp(t, 0.f, 1.f) * 65535.f + 0.5f);
+	}
+}
+
+
+/* The GL maps an unsigned normalized short c to c / 65535 */
+vec3 dequantizePosition(const quantize_bounds& bounds, const GLushort* q)
+{
+	return bounds.origin + vec3(q[0], q[1], q[2]) * (bounds.scale / 65535.f);
+}
+
+
+static inline GLfloat signNotZero(GLfloat v)
+{
+	return v >= 0 ? 1.f : -1.f;
+}
+
+
+/* The normal is projected onto the octahedron |x| + |y| + |z| = 1 and the lower half is
+   folded over the upper one. Of the four grid points around the result, the one that
+   decodes closest to the normal is kept */
+void quantizeNormal(vec3 normal, GLshort* e)
+{
+	GLfloat sum = fabs(normal.x) + fabs(normal.y) + fabs(normal.z);
+	if (sum <= 0)
+	{
+		e[0] = e[1] = 0;
+		return;
+	}
+	vec3 n = normal / sum;
+	vec2 p(n.x, n.y);
+	if (n.z < 0) p = vec2((1.f - fabs(n.y)) * signNotZero(n.x), (1.f - fabs(n.x)) * signNotZero(n.y));
+
+	vec3 target = normalize(normal);
+	GLfloat best = -2.f;
+	for (int dx = 0; dx < 2; dx++)
+		for (int dy = 0; dy < 2; dy++)
+		{
+			GLshort q[2];
+			q[0] = GLshort(clamp(dx ? ceil(p.x * 32767.f) : floor(p.x * 32767.f), -32767.f, 32767.f));
+			q[1] = GLshort(clamp(dy ? ceil(p.y * 32767.f) : floor(p.y * 32767.f), -32767.f, 32767.f));
+			GLfloat d = dot(dequantizeNormal(q), target);
+			if (d > best)
+			{
+				best = d;
+				e[0] = q[0];
+				e[1] = q[1];
+			}
+		}
+}
+
+
+/* The GL maps a signed normalized short c to max(c / 32767, -1) */
+vec3 dequantizeNormal(const GLshort* e)
+{
+	vec2 p(std::max(e[0] / 32767.f, -1.f), std::max(e[1] / 32767.f, -1.f));
+	vec3 n(p.x, p.y, 1.f - fabs(p.x) - fabs(p.y));
+	if (n.z < 0)
+	{
+		n.x = (1.f - fabs(p.y)) * signNotZero(p.x);
+		n.y = (1.f - fabs(p.x)) * signNotZero(p.y);
+	}
+	return normalize(n);
+}
+
+
+GLushort quantizeHalf(GLfloat value)
+{
+	return packHalf1x16(value);
+}
+
+
+GLfloat dequantizeHalf(GLushort half)
+{
+	return unpackHalf1x16(half);
+}
@@ -0,0 +1,38 @@
+/* vertex_quantize.h
+   Compact attribute formats for static meshes, about half the size of floats:
+     - positions as 16 bit unsigned normalized values across the bounds of the mesh.
+       The bounds use one scale for all three axes, so the dequantize matrix is a
+       translation and a uniform scale: folded into the model matrix it leaves the
+       normal matrix pointing the same way
+     - unit normals octahedral encoded in two 16 bit signed normalized values, folded
+       about z, decoded by octDecode() in the vertex shader (see
+       shaders/object_loader_texture.vert). Two 8 bit values would only be padded back
+       to 4 bytes in the vertex
+     - texture coordinates as half floats
+   The decode functions do what the GL and the shader do, to measure the error on the CPU.
+*/
+
+#pragma once
+
+#include "wrapper_glfw.h"
+#include <glm/glm.hpp>
+
+struct quantize_bounds
+{
+	glm::vec3 origin;					// Corner of the bounds, position 0
+	GLfloat scale;						// Longest side of the bounds, position 65535 on every axis
+
+	glm::mat4 dequantize() const;		// Normalized position to model space, multiply the model matrix by it
+};
+
+/* Bounds of count positions, stride floats apart */
+quantize_bounds quantizeBounds(const GLfloat* positions, size_t count, GLuint stride);
+
+void quantizePosition(const quantize_bounds& bounds, const GLfloat* position, GLushort* q);
+glm::vec3 dequantizePosition(const quantize_bounds& bounds, const GLushort* q);
+
+void quantizeNormal(glm::vec3 normal, GLshort* e);
+glm::vec3 dequantizeNormal(const GLshort* e);
+
+GLushort quantizeHalf(GLfloat value);
+GLfloat dequantizeHalf(GLushort half);
@@ -341,7 +341,8 @@ void init(GLWrapper* glw)
 	// Create the vertex array object and make it current
 	glBindVertexArray(vao);
 
-	/*load and create our monkey object*/
+	/*load and create our monkey object, packed into 16-byte quantized vertices*/
+	drone.setQuantizeEnabled(true);
 	drone.load_obj("..\\..\\obj\\a.obj");
 
 	/* Load and build the vertex and fragment shaders */
@@ -369,6 +370,7 @@ void init(GLWrapper* glw)
 	normalmatrixID = glGetUniformLocation(program, "normalmatrix");
 	tex_location = glGetUniformLocation(program, "tex");
 	shademode_location = glGetUniformLocation(program, "shademode");
+	drone.setFormatUniforms(program);
 
 	//uniforms for skybox shaders
 	modelID_skybox = glGetUniformLocation(skyboxProgram, "model");
@@ -394,8 +396,9 @@ void init(GLWrapper* glw)
 	perlin_frequency = 1.f;
 	land_size = 2.f;
 	heightfield = new terrain_object(octaves, perlin_frequency, perlin_scale);
-	heightfield->createTerrain(200, 200, land_size, land_size);
-	heightfield->setColourBasedOnHeight();
+	double terrain_start = glfwGetTime();
+	bool cached = heightfield->createTerrainCached(200, 200, land_size, land_size);
+	printf("Terrain %s in %.1f ms\n", cached ? "loaded from cache" : "generated", (glfwGetTime() - terrain_start) * 1000.0);
 	heightfield->createObject();
 
 	/* Define the dimension of the noise texture and create the noise array */
@@ -447,6 +450,9 @@ void init(GLWrapper* glw)
    class because we registered display as a callback function */
 void display()
 {
+	/* Count the terrain draw calls of this frame */
+	terrain_object::draw_calls = 0;
+
 	/* Define the background colour */
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
@@ -629,7 +635,10 @@ void display()
 		model.top() = rotate(model.top(), radians(drone_rot), glm::vec3(0, 1, 0));
 		model.top() = scale(model.top(), vec3(0.2f, 0.2f, 0.2f));
 		// Recalculate the normal matrix and send the model and normal matrices to the vertex shader
-		glUniformMatrix4fv(modelID, 1, GL_FALSE, &(model.top()[0][0]));
+		// The quantized positions are in [0,1] over the model bounds so dequantize is folded into the
+		// model matrix, the normals are stored unscaled so the normal matrix is built without it
+		mat4 drone_model = model.top() * drone.dequantize;
+		glUniformMatrix4fv(modelID, 1, GL_FALSE, &drone_model[0][0]);
 		normalmatrix = transpose(inverse(mat3(view * model.top())));
 		glUniformMatrix3fv(normalmatrixID, 1, GL_FALSE, &normalmatrix[0][0]);
 
@@ -713,6 +722,42 @@ static void keyCallback(GLFWwindow* window, int key, int s, int action, int mods
 		cout << "shademode = " << shademode << endl;
 	}
 
+	/* Print the draw calls used by the two heightfields in the last frame */
+	if (key == 'P' && action != GLFW_PRESS)
+	{
+		cout << "terrain draw calls = " << terrain_object::draw_calls << endl;
+	}
+
+	/* Time loading each model from its obj text and from its binary .mesh file */
+	if (key == 'L' && action != GLFW_PRESS)
+	{
+		const char* models[] = { "..\\..\\obj\\a.obj", "..\\..\\obj\\drone.obj",
+			"..\\..\\obj\\monkey_normals.obj", "..\\..\\obj\\TeslaTruck.obj" };
+		TinyObjLoader::cacheReport(models, 4);
+	}
+
+	/* Time parsing a generated million face obj with tinyobj and with 1 to all threads */
+	if (key == 'O' && action != GLFW_PRESS)
+	{
+		TinyObjLoader::parseReport();
+	}
+
+	/* Vertex cache, overdraw and vertex fetch statistics of the models before and after optimizing */
+	if (key == 'V' && action != GLFW_PRESS)
+	{
+		const char* models[] = { "..\\..\\obj\\a.obj", "..\\..\\obj\\drone.obj",
+			"..\\..\\obj\\monkey_normals.obj", "..\\..\\obj\\TeslaTruck.obj" };
+		TinyObjLoader::optimizeReport(models, 4);
+	}
+
+	/* Vertex memory of the models as floats and quantized, and the worst quantization errors */
+	if (key == 'N' && action != GLFW_PRESS)
+	{
+		const char* models[] = { "..\\..\\obj\\a.obj", "..\\..\\obj\\drone.obj",
+			"..\\..\\obj\\monkey_normals.obj", "..\\..\\obj\\TeslaTruck.obj" };
+		TinyObjLoader::quantizeReport(models, 4);
+	}
+
 	/* Cycle between drawing vertices, mesh and filled polygons */
 	if (key == ',' && action != GLFW_PRESS)
 	{
@@ -754,6 +799,7 @@ int main(int argc, char* argv[])
 
 	glw->eventLoop();
 
+	point_anim->releaseBuffers();
 	delete(glw);
 	return 0;
 }
@@ -28,6 +28,8 @@ if you prefer */
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "terrain_object.h"
+#include "noise_engine.h"
+#include "terrain_chunks.h"
 
 using namespace std;
 using namespace glm;
@@ -65,6 +67,12 @@ int octaves;
 GLfloat perlin_scale, perlin_frequency;
 GLfloat land_size;
 GLuint land_resolution;
+const char* heightmap_path = NULL;	// 16 bit PNG or RAW heightmap given on the command line
+
+bool use_lod;				// Draw the heightfield with level of detail
+
+terrain_chunks *streamed;	// Tiled terrain streamed around stream_focus
+bool use_streaming;
 
 /*
 This function is called before entering the main rendering loop.
@@ -94,10 +102,21 @@ void init(GLWrapper *glw)
 	perlin_scale = 2.f;
 	perlin_frequency = 1.f;
 	land_size = 20.f;
-	land_resolution = 100;
+	land_resolution = 257;		// 256 quads so the LOD patches fit the grid exactly
 	heightfield = new terrain_object(octaves, perlin_frequency, perlin_scale);
-	heightfield->createTerrain(land_resolution, land_resolution, land_size, land_size);
+	if (!heightmap_path || !heightfield->createTerrainFromHeightmap(heightmap_path, land_resolution, land_resolution,
+		land_size, land_size, land_size / 4.f))
+	{
+		heightfield->createTerrain(land_resolution, land_resolution, land_size, land_size);
+	}
 	heightfield->createObject();
+	use_lod = false;
+
+	/* Create the streamed terrain, tiles are generated the first time it is drawn */
+	streamed = new terrain_chunks(65, land_size, octaves, perlin_frequency, perlin_scale);
+	streamed->setViewRadius(3);
+	streamed->setTileBudget(64);
+	use_streaming = false;
 	
 	/* Load and build the vertex and fragment shaders */
 	try
@@ -118,6 +137,12 @@ void init(GLWrapper *glw)
 	viewID = glGetUniformLocation(program, "view");
 	projectionID = glGetUniformLocation(program, "projection");
 
+	/* Uniforms used to morph the LOD patches */
+	heightfield->setLODUniforms(glGetUniformLocation(program, "lod_level"),
+		glGetUniformLocation(program, "morph_range"), glGetUniformLocation(program, "lod_eye"));
+	heightfield->enableLOD();
+	heightfield->setFormatUniforms(program);
+
 
 }
 
@@ -165,8 +190,23 @@ void display()
 	model = rotate(model, -radians(angle_z), vec3(0, 0, 1)); //rotating in clockwise direction around z-axis
 	glUniformMatrix4fv(modelID, 1, GL_FALSE, &model[0][0]);
 
-	/* Draw our heightfield */
-	heightfield->drawObject(drawmode);
+	/* Draw our heightfield, or the streamed tiles around the focus point moved with C,V,B,N */
+	if (use_streaming)
+	{
+		vec3 stream_focus = vec3(y, 0, z) * (4.f * land_size);
+		model = translate(model, -stream_focus);
+		glUniformMatrix4fv(modelID, 1, GL_FALSE, &model[0][0]);
+		streamed->update(stream_focus);
+		streamed->drawObject(drawmode);
+	}
+	else if (use_lod)
+	{
+		// The LOD is selected using the camera position in terrain model coordinates
+		vec3 eye = vec3(inverse(view * model) * vec4(0, 0, 0, 1.f));
+		heightfield->drawObjectLOD(drawmode, eye);
+	}
+	else
+		heightfield->drawObject(drawmode);
 
 	glDisableVertexAttribArray(0);
 	glUseProgram(0);
@@ -222,6 +262,44 @@ static void keyCallback(GLFWwindow* window, int key, int s, int action, int mods
 		drawmode ++;
 		if (drawmode > 2) drawmode = 0;
 	}
+
+	/* Print the Perlin noise generation benchmark (samples/second), the
+	   memory used to build a large heightfield, the terrain streaming latencies
+	   the buffer sizes of the terrain vertex formats, the terrain cache timings,
+	   the import of an 8K heightmap and the colouring times */
+	if (key == 'P' && action != GLFW_PRESS)
+	{
+		noise_engine::benchmark();
+		terrain_object::memoryReport(2048, 8);
+		terrain_chunks::flightReport();
+		terrain_object::formatReport(1025);
+		terrain_object::cacheReport(1025);
+		terrain_object::heightmapReport(8193, 2049);
+		terrain_object::colourBenchmark(1025);
+	}
+
+	/* Cycle through the float, packed, 16 bit height and displaced vertex formats */
+	if (key == 'F' && action != GLFW_PRESS)
+	{
+		heightfield->setVertexFormat(terrain_vertex_format((heightfield->vertex_format + 1) % 4));
+		heightfield->createObject();
+		cout << "vertex_format=" << heightfield->vertex_format << endl;
+	}
+
+	/* Switch level of detail on and off, J prints the triangles drawn in the last frame */
+	if (key == 'K' && action != GLFW_PRESS)
+	{
+		use_lod = !use_lod;
+		cout << "use_lod=" << use_lod << endl;
+	}
+	if (key == 'J' && action != GLFW_PRESS) heightfield->printLODStats();
+
+	/* Switch between the single heightfield and the streamed terrain tiles */
+	if (key == 'L' && action != GLFW_PRESS)
+	{
+		use_streaming = !use_streaming;
+		cout << "use_streaming=" << use_streaming << endl;
+	}
 }
 
 /* Entry point of program */
@@ -239,10 +317,14 @@ int main(int argc, char* argv[])
 	glw->setKeyCallback(keyCallback);
 	glw->setReshapeCallback(reshape);
 
+	/* Optional heightmap to use instead of the Perlin noise terrain */
+	if (argc > 1) heightmap_path = argv[1];
+
 	init(glw);
 
 	glw->eventLoop();
 
+	delete(streamed);
 	delete(glw);
 	return 0;
 }
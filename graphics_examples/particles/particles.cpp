@@ -32,6 +32,7 @@ if you prefer */
 #include "soil.h"
 
 #include "particle_object.h"
+#include "particle_gpu.h"
 
 /* Define buffer object indices */
 GLuint quad_vbo, quad_normals, quad_colours, quad_tex_coords;
@@ -61,6 +62,8 @@ GLuint colourmodeID;
 GLfloat aspect_ratio;		/* Aspect ratio of the window defined in the reshape callback*/
 
 particle_object particleObject;
+particle_gpu gpuParticles;
+bool gpu_available;			/* The GPU particle backend shaders built */
 
 using namespace glm;
 using namespace std;
@@ -102,6 +105,18 @@ void init(GLWrapper *glw)
 		exit(0);
 	}
 
+	/* The GPU backend is optional, the CPU particles still work without it */
+	try
+	{
+		gpuParticles.create("../../shaders/");
+		gpu_available = true;
+	}
+	catch (exception &e)
+	{
+		cout << "GPU particle backend unavailable: " << e.what() << endl;
+		gpu_available = false;
+	}
+
 	/* Define uniforms to send to vertex shader */
 	modelID = glGetUniformLocation(program, "model");
 	colourmodeID = glGetUniformLocation(program, "colourmode");
@@ -293,6 +308,50 @@ static void keyCallback(GLFWwindow* window, int key, int s, int action, int mods
 		if (drawmode > 2) drawmode = 0;
 	}
 
+	/* Print the particle simulation (particles/ms), sort (ms/frame) and thread scaling benchmarks */
+	if (key == 'K' && action != GLFW_PRESS)
+	{
+		particle_store::benchmark();
+		particle_object::sortBenchmark();
+		particle_object::threadReport();
+	}
+
+	/* Switch between simulating the particles on the CPU and on the GPU */
+	if (key == 'G' && action != GLFW_PRESS && gpu_available)
+	{
+		particleObject.setGPUBackend(particleObject.gpu ? NULL : &gpuParticles);
+		cout << "particle backend=" << (particleObject.gpu ? "GPU" : "CPU") << endl;
+	}
+
+	/* Compare the statistics of the CPU and GPU particle backends */
+	if (key == 'H' && action != GLFW_PRESS && gpu_available) particle_gpu::conformanceTest();
+
+	/* Print the spawn counters and switch to the next overflow policy */
+	if (key == 'J' && action != GLFW_PRESS)
+	{
+		particleObject.printSpawnStats();
+		particleObject.setOverflowPolicy(particle_overflow((particleObject.overflow_policy + 1) % 3));
+	}
+
+	/* Switch between ticking the simulation in the render loop and on its own thread */
+	if (key == 'U' && action != GLFW_PRESS)
+	{
+		if (particleObject.clock.threaded()) particleObject.stopSimulationThread();
+		else particleObject.startSimulationThread();
+		cout << "simulation thread=" << particleObject.clock.threaded() << endl;
+	}
+
+	/* Cycle the simulation tick rate between 30, 60 and 120 Hz */
+	if (key == 'F' && action != GLFW_PRESS)
+	{
+		double hz = 1.0 / particleObject.clock.dt;
+		particleObject.setTickRate(hz < 45 ? 60 : hz < 90 ? 120 : 30);
+		cout << "tick rate=" << 1.0 / particleObject.clock.dt << endl;
+	}
+
+	/* Check the particles are the same for 144 Hz, 1000 Hz and threaded clocks */
+	if (key == 'I' && action != GLFW_PRESS) particle_object::timestepReport();
+
 }
 
 /* Entry point of program */
@@ -314,6 +373,8 @@ int main(int argc, char* argv[])
 
 	glw->eventLoop();
 
+	particleObject.releaseBuffers();
+	gpuParticles.destroy();
 	delete(glw);
 	return 0;
 }
@@ -312,6 +312,7 @@ static void keyCallback(GLFWwindow* window, int key, int s, int action, int mods
 	}
 
 	/* Point sprite animation parameters */
+	GLfloat old_speed = speed, old_maxdist = maxdist;
 	if (key == ',') point_size -= 1.f;
 	if (key == '.') point_size += 1.f;
 	if (key == 'O')
@@ -323,9 +324,31 @@ static void keyCallback(GLFWwindow* window, int key, int s, int action, int mods
 	if (key == 'L') maxdist -= 0.1f;
 	if (key == ';') maxdist += 0.1f;
 
+	/* Print the points2 tick time with 1 to N job system threads */
+	if (key == 'K' && action != GLFW_PRESS) points2::threadReport();
+
+	/* Switch between ticking the animation in the render loop and on its own thread */
+	if (key == 'U' && action != GLFW_PRESS)
+	{
+		if (point_anim->clock.threaded()) point_anim->stopSimulationThread();
+		else point_anim->startSimulationThread();
+		cout << "simulation thread=" << point_anim->clock.threaded() << endl;
+	}
+
+	/* Cycle the animation tick rate between 30, 60 and 120 Hz */
+	if (key == 'F' && action != GLFW_PRESS)
+	{
+		double hz = 1.0 / point_anim->clock.dt;
+		point_anim->setTickRate(hz < 45 ? 60 : hz < 90 ? 120 : 30);
+		cout << "tick rate=" << 1.0 / point_anim->clock.dt << endl;
+	}
+
+	/* Check the points are the same for 144 Hz, 1000 Hz and threaded clocks */
+	if (key == 'I' && action != GLFW_PRESS) points2::timestepReport();
+
 	
 
-	point_anim->updateParams(maxdist, speed);
+	if (speed != old_speed || maxdist != old_maxdist) point_anim->updateParams(maxdist, speed);
 }
 
 /* Entry point of program */
@@ -347,6 +370,7 @@ int main(int argc, char* argv[])
 
 	glw->eventLoop();
 
+	point_anim->releaseBuffers();
 	delete(glw);
 	return 0;
 }
@@ -3,6 +3,7 @@
  This example also shows how to render a height map and place an object on the terrain.
  The terrain is not transformed to simplify the grid height calculations.
  Use keys z, x, b, n to move the Monkey around and see how it sits on the terrain
+ Use keys u, j, k to raise, lower and flatten the terrain under the Monkey
  Iain Martin October 2018
 */
 
@@ -95,8 +96,9 @@ void init(GLWrapper *glw)
 	perlin_frequency = 1.f;
 	land_size = 2.f;
 	heightfield = new terrain_object(octaves, perlin_frequency, perlin_scale);
-	heightfield->createTerrain(200, 200, land_size, land_size);
-	heightfield->setColourBasedOnHeight();
+	double terrain_start = glfwGetTime();
+	bool cached = heightfield->createTerrainCached(200, 200, land_size, land_size);
+	cout << "Terrain " << (cached ? "loaded from cache" : "generated") << " in " << (glfwGetTime() - terrain_start) * 1000.0 << " ms" << endl;
 	heightfield->createObject();
 	
 	/* Load and build the vertex and fragment shaders */
@@ -118,8 +120,8 @@ void init(GLWrapper *glw)
 	projectionID = glGetUniformLocation(program, "projection");
 
 	// Place the Mokey object on the terrain at its current start position
-	vec2 pos = heightfield->getGridPos(x, z);
-	y = heightfield->heightAtPosition(x, z);
+	vec2 pos = vec2(x, z);
+	heightfield->heightsAtPositions(&pos, 1, &y);
 }
 
 /* Called to update the display. Note that this function is called in the event loop in the wrapper
@@ -290,22 +292,32 @@ static void keyCallback(GLFWwindow* window, int key, int s, int action, int mods
 		printf("\nperlin_scale = %f", perlin_scale);
 	}
 
+	/* Sculpt the terrain under the object: U raises, J lowers and K flattens.
+	   Only the edited area is recalculated and uploaded */
+	if (key == 'U' && action != GLFW_PRESS) { heightfield->deform(TERRAIN_BRUSH_RAISE, x, z, 1.f, 0.05f); placeObject = true; }
+	if (key == 'J' && action != GLFW_PRESS) { heightfield->deform(TERRAIN_BRUSH_LOWER, x, z, 1.f, 0.05f); placeObject = true; }
+	if (key == 'K' && action != GLFW_PRESS) { heightfield->deform(TERRAIN_BRUSH_FLATTEN, x, z, 1.f, 0.2f); placeObject = true; }
+
+	/* Print the terrain height query benchmark and the terrain cache timings */
+	if (key == 'H' && action != GLFW_PRESS)
+	{
+		terrain_object::queryBenchmark(1025, 1000000);
+		terrain_object::cacheReport(1025);
+	}
+
 	// Keep object on the terrain
 	if (placeObject)
 	{
-		// Debug to output grid position of object
-		vec2 pos = heightfield->getGridPos(x, z);
-		
-		// Set the object height form the grid position
-		y = heightfield->heightAtPosition(x, z);
+		// Set the object height from the heights interpolated around the position
+		vec2 pos(x, z);
+		heightfield->heightsAtPositions(&pos, 1, &y);
 	}
 
 	if (recreate_terrain)
 	{
 		delete heightfield;
 		heightfield = new terrain_object(octaves, perlin_frequency, perlin_scale);
-		heightfield->createTerrain(200, 200, land_size, land_size, sealevel);
-		heightfield->setColourBasedOnHeight();
+		heightfield->createTerrainCached(200, 200, land_size, land_size, sealevel);
 		heightfield->createObject();
 	}
 
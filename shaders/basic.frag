@@ -1,8 +1,8 @@
-// Minimal fragment shader
-#version 420
-
-out vec4 outputColor;
-void main()
-{
-	outputColor = vec4(1.0, 0.0, 0.5, 1.0);
+// Minimal fragment shader
+#version 420
+
+out vec4 outputColor;
+void main()
+{
+	outputColor = vec4(1.0, 0.0, 0.5, 1.0);
 }
\ No newline at end of file
@@ -1,9 +1,9 @@
-// Minimal fragment shader
-
-#version 420 core
-
-out vec4 outputColor;
-void main()
-{
-	outputColor = vec4(1.0f, 1.0f, 0.0f, 1.0f);
+// Minimal fragment shader
+
+#version 420 core
+
+out vec4 outputColor;
+void main()
+{
+	outputColor = vec4(1.0f, 1.0f, 0.0f, 1.0f);
 }
\ No newline at end of file
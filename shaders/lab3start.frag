@@ -1,10 +1,10 @@
-// Minimal fragment shader
-
-#version 420
-
-in vec4 fcolour;
-out vec4 outputColor;
-void main()
-{
-	outputColor = fcolour;
+// Minimal fragment shader
+
+#version 420
+
+in vec4 fcolour;
+out vec4 outputColor;
+void main()
+{
+	outputColor = fcolour;
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+// Last transform feedback pass of the GPU particle backend: writes the position, size
+// and colour of the particles in sorted order for the particle_object shaders.
+// Dead particles are given size 0 so they can be drawn without producing fragments.
+
+#version 400
+
+out vec4 out_pos_size;
+flat out uint out_colour;
+
+uniform samplerBuffer keys;
+uniform samplerBuffer positions;
+uniform usamplerBuffer colours;
+
+void main()
+{
+	vec2 key = texelFetch(keys, gl_VertexID).xy;
+	int slot = int(key.y);
+	out_pos_size = texelFetch(positions, slot);
+	if (key.x < 0.0) out_pos_size.w = 0.0;
+	out_colour = texelFetch(colours, slot).x;
+}
@@ -0,0 +1,25 @@
+// One bitonic sort pass of the GPU particle backend for contexts without compute
+// shaders. Each vertex outputs one key of the pass, reading itself and its partner
+// from the previous pass through a buffer texture. Keys are sorted furthest first.
+
+#version 400
+
+out vec2 out_key;
+
+uniform samplerBuffer keys;
+uniform int j;			// Distance to the partner
+uniform int k;			// Size of the bitonic sequences being merged
+
+void main()
+{
+	int i = gl_VertexID;
+	int l = i ^ j;
+	vec2 a = texelFetch(keys, i).xy;
+	vec2 b = texelFetch(keys, l).xy;
+
+	// The lower index of a pair keeps the further key in descending blocks
+	bool descending = (i & k) == 0;
+	bool lower = i < l;
+	bool take_partner = (descending == lower) ? (b.x > a.x) : (b.x < a.x);
+	out_key = take_partner ? b : a;
+}
@@ -0,0 +1,90 @@
+// Transform feedback pass of the GPU particle backend (particle_gpu).
+// One vertex per particle slot: dead slots take the next new particle from the
+// atomic counter, then every particle is simulated exactly like particle_store::simulate.
+// The outputs are captured into the other set of state buffers and the sort keys.
+
+#version 420
+
+layout(location = 0) in vec4 pos_size;		// Position and size
+layout(location = 1) in vec4 speed_life;	// Speed and remaining life, dead if life <= 0
+layout(location = 2) in uint colour;		// RGBA8
+
+out vec4 out_pos_size;
+out vec4 out_speed_life;
+flat out uint out_colour;
+out vec2 out_key;							// Squared camera distance (-1 if dead) and slot
+
+uniform float delta;
+uniform vec3 camera;
+uniform uint seed;
+uniform uint spawn_base;					// Serial of the first particle emitted this frame
+uniform uint spawn_count;					// Particles emitted this frame
+uniform int capacity;						// Slots past this only pad the sort to a power of two
+
+layout(binding = 0, offset = 0) uniform atomic_uint spawned;
+
+// Same hash as hashRandom() in hash_random.h, so emission matches the CPU backend
+float hashRandom(uint key, uint i, uint channel)
+{
+	uint x = key ^ (i * 0x9E3779B9u) ^ (channel * 0x85EBCA6Bu);
+	x ^= x >> 16;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16;
+	return float(x >> 8) * (1.0 / 16777216.0);
+}
+
+void main()
+{
+	if (gl_VertexID >= capacity)
+	{
+		out_pos_size = vec4(0.0);
+		out_speed_life = vec4(0.0, 0.0, 0.0, -1.0);
+		out_colour = 0u;
+		out_key = vec2(-2.0, float(gl_VertexID));	// Sorts after the dead particles
+		return;
+	}
+
+	vec4 p = pos_size;
+	vec4 s = speed_life;
+	uint c = colour;
+
+	// Emit into this slot if it's free and there are particles left to emit this frame
+	if (s.w <= 0.0)
+	{
+		uint n = atomicCounterIncrement(spawned);
+		if (n < spawn_count)
+		{
+			uint serial = spawn_base + n;
+			vec3 randomdir = vec3(hashRandom(seed, serial, 0u), hashRandom(seed, serial, 1u),
+				hashRandom(seed, serial, 2u)) * 2.0 - 1.0;
+			s = vec4(vec3(0.0, 10.0, 0.0) + randomdir * 1.5, 5.0);
+			p = vec4(0.0, 0.0, -20.0, hashRandom(seed, serial, 7u) * 0.5 + 0.1);
+
+			uint r = uint(hashRandom(seed, serial, 3u) * 256.0);
+			uint g = uint(hashRandom(seed, serial, 4u) * 256.0);
+			uint b = uint(hashRandom(seed, serial, 5u) * 256.0);
+			uint a = uint(hashRandom(seed, serial, 6u) * 256.0) / 3u;
+			c = r | (g << 8) | (b << 16) | (a << 24);
+		}
+	}
+
+	float dist = -1.0;
+	if (s.w > 0.0)
+	{
+		s.w -= delta;
+		if (s.w > 0.0)
+		{
+			s.y += (-9.81 * delta) * 0.5;
+			p.xyz += s.xyz * delta;
+			vec3 d = p.xyz - camera;
+			dist = dot(d, d);
+		}
+	}
+
+	out_pos_size = p;
+	out_speed_life = s;
+	out_colour = c;
+	out_key = vec2(dist, float(gl_VertexID));
+}
@@ -1,25 +1,25 @@
-// Fragment shader designed for Point Sprites
-// The shape of the point becomes a circle by discarding the bits of 
-// it greater than a given radius from the centre of the point.
-// Iain Martin Novemebr 2018
-// Addapted from Example 6.1 in the Redbook V4.3
-
-#version 420
-
-in vec4 fcolour;
-out vec4 outputColor;
-
-void main()
-{
-	const vec4 colour2 = vec4(0.9, 0.7, 1.0, 0.0);
-	vec2 temp = gl_PointCoord - vec2(0.5);
-	float f = dot(temp, temp);
-	if (f>0.25) discard;
-
-	/* Discard the black colours to avoid them overwritting other stars*/
-	if (fcolour.r < 0.1 && fcolour.g < 0.1 && fcolour.b < 0.1) discard;
-	
-//	outputColor = fcolour;
-//	outputColor = mix (fcolour, colour2, f);
-	outputColor = mix (fcolour, colour2, smoothstep(0.01, 0.25, f));
+// Fragment shader designed for Point Sprites
+// The shape of the point becomes a circle by discarding the bits of 
+// it greater than a given radius from the centre of the point.
+// Iain Martin Novemebr 2018
+// Addapted from Example 6.1 in the Redbook V4.3
+
+#version 420
+
+in vec4 fcolour;
+out vec4 outputColor;
+
+void main()
+{
+	const vec4 colour2 = vec4(0.9, 0.7, 1.0, 0.0);
+	vec2 temp = gl_PointCoord - vec2(0.5);
+	float f = dot(temp, temp);
+	if (f>0.25) discard;
+
+	/* Discard the black colours to avoid them overwritting other stars*/
+	if (fcolour.r < 0.1 && fcolour.g < 0.1 && fcolour.b < 0.1) discard;
+	
+//	outputColor = fcolour;
+//	outputColor = mix (fcolour, colour2, f);
+	outputColor = mix (fcolour, colour2, smoothstep(0.01, 0.25, f));
 }
\ No newline at end of file
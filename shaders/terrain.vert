@@ -1,58 +1,127 @@
-// Vertex shader with Gouraud shading
-// Iain Martin 2018
-
-#version 400
-
-// These are the vertex attributes
-layout(location = 0) in vec3 position;
-layout(location = 1) in vec3 colour;
-layout(location = 2) in vec3 normal;
-
-// Uniform variables are passed in from the application
-uniform mat4 model, view, projection;
-uniform uint colourmode;
-
-// Output the vertex colour - to be rasterized into pixel fragments
-out vec4 fcolour;
-vec4 ambient = vec4(0.2, 0.2,0.2,1.0);
-vec3 light_dir = vec3(0.0, 0.0, 10.0);
-
-void main()
-{
-	vec4 specular_colour = vec4(0.0,0.0,0.0,1.0);
-	vec4 diffuse_colour = vec4(0.5,0.5,0,1.0);
-	vec4 position_h = vec4(position, 1.0);
-	float shininess = 8.0;
-	
-	// Switch between using the vertex colour buffer colours
-	// or brown. 
-	if (colourmode == 1)
-	{
-		diffuse_colour = vec4(colour, 1.0);
-	}
-	else
-	{
-		diffuse_colour = vec4(0.6, 0.4, 0.2, 1.0);
-	}
-
-	ambient = diffuse_colour * 0.2;
-
-	mat4 mv_matrix = view * model;
-	mat3 normalmatrix = mat3(mv_matrix);
-	vec3 N = mat3(mv_matrix) * normal;
-	N = normalize(N);
-	light_dir = normalize(light_dir);
-
-	vec4 diffuse = max(dot(N, light_dir), 0.0) * diffuse_colour;
-
-	vec4 P = position_h * mv_matrix;
-	vec3 half_vec = normalize(light_dir + P.xyz);
-	vec4 specular = pow(max(dot(N, half_vec), 0.0), shininess) * specular_colour;
-
-	// Define the vertex colour
-	fcolour = diffuse + ambient + specular;
-
-	// Define the vertex position
-	gl_Position = projection * view * model * position_h;
-}
-
+// Vertex shader with Gouraud shading
+// Iain Martin 2018
+
+#version 400
+
+// These are the vertex attributes
+// With the packed terrain vertex formats the normal holds two octahedral values and,
+// for the 16 bit height format, position.x holds the normalized height. For the displaced
+// format position.xy is the row and column of the vertex within the instanced patch
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 colour;
+layout(location = 2) in vec3 normal;
+layout(location = 3) in vec4 morph_target;	// LOD: position at the next coarser level, w = level it morphs at
+
+// Uniform variables are passed in from the application
+uniform mat4 model, view, projection;
+uniform uint colourmode;
+
+// Vertex format decoding: 0 float, 1 packed, 2 packed with 16 bit heights, 3 displaced.
+// grid_decode is the x, z of vertex 0 and the x, z steps between rows and columns,
+// height_decode is the minimum height and the height range
+uniform uint vertex_format;
+uniform uint grid_columns;
+uniform vec4 grid_decode;
+uniform vec2 height_decode;
+
+// Displaced format: a patch of patch_quads x patch_quads quads is instanced over the grid,
+// patch_columns across each grid row. Texel (column, row) holds the height (decoded with
+// height_decode), octahedral normal and colour of that grid vertex
+uniform uint patch_quads;
+uniform uint patch_columns;
+uniform sampler2D height_map;
+uniform sampler2D normal_map;
+uniform sampler2D colour_map;
+
+// LOD patch level, morph start/end distance for that level and the eye in model coordinates
+uniform int lod_level;
+uniform vec2 morph_range;
+uniform vec3 lod_eye;
+
+// Output the vertex colour - to be rasterized into pixel fragments
+out vec4 fcolour;
+vec4 ambient = vec4(0.2, 0.2,0.2,1.0);
+vec3 light_dir = vec3(0.0, 0.0, 10.0);
+
+// Unfold an octahedral encoded normal (folded about y)
+vec3 octDecode(vec2 e)
+{
+	vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+	if (n.y < 0.0)
+		n.xz = (1.0 - abs(e.yx)) * vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+	return normalize(n);
+}
+
+void main()
+{
+	vec3 vertex_position = position;
+	vec3 vertex_normal = normal;
+	vec3 vertex_colour = colour;
+	if (vertex_format > 0u)
+		vertex_normal = octDecode(normal.xy);
+	if (vertex_format == 2u)
+	{
+		uint row = uint(gl_VertexID) / grid_columns;
+		uint col = uint(gl_VertexID) % grid_columns;
+		vertex_position = vec3(grid_decode.x + float(row) * grid_decode.z,
+			height_decode.x + position.x * height_decode.y,
+			grid_decode.y + float(col) * grid_decode.w);
+	}
+	if (vertex_format == 3u)
+	{
+		// Patches over the edge of the grid are clamped to the last row and column
+		uint patch_row = uint(gl_InstanceID) / patch_columns;
+		uint patch_col = uint(gl_InstanceID) % patch_columns;
+		ivec2 texel = min(ivec2(patch_col * patch_quads + uint(position.y), patch_row * patch_quads + uint(position.x)),
+			textureSize(height_map, 0) - 1);
+		float h = texelFetch(height_map, texel, 0).r;
+		vertex_position = vec3(grid_decode.x + float(texel.y) * grid_decode.z,
+			height_decode.x + h * height_decode.y,
+			grid_decode.y + float(texel.x) * grid_decode.w);
+		vertex_normal = octDecode(texelFetch(normal_map, texel, 0).xy);
+		vertex_colour = texelFetch(colour_map, texel, 0).rgb;
+	}
+
+	vec4 specular_colour = vec4(0.0,0.0,0.0,1.0);
+	vec4 diffuse_colour = vec4(0.5,0.5,0,1.0);
+	vec3 morphed = vertex_position;
+	if (morph_range.y > morph_range.x && int(morph_target.w) == lod_level)
+	{
+		float morph = clamp((distance(vertex_position, lod_eye) - morph_range.x) / (morph_range.y - morph_range.x), 0.0, 1.0);
+		morphed = mix(vertex_position, morph_target.xyz, morph);
+	}
+	vec4 position_h = vec4(morphed, 1.0);
+	float shininess = 8.0;
+	
+	// Switch between using the vertex colour buffer colours
+	// or brown. 
+	if (colourmode == 1)
+	{
+		diffuse_colour = vec4(vertex_colour, 1.0);
+	}
+	else
+	{
+		diffuse_colour = vec4(0.6, 0.4, 0.2, 1.0);
+	}
+
+	ambient = diffuse_colour * 0.2;
+
+	mat4 mv_matrix = view * model;
+	mat3 normalmatrix = mat3(mv_matrix);
+	vec3 N = mat3(mv_matrix) * vertex_normal;
+	N = normalize(N);
+	light_dir = normalize(light_dir);
+
+	vec4 diffuse = max(dot(N, light_dir), 0.0) * diffuse_colour;
+
+	vec4 P = position_h * mv_matrix;
+	vec3 half_vec = normalize(light_dir + P.xyz);
+	vec4 specular = pow(max(dot(N, half_vec), 0.0), shininess) * specular_colour;
+
+	// Define the vertex colour
+	fcolour = diffuse + ambient + specular;
+
+	// Define the vertex position
+	gl_Position = projection * view * model * position_h;
+}
+
@@ -1,15 +1,15 @@
-// Minimal fragment shader with texture
-
-#version 420
-
-in vec4 fcolour;
-in vec2 ftexcoord;
-out vec4 outputColor;
-
-uniform sampler2D tex1;
-
-void main()
-{
-	vec4 texcolour = texture(tex1, ftexcoord);
-	outputColor = fcolour * texcolour;
+// Minimal fragment shader with texture
+
+#version 420
+
+in vec4 fcolour;
+in vec2 ftexcoord;
+out vec4 outputColor;
+
+uniform sampler2D tex1;
+
+void main()
+{
+	vec4 texcolour = texture(tex1, ftexcoord);
+	outputColor = fcolour * texcolour;
 }
\ No newline at end of file